@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <string_view>
+#include <limits>
+#include <algorithm>
+#include <print>
+
+#include "Types.h"
+
+namespace Benchmarks
+{
+	// runs func once to warm the caches, then iterations times, and returns the fastest run in milliseconds
+	template<typename Func>
+	f64 Measure(u32 iterations, Func&& func)
+	{
+		func();
+
+		f64 best = std::numeric_limits<f64>::max();
+
+		for (u32 i = 0; i < iterations; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			func();
+			best = std::min(best, std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		return best;
+	}
+
+	inline void Report(std::string_view name, f64 milliseconds)
+	{
+		std::println("  {:<52} {:>10.3f} ms", name, milliseconds);
+	}
+
+	// results are fed through here so the optimizer can't drop the work that produced them
+	inline void Consume(u64 value)
+	{
+		static volatile u64 sink = 0;
+		sink = sink + value;
+	}
+
+	// every suite prints its timings and returns false if one of its checks failed
+	bool RunViewBenchmarks();
+	bool RunLookupBenchmarks();
+	bool RunHierarchyBenchmarks();
+	bool RunObjImportBenchmarks();
+	bool RunMeshOptimizerBenchmarks();
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include <vector>
+#include <array>
+#include <string>
+#include <format>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "Benchmark.h"
+#include "ECS.h"
+#include "Transform.h"
+#include "TransformSystem.h"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr u32 NodeCount = 100000;
+		constexpr u32 Iterations = 10;
+		constexpr std::array<u32, 4> Depths = { 1, 8, 64, 512 };
+
+		struct Forest
+		{
+			std::vector<Core::Entity> Entities; // parents come before their children
+			std::vector<u32> Parents; // index into Entities, ~0u for roots
+			std::vector<Core::Entity> Roots;
+		};
+
+		// NodeCount / depth chains of depth nodes each, so every level is equally wide
+		Forest BuildForest(Core::ECS& ecs, u32 depth)
+		{
+			Forest forest;
+			u32 width = NodeCount / depth;
+
+			forest.Entities.reserve(NodeCount);
+			forest.Parents.reserve(NodeCount);
+
+			for (u32 level = 0; level < depth; level++)
+			{
+				for (u32 column = 0; column < width; column++)
+				{
+					Core::Entity entity = ecs.CreateEntity();
+
+					Core::Transform* transform = ecs.AddComponent<Core::Transform>(entity);
+					transform->Position = glm::vec3(0.1f * static_cast<f32>(column % 17), 0.1f, 0.0f);
+					transform->Rotation = glm::vec3(0.01f, 0.02f * static_cast<f32>(level % 5), 0.0f);
+					ecs.AddComponent<Core::WorldTransform>(entity);
+
+					if (level == 0)
+					{
+						forest.Roots.push_back(entity);
+						forest.Parents.push_back(~0u);
+					}
+					else
+					{
+						u32 parent = (level - 1) * width + column;
+						Core::TransformSystem::SetParent(ecs, entity, forest.Entities[parent]);
+						forest.Parents.push_back(parent);
+					}
+
+					forest.Entities.push_back(entity);
+				}
+			}
+
+			return forest;
+		}
+	}
+
+	// TransformSystem's level-parallel propagation vs a serial walk over the same forest at several depths
+	bool RunHierarchyBenchmarks()
+	{
+		bool passed = true;
+
+		for (u32 depth : Depths)
+		{
+			Core::ECS ecs(nullptr);
+			Forest forest = BuildForest(ecs, depth);
+
+			Core::TransformSystem transformSystem;
+			transformSystem.Update(ecs);
+
+			std::vector<const Core::Transform*> locals;
+			locals.reserve(forest.Entities.size());
+
+			for (Core::Entity entity : forest.Entities)
+				locals.push_back(ecs.GetComponent<const Core::Transform>(entity));
+
+			std::vector<glm::mat4> serialWorlds(forest.Entities.size());
+			std::vector<glm::mat3> serialNormals(forest.Entities.size());
+
+			f64 serial = Measure(Iterations, [&]()
+				{
+					for (usize i = 0; i < locals.size(); i++)
+					{
+						glm::mat4 local = locals[i]->GetModelMatrix();
+						serialWorlds[i] = forest.Parents[i] == ~0u ? local : serialWorlds[forest.Parents[i]] * local;
+						serialNormals[i] = glm::transpose(glm::inverse(glm::mat3(serialWorlds[i])));
+					}
+
+					Consume(static_cast<u64>(serialWorlds.back()[3][0]));
+				});
+
+			// moving every root dirties the whole forest
+			f64 full = Measure(Iterations, [&]()
+				{
+					for (Core::Entity root : forest.Roots)
+						ecs.MarkChanged<Core::Transform>(root);
+
+					transformSystem.Update(ecs);
+				});
+
+			f64 idle = Measure(Iterations, [&]()
+				{
+					transformSystem.Update(ecs);
+				});
+
+			Report(std::format("depth {:>3}: serial walk", depth), serial);
+			Report(std::format("depth {:>3}: TransformSystem, every root moved", depth), full);
+			Report(std::format("depth {:>3}: TransformSystem, nothing moved", depth), idle);
+
+			f32 maxError = 0.0f;
+
+			for (usize i = 0; i < forest.Entities.size(); i++)
+			{
+				const glm::mat4& world = ecs.GetComponent<const Core::WorldTransform>(forest.Entities[i])->Matrix;
+
+				for (u32 column = 0; column < 4; column++)
+				{
+					glm::vec4 difference = glm::abs(world[column] - serialWorlds[i][column]);
+					maxError = std::max({ maxError, difference.x, difference.y, difference.z, difference.w });
+				}
+			}
+
+			if (maxError > 1e-3f)
+			{
+				std::println("  depth {}: world matrices differ from the serial walk by {}", depth, maxError);
+				passed = false;
+			}
+		}
+
+		return passed;
+	}
+}
\ No newline at end of file
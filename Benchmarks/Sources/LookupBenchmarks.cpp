@@ -0,0 +1,133 @@
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <typeindex>
+
+#include "Benchmark.h"
+#include "ECS.h"
+#include "Transform.h"
+#include "Visibility.h"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr u32 EntityCount = 100000;
+		constexpr u32 Iterations = 20;
+
+		// the lookup the ECS did before dense type ids, every query hashes a type_index to find the pool
+		class TypeIndexPools
+		{
+		public:
+			template<typename T>
+			Core::ComponentPool<T>* GetPool()
+			{
+				auto& pool = m_Pools[std::type_index(typeid(T))];
+
+				if (!pool)
+					pool = std::make_unique<Core::ComponentPool<T>>();
+
+				return static_cast<Core::ComponentPool<T>*>(pool.get());
+			}
+
+			template<typename... Ts>
+			bool HasComponents(u32 entityIndex)
+			{
+				return (GetPool<Ts>()->Contains(entityIndex) && ...);
+			}
+		private:
+			std::unordered_map<std::type_index, std::unique_ptr<Core::IComponentPool>> m_Pools;
+		};
+	}
+
+	// HasComponents and GetComponent through type_index hashing vs ComponentMask bits and id-indexed pools
+	bool RunLookupBenchmarks()
+	{
+		Core::ECS ecs(nullptr);
+		TypeIndexPools typeIndexPools;
+		std::vector<Core::Entity> entities;
+		entities.reserve(EntityCount);
+
+		for (u32 i = 0; i < EntityCount; i++)
+		{
+			Core::Entity entity = ecs.CreateEntity();
+			entities.push_back(entity);
+
+			ecs.AddComponent<Core::Transform>(entity);
+			typeIndexPools.GetPool<Core::Transform>()->Emplace(entity.Index, 0);
+
+			// half of them have everything the query asks for
+			if (i % 2 == 0)
+			{
+				ecs.AddComponent<Core::WorldTransform>(entity)->Matrix[3][0] = static_cast<f32>(i);
+				ecs.AddComponent<Core::Visibility>(entity);
+
+				typeIndexPools.GetPool<Core::WorldTransform>()->Emplace(entity.Index, 0)->Matrix[3][0] = static_cast<f32>(i);
+				typeIndexPools.GetPool<Core::Visibility>()->Emplace(entity.Index, 0);
+			}
+		}
+
+		const u64 expectedCount = EntityCount / 2;
+		u64 typeIndexCount = 0;
+		u64 maskCount = 0;
+
+		f64 typeIndexHas = Measure(Iterations, [&]()
+			{
+				typeIndexCount = 0;
+
+				for (Core::Entity entity : entities)
+				{
+					if (ecs.IsAlive(entity) && typeIndexPools.HasComponents<Core::Transform, Core::WorldTransform, Core::Visibility>(entity.Index))
+						typeIndexCount++;
+				}
+
+				Consume(typeIndexCount);
+			});
+
+		f64 maskHas = Measure(Iterations, [&]()
+			{
+				maskCount = 0;
+
+				for (Core::Entity entity : entities)
+				{
+					if (ecs.HasComponents<Core::Transform, Core::WorldTransform, Core::Visibility>(entity))
+						maskCount++;
+				}
+
+				Consume(maskCount);
+			});
+
+		f64 typeIndexSum = 0.0;
+		f64 idSum = 0.0;
+
+		f64 typeIndexGet = Measure(Iterations, [&]()
+			{
+				typeIndexSum = 0.0;
+
+				for (usize i = 0; i < entities.size(); i += 2)
+				{
+					if (ecs.IsAlive(entities[i]))
+						typeIndexSum += typeIndexPools.GetPool<Core::WorldTransform>()->Get(entities[i].Index)->Matrix[3][0];
+				}
+
+				Consume(static_cast<u64>(typeIndexSum));
+			});
+
+		f64 idGet = Measure(Iterations, [&]()
+			{
+				idSum = 0.0;
+
+				for (usize i = 0; i < entities.size(); i += 2)
+					idSum += ecs.GetComponent<const Core::WorldTransform>(entities[i])->Matrix[3][0];
+
+				Consume(static_cast<u64>(idSum));
+			});
+
+		Report("HasComponents<3> by type_index map (100k)", typeIndexHas);
+		Report("HasComponents<3> by ComponentMask (100k)", maskHas);
+		Report("GetComponent by type_index map (50k)", typeIndexGet);
+		Report("GetComponent by dense type id (50k)", idGet);
+
+		return typeIndexCount == expectedCount && maskCount == expectedCount && typeIndexSum == idSum;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include <array>
+#include <string_view>
+#include <print>
+
+#include "Benchmark.h"
+
+struct Suite
+{
+	std::string_view Name;
+	bool (*Run)();
+};
+
+// Benchmarks [suite...], runs every suite when none is named, exits with 1 if a check failed
+int main(int argc, char** argv)
+{
+	constexpr std::array suites = {
+		Suite{ "views", Benchmarks::RunViewBenchmarks },
+		Suite{ "lookups", Benchmarks::RunLookupBenchmarks },
+		Suite{ "hierarchy", Benchmarks::RunHierarchyBenchmarks },
+		Suite{ "objimport", Benchmarks::RunObjImportBenchmarks },
+		Suite{ "meshopt", Benchmarks::RunMeshOptimizerBenchmarks }
+	};
+
+	bool passed = true;
+
+	for (const Suite& suite : suites)
+	{
+		bool selected = argc < 2;
+
+		for (int i = 1; i < argc && !selected; i++)
+			selected = suite.Name == argv[i];
+
+		if (!selected)
+			continue;
+
+		std::println("{}", suite.Name);
+
+		if (!suite.Run())
+		{
+			std::println("  FAILED");
+			passed = false;
+		}
+	}
+
+	return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,328 @@
+#include <vector>
+#include <string>
+#include <string_view>
+#include <span>
+#include <utility>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <unordered_set>
+#include <array>
+#include <cstring>
+#include <cmath>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "Benchmark.h"
+#include "ObjImporter.h"
+#include "MeshOptimizer.h"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr u32 Iterations = 5;
+
+		using Triangle = std::array<u32, 3>;
+
+		bool ReadFile(const std::filesystem::path& path, std::string& text)
+		{
+			std::ifstream file(path, std::ios::binary);
+
+			if (!file)
+				return false;
+
+			text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			return true;
+		}
+
+		bool Check(bool condition, std::string_view what)
+		{
+			if (!condition)
+				std::println("  check failed: {}", what);
+
+			return condition;
+		}
+
+		// rotated so the smallest index comes first, which keeps the winding, then sorted
+		std::vector<Triangle> GetTriangles(std::span<const u32> indices)
+		{
+			std::vector<Triangle> triangles;
+			triangles.reserve(indices.size() / 3);
+
+			for (usize i = 0; i + 2 < indices.size(); i += 3)
+			{
+				Triangle triangle = { indices[i], indices[i + 1], indices[i + 2] };
+				std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+				triangles.push_back(triangle);
+			}
+
+			std::sort(triangles.begin(), triangles.end());
+			return triangles;
+		}
+
+		bool InRange(std::span<const u32> indices, usize vertexCount)
+		{
+			return std::all_of(indices.begin(), indices.end(), [&](u32 index) { return index < vertexCount; });
+		}
+
+		bool SameVertex(const Core::Vertex& a, const Core::Vertex& b)
+		{
+			return std::memcmp(&a, &b, sizeof(Core::Vertex)) == 0;
+		}
+
+		// every index slot still points at a bitwise equal vertex, so the same triangles are drawn in the same order
+		bool SameRenderedTriangles(const std::vector<Core::Vertex>& verticesBefore, const std::vector<u32>& indicesBefore,
+			const std::vector<Core::Vertex>& vertices, const std::vector<u32>& indices)
+		{
+			if (indices.size() != indicesBefore.size() || !InRange(indices, vertices.size()))
+				return false;
+
+			for (usize i = 0; i < indices.size(); i++)
+			{
+				if (!SameVertex(vertices[indices[i]], verticesBefore[indicesBefore[i]]))
+					return false;
+			}
+
+			return true;
+		}
+
+		glm::vec3 UnpackOctahedral(const i16 (&packed)[2])
+		{
+			f32 x = std::max(static_cast<f32>(packed[0]) / 32767.0f, -1.0f);
+			f32 y = std::max(static_cast<f32>(packed[1]) / 32767.0f, -1.0f);
+			f32 z = 1.0f - std::abs(x) - std::abs(y);
+
+			if (z < 0.0f)
+			{
+				f32 foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+				f32 foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+				x = foldedX;
+				y = foldedY;
+			}
+
+			return glm::normalize(glm::vec3(x, y, z));
+		}
+
+		// decodes the way object_packed.vert does and compares against the full vertices
+		bool CheckPacking(const std::vector<Core::Vertex>& vertices)
+		{
+			Core::MeshBounds bounds = Core::MeshCache::ComputeBounds(vertices);
+			std::vector<Core::PackedVertex> packed = Core::PackVertices(vertices, bounds);
+			glm::mat4 dequantize = Core::GetDequantizationMatrix(bounds);
+
+			// half a quantization step per axis, plus float slack
+			glm::vec3 positionTolerance = (bounds.Max - bounds.Min) / 65535.0f * 0.5f + 1e-5f;
+
+			f32 positionError = 0.0f, normalError = 0.0f;
+			bool passed = packed.size() == vertices.size();
+
+			for (usize i = 0; i < vertices.size() && passed; i++)
+			{
+				const Core::Vertex& vertex = vertices[i];
+				const Core::PackedVertex& out = packed[i];
+
+				glm::vec3 quantized = glm::vec3(out.Position[0], out.Position[1], out.Position[2]) / 65535.0f;
+				glm::vec3 position = glm::vec3(dequantize * glm::vec4(quantized, 1.0f));
+				glm::vec3 delta = glm::abs(position - vertex.Position);
+
+				passed = glm::all(glm::lessThanEqual(delta, positionTolerance));
+				positionError = std::max({ positionError, delta.x, delta.y, delta.z });
+
+				if (glm::length(vertex.Normal) > 0.0f)
+				{
+					f32 error = glm::length(UnpackOctahedral(out.Normal) - glm::normalize(vertex.Normal));
+					passed = passed && error < 1e-3f;
+					normalError = std::max(normalError, error);
+				}
+
+				for (u32 axis = 0; axis < 2; axis++)
+				{
+					f32 uv = vertex.TextureCoordinate[axis];
+					passed = passed && std::abs(glm::unpackHalf1x16(out.TextureCoordinate[axis]) - uv) <= std::max(std::abs(uv), 1.0f) * 1e-3f;
+				}
+			}
+
+			std::println("  pack round trip: position error {:.6f}, normal error {:.6f}", positionError, normalError);
+			return Check(passed, "packed vertices decode within tolerance");
+		}
+
+		// the ranges tile the indices in order and every one stays within the vertex and triangle limits
+		bool CheckMeshlets(const std::vector<Core::Meshlet>& meshlets, std::span<const u32> indices)
+		{
+			u32 next = 0;
+
+			for (const Core::Meshlet& meshlet : meshlets)
+			{
+				if (meshlet.FirstIndex != next || meshlet.IndexCount == 0 || meshlet.IndexCount % 3 != 0 ||
+					meshlet.IndexCount > Core::MaxMeshletTriangles * 3 || meshlet.FirstIndex + meshlet.IndexCount > indices.size())
+					return false;
+
+				std::unordered_set<u32> unique(indices.begin() + meshlet.FirstIndex, indices.begin() + meshlet.FirstIndex + meshlet.IndexCount);
+
+				if (unique.size() > Core::MaxMeshletVertices || unique.size() != meshlet.VertexCount)
+					return false;
+
+				next += meshlet.IndexCount;
+			}
+
+			return next == indices.size();
+		}
+
+		// each level is a whole number of in-range triangles, appended in order and at least LODMinReduction smaller
+		bool CheckLODs(const std::vector<Core::MeshLOD>& lods, std::span<const u32> indices, usize lod0Count, usize vertexCount)
+		{
+			if (lods.empty() || lods[0].FirstIndex != 0 || lods[0].IndexCount != lod0Count)
+				return false;
+
+			for (usize i = 1; i < lods.size(); i++)
+			{
+				const Core::MeshLOD& lod = lods[i];
+				const Core::MeshLOD& previous = lods[i - 1];
+
+				if (lod.FirstIndex != previous.FirstIndex + previous.IndexCount || lod.IndexCount == 0 || lod.IndexCount % 3 != 0 ||
+					static_cast<f32>(lod.IndexCount) > static_cast<f32>(previous.IndexCount) * Core::LODMinReduction ||
+					!(lod.Error >= 0.0f) || !InRange(indices.subspan(lod.FirstIndex, lod.IndexCount), vertexCount))
+					return false;
+			}
+
+			return lods.back().FirstIndex + lods.back().IndexCount == indices.size();
+		}
+
+		// runs Mesh::Decode's pipeline step by step and checks each step against what it promises
+		bool CheckPipeline(std::string_view name, std::vector<Core::Vertex> vertices, std::vector<u32> indices)
+		{
+			std::println("  {}: {} vertices, {} triangles", name, vertices.size(), indices.size() / 3);
+
+			const std::vector<Core::Vertex> imported = vertices;
+			const std::vector<u32> importedIndices = indices;
+
+			Core::WeldStats weld = Core::WeldVertices(vertices, indices);
+
+			bool passed = Check(weld.VerticesAfter == vertices.size() && vertices.size() <= imported.size(), "weld never adds vertices");
+			passed = Check(SameRenderedTriangles(imported, importedIndices, vertices, indices), "weld keeps the rendered triangles") && passed;
+
+			const std::vector<Triangle> triangles = GetTriangles(indices);
+			Core::VertexCacheStats before = Core::AnalyzeVertexCache(indices, vertices.size());
+
+			Core::OptimizeVertexCache(indices, vertices.size());
+			Core::VertexCacheStats cached = Core::AnalyzeVertexCache(indices, vertices.size());
+
+			passed = Check(GetTriangles(indices) == triangles, "vertex cache keeps the triangle multiset") && passed;
+			passed = Check(cached.ACMR <= before.ACMR, "vertex cache doesn't worsen the ACMR") && passed;
+
+			Core::OptimizeOverdraw(indices, vertices);
+			Core::VertexCacheStats overdraw = Core::AnalyzeVertexCache(indices, vertices.size());
+
+			passed = Check(GetTriangles(indices) == triangles, "overdraw keeps the triangle multiset") && passed;
+			// 1.05 is OptimizeOverdraw's default threshold, the one Mesh::Decode runs with
+			passed = Check(overdraw.ACMR <= cached.ACMR * 1.05f, "overdraw keeps the ACMR within its threshold") && passed;
+
+			std::vector<Core::Meshlet> meshlets = Core::BuildMeshlets(vertices, indices);
+
+			passed = Check(GetTriangles(indices) == triangles, "meshlets keep the triangle multiset") && passed;
+			passed = Check(CheckMeshlets(meshlets, indices), "meshlets cover every triangle once within their limits") && passed;
+
+			const std::vector<Core::Vertex> unfetched = vertices;
+			const std::vector<u32> unfetchedIndices = indices;
+
+			Core::OptimizeVertexFetch(vertices, indices);
+
+			passed = Check(vertices.size() <= unfetched.size(), "vertex fetch never adds vertices") && passed;
+			passed = Check(SameRenderedTriangles(unfetched, unfetchedIndices, vertices, indices), "vertex fetch remaps indices in range") && passed;
+
+			usize lod0Count = indices.size();
+			std::vector<Core::MeshLOD> lods = Core::BuildLODChain(vertices, indices);
+
+			passed = Check(CheckLODs(lods, indices, lod0Count, vertices.size()), "LODs shrink and stay in range") && passed;
+			passed = CheckPacking(vertices) && passed;
+
+			std::println("  {}: ACMR {:.3f} -> {:.3f} -> {:.3f}, {} meshlets, {} LODs", name, before.ACMR, cached.ACMR, overdraw.ACMR,
+				meshlets.size(), lods.size());
+
+			return passed;
+		}
+
+		// a bumpy grid, welded it has the shared vertices a real mesh has and it simplifies cleanly
+		void BuildGrid(u32 size, std::vector<Core::Vertex>& vertices, std::vector<u32>& indices)
+		{
+			auto corner = [&](u32 x, u32 y)
+				{
+					Core::Vertex vertex;
+					vertex.Position = glm::vec3(static_cast<f32>(x), 0.25f * std::sin(0.3f * static_cast<f32>(x + y)), static_cast<f32>(y));
+					vertex.Normal = glm::vec3(0.0f, 1.0f, 0.0f);
+					vertex.TextureCoordinate = glm::vec2(static_cast<f32>(x), static_cast<f32>(y)) / static_cast<f32>(size);
+					return vertex;
+				};
+
+			// unindexed like ImportObj's output before welding
+			for (u32 y = 0; y < size; y++)
+			{
+				for (u32 x = 0; x < size; x++)
+				{
+					for (auto [cornerX, cornerY] : { std::pair(x, y), std::pair(x, y + 1), std::pair(x + 1, y),
+						std::pair(x + 1, y), std::pair(x, y + 1), std::pair(x + 1, y + 1) })
+					{
+						indices.push_back(static_cast<u32>(vertices.size()));
+						vertices.push_back(corner(cornerX, cornerY));
+					}
+				}
+			}
+		}
+	}
+
+	// the steps Mesh::Decode runs on every imported mesh, checked on a grid and the demo's largest mesh, then timed
+	bool RunMeshOptimizerBenchmarks()
+	{
+		std::vector<Core::Vertex> gridVertices;
+		std::vector<u32> gridIndices;
+		BuildGrid(128, gridVertices, gridIndices);
+
+		bool passed = CheckPipeline("grid", gridVertices, gridIndices);
+
+		const std::filesystem::path porschePath = std::filesystem::path(PATH_TO_DEMO) / "Content" / "Meshes" / "Porsche_911_GT2.obj";
+
+		std::string porsche;
+		std::vector<Core::Vertex> vertices;
+		std::vector<u32> indices;
+
+		if (!ReadFile(porschePath, porsche) || !Core::ImportObj(std::span<const char>(porsche.data(), porsche.size()), vertices, indices))
+		{
+			std::println("  couldn't import {}", porschePath.string());
+			return false;
+		}
+
+		passed = CheckPipeline("Porsche_911_GT2.obj", vertices, indices) && passed;
+
+		Core::WeldVertices(vertices, indices);
+
+		f64 cache = Measure(Iterations, [&]()
+			{
+				std::vector<u32> optimized = indices;
+				Core::OptimizeVertexCache(optimized, vertices.size());
+				Consume(optimized[0]);
+			});
+
+		std::vector<u32> optimized = indices;
+		Core::OptimizeVertexCache(optimized, vertices.size());
+
+		f64 meshlets = Measure(Iterations, [&]()
+			{
+				std::vector<u32> clustered = optimized;
+				Consume(Core::BuildMeshlets(vertices, clustered).size());
+			});
+
+		f64 lods = Measure(Iterations, [&]()
+			{
+				std::vector<u32> chain = optimized;
+				Consume(Core::BuildLODChain(vertices, chain).size());
+			});
+
+		Report("OptimizeVertexCache, Porsche_911_GT2.obj", cache);
+		Report("BuildMeshlets, Porsche_911_GT2.obj", meshlets);
+		Report("BuildLODChain, Porsche_911_GT2.obj", lods);
+
+		return passed;
+	}
+}
\ No newline at end of file
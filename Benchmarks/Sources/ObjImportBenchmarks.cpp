@@ -0,0 +1,119 @@
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+
+#include "Benchmark.h"
+#include "ObjImporter.h"
+#include "OBJ-Loader.h"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr u32 Iterations = 5;
+
+		// quads, a polygon, negative indices and corners without uvs or normals, the cases objl handles specially
+		constexpr const char* EdgeCaseObj =
+			"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0.5 1.5 0\n"
+			"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+			"vn 0 0 1\nvn 0 1 0\n"
+			"f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+			"f -4/-3/-1 -3/-2/-1 -1/-1/-2\n"
+			"f 1 2 3\n"
+			"f 2//1 3//1 4//2\n"
+			"f 1/1 2/2 3/3\n"
+			"f 1 2 3 5 4\n";
+
+		bool ReadFile(const std::filesystem::path& path, std::string& text)
+		{
+			std::ifstream file(path, std::ios::binary);
+
+			if (!file)
+				return false;
+
+			text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			return true;
+		}
+
+		// the engine's vertex and objl's are both 8 floats in the same order, so the arrays compare bit for bit
+		static_assert(sizeof(Core::Vertex) == sizeof(objl::Vertex));
+
+		bool Matches(const std::vector<Core::Vertex>& vertices, const std::vector<u32>& indices, const objl::Loader& loader)
+		{
+			return vertices.size() == loader.LoadedVertices.size() && indices.size() == loader.LoadedIndices.size() &&
+				std::memcmp(vertices.data(), loader.LoadedVertices.data(), vertices.size() * sizeof(Core::Vertex)) == 0 &&
+				std::memcmp(indices.data(), loader.LoadedIndices.data(), indices.size() * sizeof(u32)) == 0;
+		}
+
+		// ImportObj has to reproduce objl::Loader's LoadedVertices/LoadedIndices exactly
+		bool CheckAgainstObjl(const std::string& name, const std::string& text, const std::string& path)
+		{
+			std::vector<Core::Vertex> vertices;
+			std::vector<u32> indices;
+
+			objl::Loader loader;
+			std::istringstream stream(text);
+
+			if (!Core::ImportObj(std::span<const char>(text.data(), text.size()), vertices, indices) || !loader.LoadFile(stream, path))
+			{
+				std::println("  {}: failed to import", name);
+				return false;
+			}
+
+			if (!Matches(vertices, indices, loader))
+			{
+				std::println("  {}: {} vertices / {} indices, objl has {} / {}", name, vertices.size(), indices.size(),
+					loader.LoadedVertices.size(), loader.LoadedIndices.size());
+				return false;
+			}
+
+			std::println("  {}: identical to objl::Loader ({} vertices, {} indices)", name, vertices.size(), indices.size());
+			return true;
+		}
+	}
+
+	// Mesh::Decode's importer vs objl::Loader on the demo's largest mesh, plus the equivalence checks
+	bool RunObjImportBenchmarks()
+	{
+		const std::filesystem::path porschePath = std::filesystem::path(PATH_TO_DEMO) / "Content" / "Meshes" / "Porsche_911_GT2.obj";
+
+		std::string porsche;
+
+		if (!ReadFile(porschePath, porsche))
+		{
+			std::println("  couldn't read {}", porschePath.string());
+			return false;
+		}
+
+		bool passed = CheckAgainstObjl("edge cases", EdgeCaseObj, "EdgeCases.obj");
+		passed = CheckAgainstObjl("Porsche_911_GT2.obj", porsche, porschePath.string()) && passed;
+
+		// both parse text that's already in memory, objl through a stream over it
+		f64 objl = Measure(Iterations, [&]()
+			{
+				objl::Loader loader;
+				std::istringstream stream(porsche);
+
+				loader.LoadFile(stream, porschePath.string());
+				Consume(loader.LoadedIndices.size());
+			});
+
+		f64 importer = Measure(Iterations, [&]()
+			{
+				std::vector<Core::Vertex> vertices;
+				std::vector<u32> indices;
+
+				Core::ImportObj(std::span<const char>(porsche.data(), porsche.size()), vertices, indices);
+				Consume(indices.size());
+			});
+
+		Report("objl::Loader, Porsche_911_GT2.obj", objl);
+		Report("ImportObj, Porsche_911_GT2.obj", importer);
+		std::println("  {:<52} {:>10.1f}x", "speedup", objl / importer);
+
+		return passed;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <vector>
+#include <memory>
+
+#include "Benchmark.h"
+#include "ECS.h"
+#include "Object.h"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr u32 ObjectCount = 100000;
+		constexpr u32 Iterations = 20;
+	}
+
+	// the render loop's lookups, every Object asked for its components vs one cached view walking the pools
+	bool RunViewBenchmarks()
+	{
+		Core::ECS ecs(nullptr);
+		std::vector<std::unique_ptr<Core::Object>> objects;
+		objects.reserve(ObjectCount);
+
+		for (u32 i = 0; i < ObjectCount; i++)
+		{
+			objects.push_back(std::make_unique<Core::Object>(ecs, "Object"));
+			objects.back()->GetComponent<Core::WorldTransform>()->Matrix[3][0] = static_cast<f32>(i);
+
+			// every other object is hidden and a quarter lose their WorldTransform, like editor-only objects
+			objects.back()->SetVisible(i % 2 == 0);
+
+			if (i % 4 == 3)
+				ecs.RemoveComponent<Core::WorldTransform>(objects.back()->GetEntity());
+		}
+
+		u64 expected = 0;
+		u64 perObjectResult = 0;
+		u64 viewResult = 0;
+
+		for (u32 i = 0; i < ObjectCount; i++)
+		{
+			if (i % 2 == 0 && i % 4 != 3)
+				expected += i;
+		}
+
+		f64 perObject = Measure(Iterations, [&]()
+			{
+				f64 sum = 0.0;
+
+				for (const auto& object : objects)
+				{
+					if (!object->HasComponents<Core::WorldTransform, Core::Visibility>())
+						continue;
+
+					if (object->GetComponent<const Core::Visibility>()->IsVisible)
+						sum += object->GetComponent<const Core::WorldTransform>()->Matrix[3][0];
+				}
+
+				perObjectResult = static_cast<u64>(sum);
+				Consume(perObjectResult);
+			});
+
+		f64 view = Measure(Iterations, [&]()
+			{
+				f64 sum = 0.0;
+
+				ecs.View<const Core::WorldTransform, const Core::Visibility>().Each(
+					[&](Core::Entity, const Core::WorldTransform& worldTransform, const Core::Visibility& visibility)
+					{
+						if (visibility.IsVisible)
+							sum += worldTransform.Matrix[3][0];
+					});
+
+				viewResult = static_cast<u64>(sum);
+				Consume(viewResult);
+			});
+
+		f64 lookup = Measure(Iterations, [&]()
+			{
+				usize hint = 0;
+
+				for (u32 i = 0; i < 1000; i++)
+					hint += ecs.View<const Core::WorldTransform, const Core::Visibility>().SizeHint();
+
+				Consume(hint);
+			});
+
+		Report("per-object HasComponents + GetComponent (100k)", perObject);
+		Report("cached View<WorldTransform, Visibility>::Each (100k)", view);
+		Report("View<WorldTransform, Visibility>() lookup (x1000)", lookup);
+
+		return perObjectResult == expected && viewResult == expected;
+	}
+}
\ No newline at end of file
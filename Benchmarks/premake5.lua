@@ -0,0 +1,50 @@
+project "Benchmarks"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++23"
+    staticruntime "on"
+
+    targetdir("../bin/" .. outputdir .. "/%{prj.name}")
+    objdir("../bin-int/" .. outputdir .. "/%{prj.name}")
+
+    files {
+        "Headers/**.h",
+        "Sources/**.cpp"
+    }
+
+    defines {
+        "PATH_TO_DEMO=\"" .. rootPath .. "/Demo" .. "\"",
+    }
+
+    links {
+        "Core",
+        "GLFW",
+        "VkBootstrap"
+    }
+
+    includedirs {
+        "Headers",
+        "../Core/Headers",
+        "../Core/Vendor/glfw/include",
+        "../Core/Vendor/VulkanMemoryAllocator/include",
+        "../Core/Vendor/vk-bootstrap/include",
+        "../Core/Vendor/glm",
+        vkSDK .. "/Include"
+    }
+
+    vpaths {
+        ["Header Files"] = "Headers/**.h",
+        ["Source Files"] = "Sources/**.cpp"
+    }
+
+    filter "system:linux"
+        links { "vulkan" }
+
+    filter "configurations:Debug"
+        runtime "Debug"
+        symbols "on"
+        defines { "DEBUG" }
+
+    filter "configurations:Release"
+        runtime "Release"
+        optimize "on"
\ No newline at end of file
@@ -31,7 +31,8 @@ namespace Core
 		static f32 GetDeltaTime();
 		static Window& GetWindow();
 
-		static MeshBuffers CreateMeshBuffers(const std::vector<objl::Vertex>& vertices, const std::vector<u32>& indices);
+		static MeshBuffers CreateMeshBuffers(const std::vector<Vertex>& vertices, const std::vector<u32>& indices);
+		static MeshBuffers CreateMeshBuffers(std::span<const u8> vertexData, std::span<const u8> indexData);
 
 		i32 GetCursorState();
 		void SetCursorState(i32 state);
@@ -69,6 +70,7 @@ namespace Core
 		[[nodiscard]] VmaAllocator GetVmaAllocator() const { return m_Renderer->GetVmaAllocator(); }
 		[[nodiscard]] VkSampleCountFlagBits GetMSAASamples() const { return m_Renderer->GetMSAASamples(); }
 		[[nodiscard]] VkPhysicalDeviceLimits GetPhysicalDeviceLimits() const { return m_Renderer->GetPhysicalDeviceLimits(); }
+		[[nodiscard]] bool SupportsMultiDrawIndirect() const { return m_Renderer->SupportsMultiDrawIndirect(); }
 
 		[[nodiscard]] Image CreateImage(u32 width, u32 height, VkFormat format, VkImageTiling tiling, VkImageAspectFlags aspects,
 			VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkSampleCountFlagBits samples) {
@@ -93,7 +95,20 @@ namespace Core
 		[[nodiscard]] Buffer& GetVPBuffer() { return m_Renderer->GetVPBuffer(); }
 		[[nodiscard]] Buffer& GetMaterialsBuffer() { return m_Renderer->GetMaterialsBuffer(); }
 
-		[[nodiscard]] Shader& GetGraphicsShader() { return m_Renderer->GetGraphicsShader(); }
+		[[nodiscard]] Shader& GetGraphicsShader(VertexFormat format = VertexFormat::Full) { return m_Renderer->GetGraphicsShader(format); }
+		void BindGraphicsShader(VertexFormat format) { m_Renderer->BindGraphicsShader(format); }
+		GeometryRange AllocateGeometry(std::span<const u8> vertexData, u32 vertexStride, std::span<const u8> indexData, VkIndexType indexType)
+			{ return m_Renderer->AllocateGeometry(vertexData, vertexStride, indexData, indexType); }
+		void FreeGeometry(GeometryRange& range) { m_Renderer->FreeGeometry(range); }
+		void UploadBuffer(VkBuffer buffer, VkDeviceSize offset, std::span<const u8> data) { m_Renderer->UploadBuffer(buffer, offset, data); }
+		void UploadImage(const Image& image, std::span<const u8> data) { m_Renderer->UploadImage(image, data); }
+		void BindGeometryBuffers(VkIndexType indexType) { m_Renderer->BindGeometryBuffers(indexType); }
+		void DrawIndexedIndirect(std::span<const VkDrawIndexedIndirectCommand> commands) { m_Renderer->DrawIndexedIndirect(commands); }
+		void UpdateGPUObject(u32 index, const GPUObject& object) { m_Renderer->UpdateGPUObject(index, object); }
+		void CullGPUObjects(const GPUCullConstants& constants, u32 objectCount) { m_Renderer->CullGPUObjects(constants, objectCount); }
+		void DrawGPUObjects() { m_Renderer->DrawGPUObjects(); }
+		[[nodiscard]] const GPUCullStats& GetGPUCullStats() const { return m_Renderer->GetGPUCullStats(); }
+		void UpdateMaterialsDescriptors() { m_Renderer->UpdateMaterialsDescriptors(); }
 
 		[[nodiscard]] const f32 GetGPUTime(const TimestampType& type) const { return m_Renderer->GetGPUTime(type); }
 
@@ -128,16 +143,19 @@ namespace Core
 	template<std::derived_from<Layer> T>
 	void Application::PushLayer()
 	{
-		m_LayerStack.emplace_back(std::make_unique<T>());
+		auto& layer = m_LayerStack.emplace_back(std::make_unique<T>());
+		layer->m_TypeID = TypeRegistry<Layer>::Get<T>();
 	}
 
 	template<std::derived_from<Layer> T>
 	T* Application::GetLayer()
 	{
+		TypeID id = TypeRegistry<Layer>::Get<T>();
+
 		for (const auto& layer : m_LayerStack)
 		{
-			if (auto casted = dynamic_cast<T*>(layer.get()))
-				return casted;
+			if (layer->GetTypeID() == id)
+				return static_cast<T*>(layer.get());
 		}
 		return nullptr;
 	}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <limits>
+#include <functional>
+#include <type_traits>
+
+#include "Types.h"
+#include "Component.h"
+
+namespace Core
+{
+	// index into the AssetManager slot table, Generation detects handles to a slot that was reused
+	// T is only documentation for the caller, the AssetManager checks the real type on lookup
+	template<typename T = Asset>
+	struct AssetHandle
+	{
+		static constexpr u32 InvalidIndex = std::numeric_limits<u32>::max();
+
+		u32 Index = InvalidIndex;
+		u32 Generation = 0;
+
+		[[nodiscard]] bool IsNull() const noexcept { return Index == InvalidIndex; }
+
+		// typed handles convert to the untyped one the ECS stores
+		operator AssetHandle<Asset>() const noexcept requires (!std::is_same_v<T, Asset>) { return { Index, Generation }; }
+
+		bool operator==(const AssetHandle& other) const noexcept = default;
+	};
+}
+
+template<typename T>
+struct std::hash<Core::AssetHandle<T>>
+{
+	std::size_t operator()(const Core::AssetHandle<T>& handle) const noexcept
+	{
+		return std::hash<u64>()((static_cast<u64>(handle.Generation) << 32) | handle.Index);
+	}
+};
\ No newline at end of file
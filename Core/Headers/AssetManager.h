@@ -4,51 +4,231 @@
 #include <filesystem>
 #include <memory>
 #include <concepts>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <limits>
 
 #include "Component.h"
 #include "Log.h"
 #include "UUID.h"
+#include "AssetHandle.h"
+#include "ThreadPool.h"
 
 namespace Core
 {
+	enum class AssetState : u8
+	{
+		Loading,
+		Ready,
+		Failed,
+		Evicted
+	};
+
+	struct AssetStats
+	{
+		usize CPUBytes = 0;
+		usize GPUBytes = 0;
+		usize CPUBudget = std::numeric_limits<usize>::max();
+		usize GPUBudget = std::numeric_limits<usize>::max();
+		u32 EvictedAssets = 0;
+		u64 Evictions = 0;
+		u64 Reloads = 0;
+	};
+
+	// assets that split loading into a cpu part that is safe on worker threads (Decode)
+	// and a part that needs the main thread, like gpu uploads (Upload)
+	template<typename T>
+	concept AsyncLoadable = std::derived_from<T, Asset> && requires(T* asset, const std::filesystem::path& path)
+	{
+		{ asset->Decode(path) } -> std::same_as<bool>;
+		asset->Upload();
+	};
+
+	// assets live in a slot table addressed by AssetHandle, so resolving a handle is an index and a generation compare
+	// path -> slot and UUID -> slot are hashed side indices used when loading and for UUID based lookups
+	// entities hold references (the ECS adds one per asset component), once memory goes over budget
+	// EvictToBudget releases the data of the least recently used assets, unreferenced ones first and then
+	// referenced ones that weren't used for ColdFrameCount frames, the slot stays so handles keep working
+	// and an evicted asset that gets referenced or used again is decoded again like a LoadAsync
+	// note: the AssetManager is used from the main thread, only the Decode step of LoadAsync runs on workers
 	class AssetManager
 	{
 	public:
+		static constexpr u32 ColdFrameCount = 300;
+
 		~AssetManager();
 
 		template<std::derived_from<Asset> T>
 		T* Load(const std::filesystem::path& path);
 
+		// returns right away and decodes on the shared ThreadPool, Update finishes the load on the main thread
+		// until then Get returns the placeholder registered for T, or nullptr if there is none
+		template<AsyncLoadable T>
+		[[nodiscard]] AssetHandle<T> LoadAsync(const std::filesystem::path& path);
+
+		// uploads at most maxUploads decoded assets and marks them ready, call once per frame
+		void Update(u32 maxUploads = 8);
+
+		// blocks until every pending LoadAsync is ready or failed
+		void Flush();
+
+		// files under mountPoint are read from the pack built from it (AssetPack::Build) before the loose files
+		// note: mount before loading, the VirtualFileSystem is shared by every AssetManager
+		bool MountPack(const std::filesystem::path& packPath, const std::filesystem::path& mountPoint);
+
+		// stands in for assets of type T while they load or are evicted, it has to be an asset owned by this manager
+		// and gets pinned
+		template<std::derived_from<Asset> T>
+		void SetPlaceholder(T* placeholder);
+
+		void AddReference(AssetHandle<> handle);
+		void ReleaseReference(AssetHandle<> handle);
+
+		// pinned assets are never evicted, for assets used outside the ECS
+		void Pin(const UUID& id);
+
+		// destroys an asset nothing references or pins and frees its slot for the next load, handles to it stop
+		// resolving even once the slot is reused, loading the path again starts from scratch (e.g. after a failed load)
+		// note: like EvictToBudget, call it when no frame in flight uses the asset
+		void Unload(AssetHandle<> handle);
+
+		// limits for the memory reported by Asset::GetCPUMemoryUsage/GetGPUMemoryUsage of resident assets
+		void SetMemoryBudget(usize cpuBytes, usize gpuBytes) noexcept;
+
+		// evicts assets until both budgets are met or nothing is left to evict
+		// note: gpu resources are destroyed right away, call it when no frame in flight uses them
+		void EvictToBudget();
+
+		// typed handles convert to AssetHandle<>, nullptr if the slot was reused or holds another asset type
+		template<std::derived_from<Asset> T>
+		[[nodiscard]] T* Get(AssetHandle<> handle);
+
 		template<std::derived_from<Asset> T>
 		T* Get(const UUID& id);
 
+		// like Get but doesn't count as a use, the asset can still go cold and an evicted one isn't loaded again
+		template<std::derived_from<Asset> T>
+		[[nodiscard]] T* Peek(AssetHandle<> handle);
+
+		template<std::derived_from<Asset> T>
+		[[nodiscard]] AssetHandle<T> GetHandle(const UUID& id);
+
+		template<std::derived_from<Asset> T>
+		[[nodiscard]] AssetHandle<T> GetHandle(const std::filesystem::path& path);
+
+		// ready assets only
 		template<std::derived_from<Asset> T>
 		std::vector<T*> GetAll();
 
+		// the asset in the slot whatever its state, its data must not be used before it's ready
+		[[nodiscard]] Asset* GetAsset(AssetHandle<> handle) noexcept;
+		[[nodiscard]] AssetState GetState(AssetHandle<> handle) const noexcept;
+
 		Asset* GetAssetByID(const UUID& id);
 		std::filesystem::path GetAssetPathByID(const UUID& id);
 
-		[[nodiscard]] const std::unordered_map<std::filesystem::path, std::unique_ptr<Asset>>& GetAllAssets() const noexcept { return m_Assets; }
+		[[nodiscard]] usize GetAssetCount() const noexcept { return m_Slots.size() - m_FreeSlots.size(); }
+		[[nodiscard]] u32 GetPendingLoadCount() const noexcept { return m_PendingLoads; }
+		[[nodiscard]] const AssetStats& GetStats() const noexcept { return m_Stats; }
+
+		// bumped whenever the set of ready assets changes, lets callers skip rebuilding derived data
+		[[nodiscard]] u32 GetVersion() const noexcept { return m_Version; }
+	private:
+		// note: asset classes derive from Asset directly, so a matching type id makes the static_cast safe
+		template<std::derived_from<Asset> T>
+		static T* Cast(Asset* asset) noexcept;
+
+		template<std::derived_from<Asset> T>
+		T* GetUsable(u32 slot, bool markUsed = true);
+
+		// remembers how to decode and upload the asset so it can be loaded again after an eviction
+		template<AsyncLoadable T>
+		void BindLoader(u32 slot);
+
+		[[nodiscard]] u32 FindSlot(const UUID& id) const;
+		AssetHandle<> AddSlot(std::unique_ptr<Asset> asset, const std::filesystem::path& path, AssetState state);
+
+		void QueueDecode(u32 slot);
+		// finishes one pending load without waiting for the rest, see Flush for all of them
+		void WaitForLoad(u32 slot);
+		void MakeResident(u32 slot);
+		void Evict(u32 slot);
 	private:
-		std::unordered_map<std::filesystem::path, std::unique_ptr<Asset>> m_Assets;
+		struct AssetSlot
+		{
+			std::unique_ptr<Asset> Instance;
+			std::filesystem::path Path;
+			u32 Generation = 0;
+			AssetState State = AssetState::Ready;
+
+			u32 References = 0;
+			bool Pinned = false;
+			usize CPUBytes = 0;
+			usize GPUBytes = 0;
+
+			bool (*Decode)(Asset*, const std::filesystem::path&) = nullptr;
+			void (*Upload)(Asset*) = nullptr;
+
+			// the decode job of the last QueueDecode, so one load can be waited on
+			std::unique_ptr<JobGroup> Decoding;
+		};
+
+		struct CompletedLoad
+		{
+			AssetHandle<> Handle;
+			bool Decoded = false;
+		};
+
+		void CompleteLoad(const CompletedLoad& load);
+
+		std::vector<AssetSlot> m_Slots;
+		// frame each slot was last resolved on, 0 once evicted, written by Get from any thread
+		// a deque so growing it never moves the atomics
+		std::deque<std::atomic<u32>> m_LastUsed;
+		std::vector<u32> m_EvictedSlots;
+		std::vector<u32> m_FreeSlots; // unloaded, reused by AddSlot with the next generation
+		u32 m_Frame = 1;
+		AssetStats m_Stats;
+		std::unordered_map<std::filesystem::path, u32> m_PathIndex;
+		std::unordered_map<UUID, u32> m_IDIndex;
+		std::vector<Asset*> m_Placeholders; // indexed by ComponentTypeID
+		u32 m_Version = 0;
+
+		std::mutex m_CompletedMutex;
+		std::deque<CompletedLoad> m_CompletedLoads;
+		u32 m_PendingLoads = 0;
 	};
 
 	template<std::derived_from<Asset> T>
 	T* AssetManager::Load(const std::filesystem::path& path)
 	{
-		if (m_Assets.contains(path))
+		if (auto it = m_PathIndex.find(path); it != m_PathIndex.end())
 		{
+			if (m_Slots[it->second].State == AssetState::Evicted)
+				QueueDecode(it->second);
+
+			if (m_Slots[it->second].State == AssetState::Loading)
+				WaitForLoad(it->second);
+
 			LOG_INFO("Asset: {} already loaded, returning the loaded asset.", path.string());
-			return dynamic_cast<T*>(m_Assets[path].get());
+			return Cast<T>(m_Slots[it->second].Instance.get());
 		}
 
 		if constexpr (requires(T* asset, const std::filesystem::path& p) { asset->LoadFromFile(p); })
 		{
 			auto asset = std::make_unique<T>();
+			asset->SetTypeID(ComponentTypeID<T>());
 			asset->LoadFromFile(path);
 
-			m_Assets[path] = std::move(asset);
-			return dynamic_cast<T*>(m_Assets[path].get());
+			T* loaded = asset.get();
+			AssetHandle<> handle = AddSlot(std::move(asset), path, AssetState::Ready);
+
+			if constexpr (AsyncLoadable<T>)
+				BindLoader<T>(handle.Index);
+
+			return loaded;
 		}
 		else
 		{
@@ -57,31 +237,140 @@ namespace Core
 		}
 	}
 
-	template<std::derived_from<Asset> T>
-	T* AssetManager::Get(const UUID& id)
+	template<AsyncLoadable T>
+	AssetHandle<T> AssetManager::LoadAsync(const std::filesystem::path& path)
 	{
-		for (const auto& [path, asset] : m_Assets)
+		if (auto it = m_PathIndex.find(path); it != m_PathIndex.end())
 		{
-			if (asset->GetID() == id)
+			if (!Cast<T>(m_Slots[it->second].Instance.get()))
 			{
-				return dynamic_cast<T*>(asset.get());
+				LOG_ERROR("Asset: {} is already loaded as a different type.", path.string());
+				return {};
 			}
+
+			return { it->second, m_Slots[it->second].Generation };
+		}
+
+		auto asset = std::make_unique<T>();
+		asset->SetTypeID(ComponentTypeID<T>());
+
+		AssetHandle<> handle = AddSlot(std::move(asset), path, AssetState::Loading);
+		BindLoader<T>(handle.Index);
+		QueueDecode(handle.Index);
+
+		return { handle.Index, handle.Generation };
+	}
+
+	template<std::derived_from<Asset> T>
+	void AssetManager::SetPlaceholder(T* placeholder)
+	{
+		TypeID id = ComponentTypeID<T>();
+
+		if (id >= m_Placeholders.size())
+			m_Placeholders.resize(id + 1, nullptr);
+
+		m_Placeholders[id] = placeholder;
+
+		if (placeholder)
+			Pin(placeholder->GetID());
+	}
+
+	template<std::derived_from<Asset> T>
+	T* AssetManager::Get(AssetHandle<> handle)
+	{
+		if (handle.Index >= m_Slots.size() || m_Slots[handle.Index].Generation != handle.Generation)
+			return nullptr;
+
+		return GetUsable<T>(handle.Index);
+	}
+
+	template<std::derived_from<Asset> T>
+	T* AssetManager::Peek(AssetHandle<> handle)
+	{
+		if (handle.Index >= m_Slots.size() || m_Slots[handle.Index].Generation != handle.Generation)
+			return nullptr;
+
+		return GetUsable<T>(handle.Index, false);
+	}
+
+	template<std::derived_from<Asset> T>
+	T* AssetManager::Get(const UUID& id)
+	{
+		u32 slot = FindSlot(id);
+
+		if (slot == AssetHandle<>::InvalidIndex)
+		{
+			LOG_ERROR("Asset with ID: {} not found.", static_cast<std::string>(id));
+			return nullptr;
 		}
-		LOG_ERROR("Asset with ID: {} not found.", static_cast<std::string>(id));
-		return nullptr;
+
+		return GetUsable<T>(slot);
+	}
+
+	template<std::derived_from<Asset> T>
+	T* AssetManager::GetUsable(u32 slot, bool markUsed)
+	{
+		const AssetSlot& assetSlot = m_Slots[slot];
+
+		if (markUsed)
+			m_LastUsed[slot].store(m_Frame, std::memory_order_relaxed);
+
+		if (assetSlot.State == AssetState::Ready)
+			return Cast<T>(assetSlot.Instance.get());
+
+		if (assetSlot.State == AssetState::Failed || !Cast<T>(assetSlot.Instance.get()))
+			return nullptr;
+
+		TypeID id = ComponentTypeID<T>();
+		return id < m_Placeholders.size() ? static_cast<T*>(m_Placeholders[id]) : nullptr;
+	}
+
+	template<std::derived_from<Asset> T>
+	AssetHandle<T> AssetManager::GetHandle(const UUID& id)
+	{
+		u32 slot = FindSlot(id);
+
+		if (slot == AssetHandle<>::InvalidIndex || !Cast<T>(m_Slots[slot].Instance.get()))
+			return {};
+
+		return { slot, m_Slots[slot].Generation };
+	}
+
+	template<std::derived_from<Asset> T>
+	AssetHandle<T> AssetManager::GetHandle(const std::filesystem::path& path)
+	{
+		auto it = m_PathIndex.find(path);
+
+		if (it == m_PathIndex.end() || !Cast<T>(m_Slots[it->second].Instance.get()))
+			return {};
+
+		return { it->second, m_Slots[it->second].Generation };
 	}
 
 	template<std::derived_from<Asset> T>
 	std::vector<T*> AssetManager::GetAll()
 	{
 		std::vector<T*> assets;
-		for (const auto& [path, asset] : m_Assets)
+		for (const auto& slot : m_Slots)
 		{
-			if (auto castedAsset = dynamic_cast<T*>(asset.get()); castedAsset)
+			if (auto castedAsset = Cast<T>(slot.Instance.get()); castedAsset && slot.State == AssetState::Ready)
 			{
 				assets.push_back(castedAsset);
 			}
 		}
 		return assets;
 	}
+
+	template<AsyncLoadable T>
+	void AssetManager::BindLoader(u32 slot)
+	{
+		m_Slots[slot].Decode = [](Asset* asset, const std::filesystem::path& path) { return static_cast<T*>(asset)->Decode(path); };
+		m_Slots[slot].Upload = [](Asset* asset) { static_cast<T*>(asset)->Upload(); };
+	}
+
+	template<std::derived_from<Asset> T>
+	T* AssetManager::Cast(Asset* asset) noexcept
+	{
+		return asset && asset->GetTypeID() == ComponentTypeID<T>() ? static_cast<T*>(asset) : nullptr;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+#include "Types.h"
+#include "MappedFile.h"
+
+namespace Core
+{
+	enum class PackCompression : u32
+	{
+		None = 0
+	};
+
+	struct PackHeader
+	{
+		u32 Magic = 0;
+		u32 Version = 0;
+		u32 EntryCount = 0;
+		u32 PayloadAlignment = 0;
+		u64 TocOffset = 0;
+	};
+
+	struct PackEntry
+	{
+		u64 PathHash = 0; // HashString of the path relative to the packed directory, generic separators
+		u64 Offset = 0;
+		u64 Size = 0;
+		u64 StoredSize = 0;
+		u64 ContentHash = 0; // HashBytes of the uncompressed contents
+		PackCompression Compression = PackCompression::None;
+		u32 Padding = 0;
+	};
+
+	// single file archive: PackHeader, the table of contents sorted by PathHash and the payloads,
+	// each starting on a PayloadAlignment boundary
+	// a mounted pack stays mapped, reading a file is a binary search and a slice of the mapping
+	class AssetPack
+	{
+	public:
+		static constexpr u32 Magic = 0x4B504B56; // "VKPK"
+		static constexpr u32 Version = 1;
+		static constexpr u32 PayloadAlignment = 64;
+
+		// packs every regular file under directory, returns false if it couldn't be written
+		static bool Build(const std::filesystem::path& directory, const std::filesystem::path& packPath);
+
+		[[nodiscard]] static u64 HashPath(const std::filesystem::path& relativePath);
+
+		bool Open(const std::filesystem::path& packPath);
+
+		// nullptr if the pack has no file at relativePath
+		[[nodiscard]] const PackEntry* Find(const std::filesystem::path& relativePath) const;
+		[[nodiscard]] std::span<const u8> GetData(const PackEntry& entry) const noexcept;
+
+		[[nodiscard]] std::span<const PackEntry> GetEntries() const noexcept { return m_Entries; }
+		[[nodiscard]] const std::filesystem::path& GetPath() const noexcept { return m_Path; }
+	private:
+		std::filesystem::path m_Path;
+		MappedFile m_File;
+		std::span<const PackEntry> m_Entries;
+	};
+}
\ No newline at end of file
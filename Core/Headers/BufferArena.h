@@ -0,0 +1,38 @@
+#pragma once
+
+#include <map>
+#include <limits>
+
+#include "Types.h"
+
+namespace Core
+{
+	// hands out ranges of [0, capacity) from a free list, it only does the bookkeeping, the memory behind it is the caller's
+	// allocations take the smallest free block that fits and freed blocks merge with free neighbours
+	class BufferArena
+	{
+	public:
+		static constexpr u64 InvalidOffset = std::numeric_limits<u64>::max();
+
+		BufferArena() = default;
+		explicit BufferArena(u64 capacity);
+
+		// InvalidOffset when no free block fits, alignment has to be a power of two
+		[[nodiscard]] u64 Allocate(u64 size, u64 alignment = 1);
+		// offset and size have to be exactly what Allocate got and returned
+		void Free(u64 offset, u64 size);
+
+		// the added space at the end becomes free, existing allocations keep their offsets
+		void Grow(u64 capacity);
+
+		[[nodiscard]] u64 GetCapacity() const noexcept { return m_Capacity; }
+		[[nodiscard]] u64 GetUsedBytes() const noexcept { return m_UsedBytes; }
+		[[nodiscard]] usize GetFreeBlockCount() const noexcept { return m_FreeBlocks.size(); }
+	private:
+		void AddFreeBlock(u64 offset, u64 size);
+	private:
+		std::map<u64, u64> m_FreeBlocks; // offset -> size
+		u64 m_Capacity = 0;
+		u64 m_UsedBytes = 0;
+	};
+}
\ No newline at end of file
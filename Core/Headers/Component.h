@@ -1,11 +1,21 @@
 #pragma once
 
+#include <bitset>
+#include <type_traits>
+
 #include "UUID.h"
+#include "TypeID.h"
 
 namespace Core
 {
 	class Component { public: virtual ~Component() = default; };
 
+	constexpr usize MAX_COMPONENT_TYPES = 64;
+	using ComponentMask = std::bitset<MAX_COMPONENT_TYPES>;
+
+	template<typename T>
+	[[nodiscard]] TypeID ComponentTypeID() noexcept { return TypeRegistry<Component>::Get<std::remove_cv_t<T>>(); }
+
 	class Asset : public Component 
 	{ 
 	public: 
@@ -14,7 +24,18 @@ namespace Core
 
 		[[nodiscard]] const UUID& GetID() const noexcept { return m_ID; }
 
+		// component type id of the concrete asset class, set by the AssetManager when it creates the asset
+		[[nodiscard]] TypeID GetTypeID() const noexcept { return m_TypeID; }
+		void SetTypeID(TypeID typeId) noexcept { m_TypeID = typeId; }
+
+		// frees the loaded data when the AssetManager evicts the asset, it's loaded again with Decode and Upload
+		virtual void Release() {}
+
+		// bytes held by the loaded asset, counted against the AssetManager memory budgets
+		[[nodiscard]] virtual usize GetCPUMemoryUsage() const noexcept { return 0; }
+		[[nodiscard]] virtual usize GetGPUMemoryUsage() const noexcept { return 0; }
 	private:
 		UUID m_ID;
+		TypeID m_TypeID = INVALID_TYPE_ID;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <limits>
+#include <utility>
+#include <memory>
+#include <memory_resource>
+#include <bit>
+#include <algorithm>
+
+#include "Types.h"
+
+namespace Core
+{
+	constexpr u32 INVALID_POOL_INDEX = std::numeric_limits<u32>::max();
+
+	class IComponentPool
+	{
+	public:
+		virtual ~IComponentPool() = default;
+
+		virtual bool Contains(u32 entityIndex) const = 0;
+		virtual void Remove(u32 entityIndex) = 0;
+
+		// returns the spare pages kept for reuse to the memory resource
+		virtual void ReleaseFreePages() = 0;
+
+		[[nodiscard]] virtual usize Size() const noexcept = 0;
+	};
+
+	// sparse set: m_Sparse maps an entity index to a slot in the dense arrays,
+	// the dense arrays are kept packed so iteration never touches holes
+	// m_ChangedTicks holds the ECS tick each component was last added or written on
+	// components are stored in fixed-size pages taken from a pmr resource, pages never move once allocated,
+	// so adding components doesn't invalidate pointers, removing one moves the last component into the hole
+	// pages emptied by removals go on a free list and are reused before the resource is asked again
+	template<typename T>
+	class ComponentPool : public IComponentPool
+	{
+	public:
+		static constexpr usize PageBytes = 64 * 1024;
+		// a power of two so a slot splits into page and offset with a shift and a mask
+		static constexpr usize PageCapacity = std::bit_floor(std::max<usize>(PageBytes / sizeof(T), 1));
+
+		explicit ComponentPool(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+		virtual ~ComponentPool() override;
+
+		ComponentPool(const ComponentPool&) = delete;
+		ComponentPool& operator=(const ComponentPool&) = delete;
+
+		template<typename... Args>
+		T* Emplace(u32 entityIndex, u32 tick, Args&&... args);
+
+		virtual bool Contains(u32 entityIndex) const override;
+		virtual void Remove(u32 entityIndex) override;
+		virtual void ReleaseFreePages() override;
+
+		[[nodiscard]] T* Get(u32 entityIndex);
+
+		void MarkChanged(u32 entityIndex, u32 tick);
+		[[nodiscard]] u32 GetChangedTick(u32 entityIndex) const;
+
+		[[nodiscard]] virtual usize Size() const noexcept override { return m_DenseEntities.size(); }
+
+		[[nodiscard]] std::span<const u32> GetEntities() const noexcept { return m_DenseEntities; }
+		[[nodiscard]] std::span<const u32> GetChangedTicks() const noexcept { return m_ChangedTicks; }
+	private:
+		[[nodiscard]] T* SlotAt(usize slot) const noexcept { return m_Pages[slot / PageCapacity] + slot % PageCapacity; }
+	private:
+		std::pmr::memory_resource* m_Resource = nullptr;
+
+		std::pmr::vector<u32> m_Sparse;
+		std::pmr::vector<u32> m_DenseEntities;
+		std::pmr::vector<u32> m_ChangedTicks;
+
+		std::pmr::vector<T*> m_Pages;
+		std::pmr::vector<T*> m_FreePages;
+	};
+
+	template<typename T>
+	ComponentPool<T>::ComponentPool(std::pmr::memory_resource* resource) :
+		m_Resource(resource), m_Sparse(resource), m_DenseEntities(resource), m_ChangedTicks(resource),
+		m_Pages(resource), m_FreePages(resource)
+	{
+	}
+
+	template<typename T>
+	ComponentPool<T>::~ComponentPool()
+	{
+		for (usize slot = 0; slot < m_DenseEntities.size(); slot++)
+			std::destroy_at(SlotAt(slot));
+
+		for (T* page : m_Pages)
+			m_Resource->deallocate(page, sizeof(T) * PageCapacity, alignof(T));
+
+		ReleaseFreePages();
+	}
+
+	template<typename T>
+	template<typename... Args>
+	T* ComponentPool<T>::Emplace(u32 entityIndex, u32 tick, Args&&... args)
+	{
+		usize slot = m_DenseEntities.size();
+
+		if (slot == m_Pages.size() * PageCapacity)
+		{
+			if (!m_FreePages.empty())
+			{
+				m_Pages.push_back(m_FreePages.back());
+				m_FreePages.pop_back();
+			}
+			else
+			{
+				m_Pages.push_back(static_cast<T*>(m_Resource->allocate(sizeof(T) * PageCapacity, alignof(T))));
+			}
+		}
+
+		T* component = ::new (static_cast<void*>(SlotAt(slot))) T(std::forward<Args>(args)...);
+
+		if (entityIndex >= m_Sparse.size())
+			m_Sparse.resize(entityIndex + 1, INVALID_POOL_INDEX);
+
+		m_Sparse[entityIndex] = static_cast<u32>(slot);
+		m_DenseEntities.push_back(entityIndex);
+		m_ChangedTicks.push_back(tick);
+
+		return component;
+	}
+
+	template<typename T>
+	bool ComponentPool<T>::Contains(u32 entityIndex) const
+	{
+		return entityIndex < m_Sparse.size() && m_Sparse[entityIndex] != INVALID_POOL_INDEX;
+	}
+
+	template<typename T>
+	void ComponentPool<T>::Remove(u32 entityIndex)
+	{
+		if (!Contains(entityIndex))
+			return;
+
+		u32 slot = m_Sparse[entityIndex];
+		u32 last = static_cast<u32>(m_DenseEntities.size() - 1);
+
+		if (slot != last)
+		{
+			*SlotAt(slot) = std::move(*SlotAt(last));
+			m_DenseEntities[slot] = m_DenseEntities[last];
+			m_ChangedTicks[slot] = m_ChangedTicks[last];
+			m_Sparse[m_DenseEntities[slot]] = slot;
+		}
+
+		std::destroy_at(SlotAt(last));
+
+		m_DenseEntities.pop_back();
+		m_ChangedTicks.pop_back();
+		m_Sparse[entityIndex] = INVALID_POOL_INDEX;
+
+		// the last page just became empty
+		if (last % PageCapacity == 0)
+		{
+			m_FreePages.push_back(m_Pages.back());
+			m_Pages.pop_back();
+		}
+	}
+
+	template<typename T>
+	void ComponentPool<T>::ReleaseFreePages()
+	{
+		for (T* page : m_FreePages)
+			m_Resource->deallocate(page, sizeof(T) * PageCapacity, alignof(T));
+
+		m_FreePages.clear();
+	}
+
+	template<typename T>
+	T* ComponentPool<T>::Get(u32 entityIndex)
+	{
+		if (!Contains(entityIndex))
+			return nullptr;
+
+		return SlotAt(m_Sparse[entityIndex]);
+	}
+
+	template<typename T>
+	void ComponentPool<T>::MarkChanged(u32 entityIndex, u32 tick)
+	{
+		if (Contains(entityIndex))
+			m_ChangedTicks[m_Sparse[entityIndex]] = tick;
+	}
+
+	template<typename T>
+	u32 ComponentPool<T>::GetChangedTick(u32 entityIndex) const
+	{
+		return Contains(entityIndex) ? m_ChangedTicks[m_Sparse[entityIndex]] : 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <tuple>
+#include <atomic>
+#include <array>
+#include <concepts>
+#include <type_traits>
+
+#include "Types.h"
+#include "Entity.h"
+#include "UUID.h"
+#include "Component.h"
+#include "ComponentPool.h"
+#include "AssetHandle.h"
+#include "AssetManager.h"
+
+namespace Core
+{
+	// assets are shared between entities, their pools only hold a handle into the AssetManager slot table
+	template<typename T>
+	using PoolOf = std::conditional_t<std::derived_from<T, Asset>, ComponentPool<AssetHandle<>>, ComponentPool<std::remove_const_t<T>>>;
+
+	class IComponentView
+	{
+	public:
+		virtual ~IComponentView() = default;
+	};
+
+	// note: a view resolves its pools once when the ECS creates it, the ECS keeps it cached so
+	// calling ECS::View<Ts...>() again costs a single map lookup
+	// visiting is side-effect free, a callback that writes a tracked component marks it with MarkChanged
+	template<std::derived_from<Component>... Ts>
+	class ComponentView : public IComponentView
+	{
+	public:
+		ComponentView(const std::vector<u32>& generations, const std::vector<ComponentMask>& masks, std::atomic<u32>& iterationDepth,
+			const u32& currentTick, AssetManager* assetManager, PoolOf<Ts>*... pools) :
+			m_Generations(generations), m_Masks(masks), m_IterationDepth(iterationDepth), m_CurrentTick(currentTick),
+			m_AssetManager(assetManager), m_Pools(pools...)
+		{
+			(m_Required.set(ComponentTypeID<Ts>()), ...);
+		}
+
+		// func is called as func(Entity, Ts&...) for every entity that has all of Ts
+		template<typename Func>
+		void Each(Func&& func);
+
+		// same as Each but only visits the candidates in [begin, end) of SizeHint(), used to split a view across threads
+		template<typename Func>
+		void Each(usize begin, usize end, Func&& func);
+
+		// same as Each but only visits entities whose TChanged component changed after sinceTick,
+		// walks TChanged's change ticks so unchanged entities cost a single compare
+		// note: the walk is still linear in TChanged's pool on every call, a list of changed entities would have to be
+		// shared by MarkChanged calls from worker threads and trimmed for consumers that each read from their own tick
+		template<std::derived_from<Component> TChanged, typename Func>
+		void EachChangedSince(u32 sinceTick, Func&& func);
+
+		// upper bound of the matching entities, the size of the smallest pool
+		[[nodiscard]] usize SizeHint() const noexcept;
+
+		// ECS::MarkChanged through the pool the view already holds, safe from Each for the visited entity
+		template<std::derived_from<Component> T>
+		void MarkChanged(Entity entity);
+	private:
+		[[nodiscard]] std::span<const u32> GetSmallestPoolEntities() const noexcept;
+
+		template<typename Func>
+		void Visit(u32 entityIndex, Func& func);
+
+		template<typename T>
+		static constexpr usize IndexOf();
+
+		template<typename T>
+		T* Fetch(u32 entityIndex);
+	private:
+		const std::vector<u32>& m_Generations;
+		const std::vector<ComponentMask>& m_Masks;
+		std::atomic<u32>& m_IterationDepth;
+		const u32& m_CurrentTick;
+		ComponentMask m_Required;
+		AssetManager* m_AssetManager = nullptr;
+		std::tuple<PoolOf<Ts>*...> m_Pools;
+	};
+
+	template<std::derived_from<Component>... Ts>
+	template<typename Func>
+	void ComponentView<Ts...>::Each(Func&& func)
+	{
+		Each(0, SizeHint(), std::forward<Func>(func));
+	}
+
+	template<std::derived_from<Component>... Ts>
+	template<typename Func>
+	void ComponentView<Ts...>::Each(usize begin, usize end, Func&& func)
+	{
+		// the ECS refuses structural changes while this is non-zero, so the pools can't shift under the loop
+		m_IterationDepth.fetch_add(1, std::memory_order_relaxed);
+
+		// walk the smallest pool in dense order, reject with the entity mask and fetch the rest through the sparse arrays
+		std::span<const u32> candidates = GetSmallestPoolEntities();
+
+		for (usize i = begin; i < end; i++)
+			Visit(candidates[i], func);
+
+		m_IterationDepth.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	template<std::derived_from<Component>... Ts>
+	template<std::derived_from<Component> TChanged, typename Func>
+	void ComponentView<Ts...>::EachChangedSince(u32 sinceTick, Func&& func)
+	{
+		static_assert(!std::derived_from<TChanged, Asset>, "Asset references don't track changes.");
+
+		m_IterationDepth.fetch_add(1, std::memory_order_relaxed);
+
+		auto* pool = std::get<IndexOf<TChanged>()>(m_Pools);
+		std::span<const u32> entities = pool->GetEntities();
+		std::span<const u32> changedTicks = pool->GetChangedTicks();
+
+		for (usize i = 0; i < entities.size(); i++)
+		{
+			if (changedTicks[i] > sinceTick)
+				Visit(entities[i], func);
+		}
+
+		m_IterationDepth.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	template<std::derived_from<Component>... Ts>
+	usize ComponentView<Ts...>::SizeHint() const noexcept
+	{
+		return GetSmallestPoolEntities().size();
+	}
+
+	template<std::derived_from<Component>... Ts>
+	std::span<const u32> ComponentView<Ts...>::GetSmallestPoolEntities() const noexcept
+	{
+		auto entities = std::apply([](const auto*... pools) {
+			return std::array<std::span<const u32>, sizeof...(Ts)>{ pools->GetEntities()... };
+		}, m_Pools);
+
+		std::span<const u32> smallest = entities[0];
+
+		for (std::span<const u32> poolEntities : entities)
+		{
+			if (poolEntities.size() < smallest.size())
+				smallest = poolEntities;
+		}
+
+		return smallest;
+	}
+
+	template<std::derived_from<Component>... Ts>
+	template<typename Func>
+	void ComponentView<Ts...>::Visit(u32 entityIndex, Func& func)
+	{
+		if ((m_Masks[entityIndex] & m_Required) != m_Required)
+			return;
+
+		std::tuple<Ts*...> components = { Fetch<Ts>(entityIndex)... };
+
+		if (!std::apply([](auto*... component) { return ((component != nullptr) && ...); }, components))
+			return;
+
+		Entity entity = { entityIndex, m_Generations[entityIndex] };
+		std::apply([&](auto*... component) { func(entity, *component...); }, components);
+	}
+
+	template<std::derived_from<Component>... Ts>
+	template<typename T>
+	constexpr usize ComponentView<Ts...>::IndexOf()
+	{
+		constexpr bool matches[] = { std::is_same_v<std::remove_const_t<T>, std::remove_const_t<Ts>>... };
+		usize i = 0;
+		while (!matches[i]) i++;
+		return i;
+	}
+
+	template<std::derived_from<Component>... Ts>
+	template<typename T>
+	T* ComponentView<Ts...>::Fetch(u32 entityIndex)
+	{
+		auto* pool = std::get<IndexOf<T>()>(m_Pools);
+
+		if constexpr (std::derived_from<T, Asset>)
+		{
+			AssetHandle<>* handle = pool->Get(entityIndex);
+			return handle ? m_AssetManager->Get<std::remove_const_t<T>>(*handle) : nullptr;
+		}
+		else
+		{
+			return pool->Get(entityIndex);
+		}
+	}
+
+	template<std::derived_from<Component>... Ts>
+	template<std::derived_from<Component> T>
+	void ComponentView<Ts...>::MarkChanged(Entity entity)
+	{
+		static_assert(!std::derived_from<T, Asset>, "Asset references don't track changes.");
+
+		std::get<IndexOf<T>()>(m_Pools)->MarkChanged(entity.Index, m_CurrentTick);
+	}
+}
\ No newline at end of file
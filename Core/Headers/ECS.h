@@ -1,151 +1,415 @@
 #pragma once
 
-#include <unordered_map>
 #include <vector>
 #include <concepts>
 #include <memory>
-#include <typeindex>
+#include <atomic>
 
 #include "UUID.h"
+#include "Entity.h"
 #include "Types.h"
+#include "TypeID.h"
 #include "Random.h"
 #include "Component.h"
+#include "ComponentPool.h"
+#include "ComponentView.h"
+#include "System.h"
+#include "EntityCommandBuffer.h"
+#include "ThreadPool.h"
+#include "MemoryResource.h"
 #include "Log.h"
 #include "AssetManager.h"
 
 namespace Core
 {
+	// note: components live packed in per-type pools made of fixed-size pages, a pointer returned by
+	// AddComponent/GetComponent survives adding more components but not removing one of the same type
+	// (destroying an entity removes all of its components), the last component is moved into the hole
+	// every pool allocates its pages and index arrays through one CountingResource, see GetAllocationStats
+	// pools are indexed by ComponentTypeID and every entity keeps a ComponentMask, so the ECS needs no rtti
+	// structural changes (create/destroy/add/remove) are rejected while a view is being iterated,
+	// record them in an EntityCommandBuffer instead
 	class ECS
 	{
 	public:
-		explicit ECS(AssetManager* assetManager) : m_AssetManager(assetManager) {}
-		UUID CreateEntity();
+		// upstream can be any pmr resource, e.g. a std::pmr::unsynchronized_pool_resource owned by the caller
+		explicit ECS(AssetManager* assetManager, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) :
+			m_ComponentMemory(upstream), m_AssetManager(assetManager) {}
+		Entity CreateEntity();
 
-		template<std::derived_from<Component> T, typename... Args>
-		T* AddComponent(const UUID& entity, Args&&... args);
+		// removes every component of the entity and recycles its slot, old handles stop being alive
+		void DestroyEntity(Entity entity);
+
+		[[nodiscard]] bool IsAlive(Entity entity) const noexcept;
+		[[nodiscard]] bool IsIterating() const noexcept { return m_IterationDepth.load(std::memory_order_relaxed) != 0; }
+
+		// bumped by every structural change, lets caches built from the entity layout know when to rebuild
+		[[nodiscard]] u32 GetStructureVersion() const noexcept { return m_StructureVersion; }
+
+		// change tracking clock, components remember the tick they were last added or written on
+		[[nodiscard]] u32 GetTick() const noexcept { return m_Tick; }
+		// starts a new tick and returns the one that ended, pass it to ChangedSince/EachChangedSince next time
+		u32 AdvanceTick() noexcept { return m_Tick++; }
+
+		// true if the component was added or written after sinceTick
+		template<std::derived_from<Component> T>
+		[[nodiscard]] bool ChangedSince(Entity entity, u32 sinceTick);
+
+		// nothing is marked implicitly, whoever writes a tracked component calls this or goes through Patch
+		// safe to call from several threads for different entities once T's pool exists
+		template<std::derived_from<Component> T>
+		void MarkChanged(Entity entity);
+
+		// calls func(T&) and marks the component changed, returns false if the entity doesn't have it
+		template<std::derived_from<Component> T, typename Func> requires (!std::derived_from<T, Asset>)
+		bool Patch(Entity entity, Func&& func);
+
+		// assets are shared, they're referenced through the overloads below
+		template<std::derived_from<Component> T, typename... Args> requires (!std::derived_from<T, Asset>)
+		T* AddComponent(Entity entity, Args&&... args);
+
+		// the id is resolved to an AssetHandle once here, lookups through the entity don't hash anything
+		// every asset component holds a reference on its asset until it's removed, see AssetManager
+		template<std::derived_from<Asset> T>
+		void AddComponent(Entity entity, const UUID& assetId);
 
 		template<std::derived_from<Asset> T>
-		void AddComponent(const UUID& entity, const UUID& assetId);
+		void AddComponent(Entity entity, AssetHandle<T> handle);
+
+		template<std::derived_from<Component> T>
+		void RemoveComponent(Entity entity);
 
 		template<std::derived_from<Component> T>
-		bool HasComponent(const UUID& entity);
+		bool HasComponent(Entity entity);
 
 		template<std::derived_from<Component>... Ts>
-		bool HasComponents(const UUID& entity);
+		bool HasComponents(Entity entity);
 
+		// doesn't mark anything changed, write through Patch or call MarkChanged after writing
 		template<std::derived_from<Component> T>
-		T* GetComponent(const UUID& entity);
+		T* GetComponent(Entity entity);
+
+		// the entity's reference without resolving it, so the asset isn't counted as used, null if it has none
+		template<std::derived_from<Asset> T>
+		[[nodiscard]] AssetHandle<T> GetAssetHandle(Entity entity);
+
+		// cached view over every entity that has all of Ts, see ComponentView::Each
+		template<std::derived_from<Component>... Ts>
+		ComponentView<Ts...>& View();
+
+		// func is called as func(deltaTime, Entity, Ts&...), systems that don't write what another one touches
+		// run concurrently and every system is split into entity ranges of at least minBatchSize
+		// note: func runs on worker threads, structural changes go through GetCommandBuffer()
+		// and writes to change-tracked components are marked with MarkChanged
+		template<std::derived_from<Component>... Ts, typename Func>
+		void AddSystem(const std::string& name, Func&& func, usize minBatchSize = 64);
+
+		// runs every system and then plays back the shared command buffer
+		void RunSystems(f32 deltaTime);
+
+		[[nodiscard]] EntityCommandBuffer& GetCommandBuffer() noexcept { return m_CommandBuffer; }
+
+		std::vector<Asset*> GetAllEntityAssets(Entity entity);
+
+		// allocations made for component storage, grows with the number of pages rather than components
+		[[nodiscard]] AllocationStats GetAllocationStats() const noexcept { return m_ComponentMemory.GetStats(); }
+
+		// gives the pages emptied by removals back to the upstream resource
+		void ReleaseFreePages();
+	private:
+		template<typename T>
+		PoolOf<T>* GetPool();
 
-		std::vector<Asset*> GetAllEntityAssets(const UUID& entity);
+		[[nodiscard]] bool CanChangeStructure() const;
+
+		void BuildSystemStages();
 	private:
-		std::unordered_map<UUID, std::vector<std::unique_ptr<Component>>> m_EntityComponentMap;
-		std::unordered_map<UUID, std::unordered_map<std::type_index, UUID>> m_EntityAssetMap;
+		std::vector<u32> m_Generations;
+		std::vector<ComponentMask> m_ComponentMasks;
+		std::vector<u32> m_FreeIndices;
+
+		// declared before the pools so it outlives them
+		CountingResource m_ComponentMemory;
+		std::vector<std::unique_ptr<IComponentPool>> m_ComponentPools;
+		ComponentMask m_AssetTypes;
+
+		std::vector<std::unique_ptr<IComponentView>> m_Views;
+		std::atomic<u32> m_IterationDepth = 0;
+		u32 m_Tick = 1;
+		u32 m_StructureVersion = 0;
+
+		EntityCommandBuffer m_CommandBuffer;
+
+		std::vector<System> m_Systems;
+		std::vector<std::vector<u32>> m_SystemStages;
+		bool m_SystemStagesDirty = false;
 		AssetManager* m_AssetManager = nullptr;
  	};
 
-	template<std::derived_from<Component> T, typename... Args>
-	T* ECS::AddComponent(const UUID& entity, Args&&... args)
+	template<std::derived_from<Component> T, typename... Args> requires (!std::derived_from<T, Asset>)
+	T* ECS::AddComponent(Entity entity, Args&&... args)
 	{
-		auto it = m_EntityComponentMap.find(entity);
-
-		if (it == m_EntityComponentMap.end())
+		if (!IsAlive(entity))
 		{
-			LOG_ERROR("Entity {} does not exist.", static_cast<std::string>(entity));
+			LOG_ERROR("Entity {} does not exist.", entity.Index);
 			return nullptr;
 		}
 
-		if (HasComponent<T>(entity))
+		if (!CanChangeStructure())
+			return nullptr;
+
+		ComponentMask& mask = m_ComponentMasks[entity.Index];
+
+		if (mask.test(ComponentTypeID<T>()))
 		{
-			LOG_ERROR("Component of this type already exists on entity: {}", static_cast<std::string>(entity));
+			LOG_ERROR("Component of this type already exists on entity: {}", entity.Index);
 			return nullptr;
 		}
 
-		Component* component = it->second.emplace_back(std::make_unique<T>(std::forward<Args>(args)...)).get();
-		return dynamic_cast<T*>(component);
+		mask.set(ComponentTypeID<T>());
+		m_StructureVersion++;
+
+		return GetPool<T>()->Emplace(entity.Index, m_Tick, std::forward<Args>(args)...);
+	}
+
+	template<std::derived_from<Asset> T>
+	void ECS::AddComponent(Entity entity, const UUID& assetId)
+	{
+		AssetHandle<T> handle = m_AssetManager->GetHandle<T>(assetId);
+
+		if (handle.IsNull())
+		{
+			LOG_ERROR("Asset with ID: {} is not loaded or has a different type.", static_cast<std::string>(assetId));
+			return;
+		}
+
+		AddComponent<T>(entity, handle);
 	}
 
 	template<std::derived_from<Asset> T>
-	void ECS::AddComponent(const UUID& entity, const UUID& assetId)
+	void ECS::AddComponent(Entity entity, AssetHandle<T> handle)
 	{
-		auto it = m_EntityAssetMap.find(entity);
+		if (!IsAlive(entity))
+		{
+			LOG_ERROR("Entity {} does not exist.", entity.Index);
+			return;
+		}
 
-		if (it == m_EntityAssetMap.end())
+		if (handle.IsNull())
 		{
-			LOG_ERROR("Entity {} does not exist.", static_cast<std::string>(entity));
+			LOG_ERROR("Can't add a null asset handle to entity: {}", entity.Index);
 			return;
 		}
 
-		if (it->second.contains(std::type_index(typeid(T))))
+		if (!CanChangeStructure())
+			return;
+
+		ComponentMask& mask = m_ComponentMasks[entity.Index];
+
+		if (mask.test(ComponentTypeID<T>()))
 		{
-			LOG_ERROR("Asset of this type already exists on entity: {}", static_cast<std::string>(entity));
+			LOG_ERROR("Asset of this type already exists on entity: {}", entity.Index);
 			return;
 		}
 
-		Asset* asset = m_AssetManager->Get<T>(assetId);
-		m_EntityAssetMap[entity][typeid(T)] = assetId;
+		mask.set(ComponentTypeID<T>());
+		m_StructureVersion++;
+
+		GetPool<T>()->Emplace(entity.Index, m_Tick, AssetHandle<>(handle));
+		m_AssetManager->AddReference(handle);
 	}
 
 	template<std::derived_from<Component> T>
-	bool ECS::HasComponent(const UUID& entity)
+	void ECS::RemoveComponent(Entity entity)
 	{
-		auto it = m_EntityComponentMap.find(entity);
+		if (!IsAlive(entity))
+		{
+			LOG_ERROR("Entity {} does not exist.", entity.Index);
+			return;
+		}
+
+		if (!CanChangeStructure())
+			return;
+
+		ComponentMask& mask = m_ComponentMasks[entity.Index];
 
-		if (it == m_EntityComponentMap.end())
+		if (!mask.test(ComponentTypeID<T>()))
 		{
-			LOG_ERROR("Entity {} does not exist.", static_cast<std::string>(entity));
-			return false;
+			LOG_WARN("Component of this type does not exist on entity: {}", entity.Index);
+			return;
 		}
 
+		mask.reset(ComponentTypeID<T>());
+		m_StructureVersion++;
+
 		if constexpr (std::derived_from<T, Asset>)
+			m_AssetManager->ReleaseReference(*GetPool<T>()->Get(entity.Index));
+
+		GetPool<T>()->Remove(entity.Index);
+	}
+
+	template<std::derived_from<Component> T>
+	bool ECS::ChangedSince(Entity entity, u32 sinceTick)
+	{
+		static_assert(!std::derived_from<T, Asset>, "Asset references don't track changes.");
+
+		if (!IsAlive(entity))
 		{
-			return m_EntityAssetMap.contains(entity) && m_EntityAssetMap[entity].contains(std::type_index(typeid(T)));
+			LOG_ERROR("Entity {} does not exist.", entity.Index);
+			return false;
 		}
-		
-		for (const auto& component : it->second)
+
+		return GetPool<T>()->GetChangedTick(entity.Index) > sinceTick;
+	}
+
+	template<std::derived_from<Component> T>
+	void ECS::MarkChanged(Entity entity)
+	{
+		static_assert(!std::derived_from<T, Asset>, "Asset references don't track changes.");
+
+		GetPool<T>()->MarkChanged(entity.Index, m_Tick);
+	}
+
+	template<std::derived_from<Component> T, typename Func> requires (!std::derived_from<T, Asset>)
+	bool ECS::Patch(Entity entity, Func&& func)
+	{
+		T* component = GetComponent<T>(entity);
+
+		if (!component)
+			return false;
+
+		func(*component);
+		GetPool<T>()->MarkChanged(entity.Index, m_Tick);
+
+		return true;
+	}
+
+	template<std::derived_from<Component> T>
+	bool ECS::HasComponent(Entity entity)
+	{
+		if (!IsAlive(entity))
 		{
-			if (dynamic_cast<T*>(component.get()))
-			{
-				return true;
-			}
+			LOG_ERROR("Entity {} does not exist.", entity.Index);
+			return false;
 		}
 
-		return false;
+		return m_ComponentMasks[entity.Index].test(ComponentTypeID<T>());
 	}
 
 	template<std::derived_from<Component>... Ts>
-	bool ECS::HasComponents(const UUID& entity)
+	bool ECS::HasComponents(Entity entity)
 	{
-		return (HasComponent<Ts>(entity) && ...);
+		if (!IsAlive(entity))
+		{
+			LOG_ERROR("Entity {} does not exist.", entity.Index);
+			return false;
+		}
+
+		ComponentMask required;
+		(required.set(ComponentTypeID<Ts>()), ...);
+
+		return (m_ComponentMasks[entity.Index] & required) == required;
 	}
 
-	template<std::derived_from<Component> T>
-	T* ECS::GetComponent(const UUID& entity)
+	template<std::derived_from<Asset> T>
+	AssetHandle<T> ECS::GetAssetHandle(Entity entity)
 	{
-		auto it = m_EntityComponentMap.find(entity);
+		if (!IsAlive(entity))
+			return {};
+
+		AssetHandle<>* handle = GetPool<T>()->Get(entity.Index);
+		return handle ? AssetHandle<T>{ handle->Index, handle->Generation } : AssetHandle<T>{};
+	}
 
-		if (it == m_EntityComponentMap.end())
+	template<std::derived_from<Component> T>
+	T* ECS::GetComponent(Entity entity)
+	{
+		if (!IsAlive(entity))
 		{
-			LOG_ERROR("Entity {} does not exist.", static_cast<std::string>(entity));
+			LOG_ERROR("Entity {} does not exist.", entity.Index);
 			return nullptr;
 		}
 
 		if constexpr (std::derived_from<T, Asset>)
 		{
-			return m_AssetManager->Get<T>(m_EntityAssetMap[entity][std::type_index(typeid(T))]);
-		}
+			AssetHandle<>* handle = GetPool<T>()->Get(entity.Index);
 
-		for (const auto& component : it->second)
-		{
-			if (auto castedComponent = dynamic_cast<T*>(component.get()))
+			if (!handle)
 			{
-				return castedComponent;
+				LOG_ERROR("Asset of this type does not exist on entity: {}", entity.Index);
+				return nullptr;
 			}
+
+			return m_AssetManager->Get<std::remove_const_t<T>>(*handle);
+		}
+		else
+		{
+			T* component = GetPool<T>()->Get(entity.Index);
+
+			if (!component)
+				LOG_ERROR("Component of this type does not exist on entity: {}", entity.Index);
+
+			return component;
 		}
+	}
+
+	template<typename T>
+	PoolOf<T>* ECS::GetPool()
+	{
+		TypeID id = ComponentTypeID<T>();
+		ASSERT(id < MAX_COMPONENT_TYPES);
+
+		if (id >= m_ComponentPools.size())
+			m_ComponentPools.resize(id + 1);
 
-		LOG_ERROR("Component of this type does not exist on entity: {}", static_cast<std::string>(entity));
+		auto& pool = m_ComponentPools[id];
+
+		if (!pool)
+		{
+			pool = std::make_unique<PoolOf<T>>(&m_ComponentMemory);
+
+			if constexpr (std::derived_from<T, Asset>)
+				m_AssetTypes.set(id);
+		}
 
-		return nullptr;
+		return static_cast<PoolOf<T>*>(pool.get());
 	}
 
-	
-}
\ No newline at end of file
+	template<std::derived_from<Component>... Ts>
+	ComponentView<Ts...>& ECS::View()
+	{
+		TypeID id = TypeRegistry<IComponentView>::Get<ComponentView<Ts...>>();
+
+		if (id >= m_Views.size())
+			m_Views.resize(id + 1);
+
+		auto& view = m_Views[id];
+
+		if (!view)
+			view = std::make_unique<ComponentView<Ts...>>(m_Generations, m_ComponentMasks, m_IterationDepth, m_Tick,
+				m_AssetManager, GetPool<Ts>()...);
+
+		return *static_cast<ComponentView<Ts...>*>(view.get());
+	}
+
+	template<std::derived_from<Component>... Ts, typename Func>
+	void ECS::AddSystem(const std::string& name, Func&& func, usize minBatchSize)
+	{
+		System system;
+		system.Name = name;
+		system.MinBatchSize = minBatchSize;
+
+		((std::is_const_v<Ts> ? system.Reads : system.Writes).push_back(ComponentTypeID<Ts>()), ...);
+
+		ComponentView<Ts...>* view = &View<Ts...>();
+
+		system.GetCandidateCount = [view]() { return view->SizeHint(); };
+		system.Run = [view, func = std::forward<Func>(func)](f32 deltaTime, usize begin, usize end)
+		{
+			view->Each(begin, end, [&](Entity entity, Ts&... components) { func(deltaTime, entity, components...); });
+		};
+
+		m_Systems.push_back(std::move(system));
+		m_SystemStagesDirty = true;
+	}
+}
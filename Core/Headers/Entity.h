@@ -0,0 +1,37 @@
+#pragma once
+
+#include <limits>
+#include <functional>
+
+#include "Types.h"
+
+namespace Core
+{
+	// runtime entity handle, Index addresses the ECS slot and Generation detects handles to recycled slots
+	struct Entity
+	{
+		static constexpr u32 InvalidIndex = std::numeric_limits<u32>::max();
+		// marks a placeholder returned by EntityCommandBuffer::CreateEntity, resolved on playback
+		static constexpr u32 PendingGeneration = std::numeric_limits<u32>::max();
+
+		u32 Index = InvalidIndex;
+		u32 Generation = 0;
+
+		[[nodiscard]] bool IsNull() const noexcept { return Index == InvalidIndex; }
+		[[nodiscard]] bool IsPending() const noexcept { return !IsNull() && Generation == PendingGeneration; }
+		[[nodiscard]] u64 ToU64() const noexcept { return (static_cast<u64>(Generation) << 32) | Index; }
+
+		bool operator==(const Entity& other) const noexcept = default;
+	};
+
+	constexpr Entity NullEntity = {};
+}
+
+template<>
+struct std::hash<Core::Entity>
+{
+	std::size_t operator()(const Core::Entity& entity) const noexcept
+	{
+		return std::hash<u64>()(entity.ToU64());
+	}
+};
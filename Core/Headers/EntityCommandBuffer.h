@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <concepts>
+
+#include "Types.h"
+#include "Entity.h"
+#include "UUID.h"
+#include "Component.h"
+
+namespace Core
+{
+	class ECS;
+
+	// records structural changes so they can be made while the ECS is being iterated or from worker threads,
+	// Playback applies everything in recording order at a point where nothing iterates
+	class EntityCommandBuffer
+	{
+	public:
+		// returns a placeholder that can be used with the other commands of this buffer until playback
+		Entity CreateEntity();
+		void DestroyEntity(Entity entity);
+
+		template<std::derived_from<Component> T>
+		void AddComponent(Entity entity, T component = {});
+
+		template<std::derived_from<Asset> T>
+		void AddComponent(Entity entity, const UUID& assetId);
+
+		template<std::derived_from<Component> T>
+		void RemoveComponent(Entity entity);
+
+		void Playback(ECS& ecs);
+
+		[[nodiscard]] bool IsEmpty();
+	private:
+		struct Command
+		{
+			Entity Target;
+			std::function<void(ECS&, Entity)> Apply; // empty for entity creation
+		};
+
+		void Record(Entity entity, std::function<void(ECS&, Entity)> apply);
+	private:
+		std::mutex m_Mutex;
+		std::vector<Command> m_Commands;
+		u32 m_PendingEntities = 0;
+	};
+
+	template<std::derived_from<Component> T>
+	void EntityCommandBuffer::AddComponent(Entity entity, T component)
+	{
+		static_assert(!std::derived_from<T, Asset>, "Assets are shared, reference them with AddComponent<T>(entity, assetId).");
+
+		Record(entity, [component = std::move(component)](auto& ecs, Entity target) mutable {
+			ecs.template AddComponent<T>(target, std::move(component));
+		});
+	}
+
+	template<std::derived_from<Asset> T>
+	void EntityCommandBuffer::AddComponent(Entity entity, const UUID& assetId)
+	{
+		Record(entity, [assetId](auto& ecs, Entity target) { ecs.template AddComponent<T>(target, assetId); });
+	}
+
+	template<std::derived_from<Component> T>
+	void EntityCommandBuffer::RemoveComponent(Entity entity)
+	{
+		Record(entity, [](auto& ecs, Entity target) { ecs.template RemoveComponent<T>(target); });
+	}
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+#include "Types.h"
+#include "VkTypes.h"
+#include "ECS.h"
+#include "Mesh.h"
+#include "Transform.h"
+#include "Visibility.h"
+#include "AssetManager.h"
+
+namespace Core
+{
+	// the renderer's object buffer kept in step with every entity that has a WorldTransform, Mesh and Visibility,
+	// the gpu-driven path culls and draws from it without the cpu visiting objects, every entity drawn gets a slot
+	// of its own that's freed again when it loses its mesh or is destroyed, so the slots stay as dense as the entities
+	// only entities whose WorldTransform or Visibility changed are rewritten, structural changes and asset loads or
+	// evictions rewrite everything, like the TransformSystem rebuilds
+	// note: finding the changed entities still scans both pools' change ticks every frame, see EachChangedSince
+	// meshes are only counted as used by Cull, for the objects inside the frustum
+	class GPUScene
+	{
+	public:
+		// call after the TransformSystem update and any eviction, materialIndexOf returns the entity's slot
+		// in the materials buffer or ~0u for the default material
+		void Update(ECS& ecs, AssetManager& assetManager, const std::function<u32(Entity)>& materialIndexOf);
+
+		// culls and draws the objects from this camera in the next frame and marks the meshes in view as used,
+		// pixelsPerUnitAtOne is how many pixels one world unit covers at distance 1
+		void Cull(AssetManager& assetManager, const glm::mat4& viewProjection, const glm::vec3& cameraPosition, f32 pixelsPerUnitAtOne);
+
+		// entities that had a mesh at the last full rewrite
+		[[nodiscard]] u32 GetObjectCount() const noexcept { return m_ObjectCount; }
+	private:
+		static constexpr u32 InvalidSlot = std::numeric_limits<u32>::max();
+
+		void Rewrite(ECS& ecs, AssetManager& assetManager, const std::function<u32(Entity)>& materialIndexOf);
+		void Write(u32 slot, const WorldTransform& worldTransform, AssetHandle<Mesh> handle, const Mesh& mesh, bool visible, u32 materialIndex);
+
+		[[nodiscard]] u32 GetSlot(Entity entity) const noexcept;
+		u32 AllocateSlot(Entity entity);
+	private:
+		u32 m_StructureVersion = std::numeric_limits<u32>::max();
+		u32 m_AssetVersion = std::numeric_limits<u32>::max();
+		u32 m_LastTick = 0;
+
+		// every slot up to m_SlotEntities.size() is culled, free ones hold an inactive object and a null entity
+		std::vector<Entity> m_SlotEntities;
+		std::vector<u32> m_FreeSlots;
+		// by entity index, checked against m_SlotEntities since indices are reused
+		std::vector<u32> m_EntitySlots;
+		u32 m_ObjectCount = 0;
+
+		// by slot, the mesh of every visible object and its world space bounding sphere, for Cull
+		std::vector<AssetHandle<Mesh>> m_SlotMeshes;
+		std::vector<glm::vec4> m_SlotSpheres;
+	};
+}
\ No newline at end of file
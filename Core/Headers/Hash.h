@@ -0,0 +1,35 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+
+#include "Types.h"
+
+namespace Core
+{
+	constexpr u64 FNVOffsetBasis = 14695981039346656037ull;
+	constexpr u64 FNVPrime = 1099511628211ull;
+
+	// 64-bit FNV-1a, stable across runs and platforms so it can be stored in files
+	constexpr u64 HashBytes(std::span<const u8> bytes, u64 hash = FNVOffsetBasis) noexcept
+	{
+		for (u8 byte : bytes)
+		{
+			hash ^= byte;
+			hash *= FNVPrime;
+		}
+
+		return hash;
+	}
+
+	constexpr u64 HashString(std::string_view string, u64 hash = FNVOffsetBasis) noexcept
+	{
+		for (char c : string)
+		{
+			hash ^= static_cast<u8>(c);
+			hash *= FNVPrime;
+		}
+
+		return hash;
+	}
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <concepts>
 
 #include "Types.h"
+#include "TypeID.h"
 #include "Event.h"
 #include "Log.h"
 
@@ -23,14 +24,23 @@ namespace Core
 		template<std::derived_from<Layer> T, typename ...Args>
 		void TransitionTo(Args&&... args);
 
+		// dense id of the concrete layer class, lets Application::GetLayer avoid dynamic_cast
+		[[nodiscard]] TypeID GetTypeID() const noexcept { return m_TypeID; }
+
 	private:
 		void QueueTransition(std::unique_ptr<Layer> toLayer);
+
+		friend class Application;
+		TypeID m_TypeID = INVALID_TYPE_ID;
 	};
 
 	template<std::derived_from<Layer> T, typename ...Args>
 	void Layer::TransitionTo(Args&&... args)
 	{
-		QueueTransition(std::move(std::make_unique<T>(std::forward<Args>(args)...)));
+		auto layer = std::make_unique<T>(std::forward<Args>(args)...);
+		layer->m_TypeID = TypeRegistry<Layer>::Get<T>();
+
+		QueueTransition(std::move(layer));
 	}
 
 	class TransitionLayerEvent : public Event
@@ -44,7 +54,7 @@ namespace Core
 
 		std::string ToString() const override
 		{
-			return std::format("TransitionLayerEvent to {}", m_ToLayer ? typeid(*m_ToLayer).name() : "nullptr");
+			return m_ToLayer ? std::format("TransitionLayerEvent to layer type {}", m_ToLayer->GetTypeID()) : "TransitionLayerEvent to nullptr";
 		}
 
 		EVENT_CLASS_TYPE(TransitionLayer)
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "Types.h"
+
+namespace Core
+{
+	// read-only mapping of a whole file, MapViewOfFile on windows and mmap everywhere else
+	// pages are read in by the os on first touch, so nothing is copied until the data is used
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::filesystem::path& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		// false if the file doesn't exist, is empty or couldn't be mapped
+		[[nodiscard]] bool IsOpen() const noexcept { return m_Data != nullptr; }
+
+		[[nodiscard]] std::span<const u8> GetData() const noexcept { return { m_Data, m_Size }; }
+		[[nodiscard]] usize GetSize() const noexcept { return m_Size; }
+	private:
+		void Close() noexcept;
+	private:
+		const u8* m_Data = nullptr;
+		usize m_Size = 0;
+#ifdef _WIN32
+		void* m_File = nullptr;
+		void* m_Mapping = nullptr;
+#endif
+	};
+}
\ No newline at end of file
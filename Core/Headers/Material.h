@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 #include <string>
 
 #include <glm/glm.hpp>
@@ -16,6 +17,10 @@ namespace Core
 	public:
 		void LoadFromFile(const std::filesystem::path& path);
 
+		// materials have no gpu data of their own, Editor::UpdateMaterialsBuffer packs them
+		bool Decode(const std::filesystem::path& path);
+		void Upload() {}
+
 		glm::vec3 Ambient;
 		glm::vec3 Diffuse;
 		glm::vec3 Specular;
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory_resource>
+#include <atomic>
+
+#include "Types.h"
+
+namespace Core
+{
+	struct AllocationStats
+	{
+		u64 Allocations = 0;
+		u64 Deallocations = 0;
+		u64 BytesInUse = 0;
+		u64 PeakBytesInUse = 0;
+	};
+
+	// forwards every request to the upstream resource and counts them, the counters are atomic
+	// but thread safety of the allocations themselves is up to the upstream resource
+	class CountingResource : public std::pmr::memory_resource
+	{
+	public:
+		explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) : m_Upstream(upstream) {}
+
+		CountingResource(const CountingResource&) = delete;
+		CountingResource& operator=(const CountingResource&) = delete;
+
+		[[nodiscard]] AllocationStats GetStats() const noexcept;
+		[[nodiscard]] std::pmr::memory_resource* GetUpstream() const noexcept { return m_Upstream; }
+	private:
+		void* do_allocate(usize bytes, usize alignment) override;
+		void do_deallocate(void* ptr, usize bytes, usize alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+	private:
+		std::pmr::memory_resource* m_Upstream = nullptr;
+
+		std::atomic<u64> m_Allocations = 0;
+		std::atomic<u64> m_Deallocations = 0;
+		std::atomic<u64> m_BytesInUse = 0;
+		std::atomic<u64> m_PeakBytesInUse = 0;
+	};
+}
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <array>
+#include <limits>
+#include <span>
 
 #include <glm/glm.hpp>
 #include <vulkan/vulkan_core.h>
@@ -11,36 +13,84 @@
 #include "VkTypes.h"
 #include "Log.h"
 #include "Component.h"
-#include "OBJ-Loader.h"
+#include "MeshCache.h"
+#include "Vertex.h"
 #include "Application.h"
 
 namespace Core
 {
-	using Vertex = objl::Vertex;
-
 	class Mesh : public Asset
 	{
 	public:
 		Mesh() = default;
-		Mesh(const MeshBuffers& meshBuffers);
+		// a mesh built in code, uploaded right away
+		Mesh(std::vector<Vertex> vertices, std::vector<u32> indices);
 		~Mesh();
 
 		void LoadFromFile(const std::filesystem::path& path);
 
-		void Destroy(VmaAllocator allocator);
+		// fills the cpu side vertex and index arrays, safe to call from a worker thread
+		// the cooked copy in the MeshCache is used when the source didn't change, otherwise the file is parsed and cooked
+		bool Decode(const std::filesystem::path& path);
+		// creates the gpu buffers from the decoded data in the default vertex format, main thread only
+		// indices are uploaded as 16-bit when the mesh has fewer than 65536 vertices
+		void Upload();
+
+		// the format meshes uploaded from now on use, the cpu side always keeps the full vertices
+		static void SetDefaultVertexFormat(VertexFormat format) { s_DefaultVertexFormat = format; }
+
+		// frees the geometry range and the cpu side data
+		void Destroy();
+
+		virtual void Release() override;
+
+		[[nodiscard]] virtual usize GetCPUMemoryUsage() const noexcept override;
+		[[nodiscard]] virtual usize GetGPUMemoryUsage() const noexcept override;
 
-		void Draw(VkCommandBuffer commandBuffer) const;
+		void Draw(VkCommandBuffer commandBuffer, u32 lod = 0) const;
+
+		// the coarsest level whose error stays under MaxLODPixelError at pixelsPerUnit, pixelsPerUnit being how many
+		// pixels one mesh unit covers on screen, currentLOD is kept until the next level is clearly good enough or bad
+		[[nodiscard]] u32 SelectLOD(f32 pixelsPerUnit, u32 currentLOD) const noexcept;
+
+		// appends a draw for every run of level 0 meshlets that is inside the frustum of clipFromMesh and, with
+		// coneCulling, not facing away from cameraPosition (given in mesh space), returns how many meshlets passed
+		u32 CullMeshlets(const glm::mat4& clipFromMesh, const glm::vec3& cameraPosition, bool coneCulling,
+			std::vector<VkDrawIndexedIndirectCommand>& commands) const;
+		void DrawIndirect(VkCommandBuffer commandBuffer, std::span<const VkDrawIndexedIndirectCommand> commands) const;
 
 		[[nodiscard]] const std::vector<Vertex>& GetVertices() const noexcept { return m_Vertices; }
-		[[nodiscard]] const std::vector<u32>& GetIndices() const noexcept { return m_Indices; }
-		[[nodiscard]] const Buffer& GetVertexBuffer() const noexcept { return m_VertexBuffer; }
-		[[nodiscard]] const Buffer& GetIndexBuffer() const noexcept { return m_IndexBuffer; }
+		// level 0 only, the coarser levels follow it in the same index buffer
+		[[nodiscard]] std::span<const u32> GetIndices() const noexcept { return std::span<const u32>(m_Indices).first(m_LODs.empty() ? 0 : m_LODs[0].IndexCount); }
+		[[nodiscard]] const std::vector<MeshLOD>& GetLODs() const noexcept { return m_LODs; }
+		// empty for meshes that weren't imported from a file
+		[[nodiscard]] const std::vector<Meshlet>& GetMeshlets() const noexcept { return m_Meshlets; }
+		[[nodiscard]] const MeshBounds& GetBounds() const noexcept { return m_Bounds; }
+		// where the mesh lives in the renderer's shared geometry buffers
+		[[nodiscard]] const GeometryRange& GetGeometry() const noexcept { return m_Geometry; }
+		[[nodiscard]] VertexFormat GetVertexFormat() const noexcept { return m_VertexFormat; }
+		[[nodiscard]] VkIndexType GetIndexType() const noexcept { return m_IndexType; }
+		// identity unless the vertex buffer is packed, the model matrix the mesh is drawn with has to be multiplied by it
+		[[nodiscard]] const glm::mat4& GetDequantizationMatrix() const noexcept { return m_DequantizationMatrix; }
+
+		static constexpr f32 MaxLODPixelError = 1.0f;
+		// a coarser level is only picked once its error is this much below the limit, so meshes near a switch distance don't flicker
+		static constexpr f32 LODHysteresis = 1.5f;
 
 	private:
-		Buffer m_VertexBuffer;
-		Buffer m_IndexBuffer;
+		static inline VertexFormat s_DefaultVertexFormat = VertexFormat::Packed;
+
+		GeometryRange m_Geometry;
 
 		std::vector<Vertex> m_Vertices;
 		std::vector<u32> m_Indices;
+		std::vector<MeshLOD> m_LODs;
+		std::vector<Meshlet> m_Meshlets;
+		MeshBounds m_Bounds;
+
+		VertexFormat m_VertexFormat = VertexFormat::Full;
+		VkIndexType m_IndexType = VK_INDEX_TYPE_UINT32;
+		glm::mat4 m_DequantizationMatrix = glm::mat4(1.0f);
+		usize m_GPUBytes = 0;
 	};
 }
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include <span>
+
+#include <glm/glm.hpp>
+
+#include "Types.h"
+#include "Vertex.h"
+
+namespace Core
+{
+	struct MeshBounds
+	{
+		glm::vec3 Min = glm::vec3(0.0f);
+		glm::vec3 Max = glm::vec3(0.0f);
+	};
+
+	// a range of the index buffer, Error is how far the level's surface strays from level 0 in mesh units
+	struct MeshLOD
+	{
+		u32 FirstIndex = 0;
+		u32 IndexCount = 0;
+		f32 Error = 0.0f;
+	};
+
+	// a cluster of level 0 that is culled as a whole, its triangles are the index range [FirstIndex, FirstIndex + IndexCount)
+	// the cone bounds the triangle normals, the meshlet faces away from any camera with
+	// dot(normalize(ConeApex - camera), ConeAxis) > ConeCutoff, a cutoff of 1 means the normals are too spread to ever cull
+	struct Meshlet
+	{
+		u32 FirstIndex = 0;
+		u32 IndexCount = 0;
+		glm::vec3 Center = glm::vec3(0.0f);
+		f32 Radius = 0.0f;
+		glm::vec3 ConeApex = glm::vec3(0.0f);
+		f32 ConeCutoff = 1.0f;
+		glm::vec3 ConeAxis = glm::vec3(0.0f);
+		u32 VertexCount = 0;
+	};
+
+	// .vkmesh layout: MeshCacheHeader, then the vertex, index, lod and meshlet arrays as they are in memory,
+	// each starting on a BlobAlignment boundary so they can be copied straight out of the mapping
+	struct MeshCacheHeader
+	{
+		u32 Magic = 0;
+		u32 ImporterVersion = 0;
+		u64 SourceHash = 0;
+		u32 VertexCount = 0;
+		u32 VertexStride = 0;
+		u32 IndexCount = 0;
+		u32 IndexStride = 0;
+		u64 VertexOffset = 0;
+		u64 IndexOffset = 0;
+		u32 LODCount = 0;
+		u32 Padding0 = 0; // spelled out so the header has no uninitialized bytes when it's written
+		u64 LODOffset = 0;
+		u32 MeshletCount = 0;
+		u32 Padding1 = 0;
+		u64 MeshletOffset = 0;
+		MeshBounds Bounds;
+	};
+
+	// cooked meshes keyed by the HashBytes of the source file contents, a file is used only if its importer version
+	// and vertex layout match, anything else is treated as a miss and imported again
+	// note: Load and Store are safe to call from worker threads, SetDirectory isn't
+	class MeshCache
+	{
+	public:
+		static constexpr u32 Magic = 0x48534D56; // "VMSH"
+		// bump when the importer changes what it produces for the same source
+		static constexpr u32 ImporterVersion = 6;
+		static constexpr usize BlobAlignment = 64;
+
+		// defaults to <temp>/VkGameEngine/MeshCache
+		static void SetDirectory(const std::filesystem::path& directory);
+		[[nodiscard]] static const std::filesystem::path& GetDirectory();
+
+		static bool Load(u64 sourceHash, std::vector<Vertex>& vertices, std::vector<u32>& indices, std::vector<MeshLOD>& lods,
+			std::vector<Meshlet>& meshlets, MeshBounds& bounds);
+		static bool Store(u64 sourceHash, std::span<const Vertex> vertices, std::span<const u32> indices, std::span<const MeshLOD> lods,
+			std::span<const Meshlet> meshlets, const MeshBounds& bounds);
+
+		[[nodiscard]] static MeshBounds ComputeBounds(std::span<const Vertex> vertices) noexcept;
+	private:
+		[[nodiscard]] static std::filesystem::path GetCachePath(u64 sourceHash);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <span>
+
+#include <glm/glm.hpp>
+
+#include "Types.h"
+#include "Vertex.h"
+#include "MeshCache.h"
+
+namespace Core
+{
+	struct WeldStats
+	{
+		usize VerticesBefore = 0;
+		usize VerticesAfter = 0;
+
+		[[nodiscard]] usize GetSavedBytes() const noexcept { return (VerticesBefore - VerticesAfter) * sizeof(Vertex); }
+	};
+
+	// merges duplicate vertices and remaps the indices to the unique ones, kept in first use order
+	// with epsilon 0 vertices have to be bitwise equal, otherwise every attribute is snapped to an epsilon grid
+	// and vertices landing in the same cell are merged (the first one's values are kept)
+	WeldStats WeldVertices(std::vector<Vertex>& vertices, std::vector<u32>& indices, f32 epsilon = 0.0f);
+
+	// ACMR: vertex shader invocations per triangle (0.5 is the best a regular grid gets, 3 is no reuse)
+	// ATVR: invocations per vertex (1 is the best possible)
+	struct VertexCacheStats
+	{
+		f32 ACMR = 0.0f;
+		f32 ATVR = 0.0f;
+	};
+
+	// simulates a FIFO post-transform cache of cacheSize entries over the triangle list
+	[[nodiscard]] VertexCacheStats AnalyzeVertexCache(const std::vector<u32>& indices, usize vertexCount, u32 cacheSize = 16);
+
+	// reorders the triangles for post-transform cache reuse, Forsyth's linear-speed algorithm
+	void OptimizeVertexCache(std::vector<u32>& indices, usize vertexCount);
+
+	// splits a cache-optimized triangle list into clusters and sorts them so the outward facing ones are drawn first,
+	// which lets early depth reject more of the rest, clusters end wherever splitting keeps the ACMR so far within
+	// threshold of the input's, so threshold trades cache reuse for overdraw and the result never exceeds it
+	void OptimizeOverdraw(std::vector<u32>& indices, const std::vector<Vertex>& vertices, f32 threshold = 1.05f);
+
+	// reorders the vertices in the order the indices first reference them so vertex fetch walks memory linearly,
+	// vertices no triangle uses are dropped
+	void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<u32>& indices);
+
+	constexpr u32 MaxMeshletVertices = 64;
+	constexpr u32 MaxMeshletTriangles = 124;
+
+	// groups the triangles into meshlets of at most maxVertices unique vertices and maxTriangles triangles, growing each
+	// one through shared edges first so it stays compact, and reorders indices so every meshlet is a contiguous range
+	[[nodiscard]] std::vector<Meshlet> BuildMeshlets(const std::vector<Vertex>& vertices, std::span<u32> indices,
+		u32 maxVertices = MaxMeshletVertices, u32 maxTriangles = MaxMeshletTriangles);
+
+	// collapses edges in order of quadric error until at most targetIndexCount indices are left or the next collapse would
+	// move the surface further than targetError, which is relative to the mesh's largest extent
+	// vertices are only ever merged onto existing ones, so the result indexes the same vertex array
+	// resultError is the largest error reached, in mesh units
+	[[nodiscard]] std::vector<u32> SimplifyMesh(const std::vector<Vertex>& vertices, const std::vector<u32>& indices,
+		usize targetIndexCount, f32 targetError, f32& resultError);
+
+	constexpr u32 MaxMeshLODs = 5;
+	// levels have to simplify down to at least this fraction of the previous one
+	constexpr f32 LODMinReduction = 0.8f;
+	constexpr f32 LODMaxRelativeError = 0.05f;
+
+	// appends up to MaxMeshLODs - 1 simplified levels, each about half the previous one, after the indices
+	// and returns where every level starts, level 0 is the input
+	[[nodiscard]] std::vector<MeshLOD> BuildLODChain(const std::vector<Vertex>& vertices, std::vector<u32>& indices);
+
+	// converts to VertexFormat::Packed, positions are quantized over bounds
+	[[nodiscard]] std::vector<PackedVertex> PackVertices(const std::vector<Vertex>& vertices, const MeshBounds& bounds);
+
+	// maps the packed [0, 1] positions back into the mesh's space, a packed mesh is drawn with model * this
+	[[nodiscard]] glm::mat4 GetDequantizationMatrix(const MeshBounds& bounds);
+}
\ No newline at end of file
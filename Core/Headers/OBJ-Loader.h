@@ -448,6 +448,15 @@ namespace objl
 			if (!file.is_open())
 				return false;
 
+			return LoadFile(file, Path);
+		}
+
+		// Load from an already opened stream
+		//
+		// Path is only used to find the material
+		// library next to the file
+		bool LoadFile(std::istream& file, std::string Path)
+		{
 			LoadedMeshes.clear();
 			LoadedVertices.clear();
 			LoadedIndices.clear();
@@ -691,8 +700,6 @@ namespace objl
 				LoadedMeshes.push_back(tempMesh);
 			}
 
-			file.close();
-
 			// Set Materials for each Mesh
 			for (int i = 0; i < MeshMatNames.size(); i++)
 			{
@@ -841,6 +848,7 @@ namespace objl
 			}
 		}
 
+	public:
 		// Triangulate a list of vertices into a face by printing
 		//	inducies corresponding with triangles within it
 		void VertexTriangluation(std::vector<unsigned int>& oIndices,
@@ -1010,6 +1018,7 @@ namespace objl
 			}
 		}
 
+	private:
 		// Load Materials from .mtl file
 		bool LoadMaterials(std::string path)
 		{
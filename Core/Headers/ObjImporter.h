@@ -0,0 +1,16 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Types.h"
+#include "Vertex.h"
+
+namespace Core
+{
+	// parses .obj text into the same vertex and index arrays objl::Loader produces (LoadedVertices/LoadedIndices)
+	// the text is cut into chunks on line boundaries, each chunk is tokenized on the ThreadPool with std::from_chars
+	// without allocating per token, faces are built once every chunk's positions, uvs and normals are merged
+	// note: only geometry is read, groups, objects and material libraries are skipped
+	bool ImportObj(std::span<const char> text, std::vector<Vertex>& vertices, std::vector<u32>& indices);
+}
\ No newline at end of file
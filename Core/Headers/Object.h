@@ -2,6 +2,7 @@
 
 #include "ECS.h"
 #include "Transform.h"
+#include "Visibility.h"
 
 namespace Core
 {
@@ -9,16 +10,19 @@ namespace Core
 	{
 	public:
 		Object(ECS& ecs, const std::string& name);
-		virtual ~Object() = default;
+		virtual ~Object();
 
 		virtual void OnUpdate(float deltaTime) {};
 
-		template<std::derived_from<Component> T, typename... Args>
+		template<std::derived_from<Component> T, typename... Args> requires (!std::derived_from<T, Asset>)
 		T* AddComponent(Args&&... args);
 
 		template<std::derived_from<Asset> T>
 		void AddComponent(const UUID& assetId);
 
+		template<std::derived_from<Asset> T>
+		void AddComponent(AssetHandle<T> handle);
+
 		template<std::derived_from<Component> T>
 		bool HasComponent();
 
@@ -28,46 +32,58 @@ namespace Core
 		template<std::derived_from<Component> T>
 		[[nodiscard]] T* GetComponent();
 
+		template<std::derived_from<Component> T>
+		void MarkChanged() { m_ECS.MarkChanged<T>(m_Entity); }
+
+		template<std::derived_from<Component> T, typename Func>
+		bool Patch(Func&& func) { return m_ECS.Patch<T>(m_Entity, std::forward<Func>(func)); }
+
 		std::vector<Core::Asset*> GetAllAssets();
 
-		void SetVisible(bool isVisible) { m_IsVisible = isVisible; }
-		[[nodiscard]] bool IsVisible() const { return m_IsVisible; }
+		void SetVisible(bool isVisible) { Patch<Visibility>([&](Visibility& visibility) { visibility.IsVisible = isVisible; }); }
+		[[nodiscard]] bool IsVisible() { return GetComponent<const Visibility>()->IsVisible; }
 
 		[[nodiscard]] const std::string& GetName() const { return m_Name; }
+		[[nodiscard]] Entity GetEntity() const noexcept { return m_Entity; }
 	private:
-		UUID m_ID;
+		Entity m_Entity;
 		ECS& m_ECS;
 		std::string m_Name;
-		bool m_IsVisible = true;
 	};
 
-	template<std::derived_from<Component> T, typename... Args>
+	template<std::derived_from<Component> T, typename... Args> requires (!std::derived_from<T, Asset>)
 	T* Object::AddComponent(Args&&... args)
 	{
-		return m_ECS.AddComponent<T>(m_ID, std::forward<Args>(args)...);
+		return m_ECS.AddComponent<T>(m_Entity, std::forward<Args>(args)...);
 	}
 
 	template<std::derived_from<Asset> T>
 	void Object::AddComponent(const UUID& assetId)
 	{
-		m_ECS.AddComponent<T>(m_ID, assetId);
+		m_ECS.AddComponent<T>(m_Entity, assetId);
+	}
+
+	template<std::derived_from<Asset> T>
+	void Object::AddComponent(AssetHandle<T> handle)
+	{
+		m_ECS.AddComponent<T>(m_Entity, handle);
 	}
 
 	template<std::derived_from<Component> T>
 	bool Object::HasComponent()
 	{
-		return m_ECS.HasComponent<T>(m_ID);
+		return m_ECS.HasComponent<T>(m_Entity);
 	}
 
 	template<std::derived_from<Component>... Ts>
 	bool Object::HasComponents()
 	{
-		return m_ECS.HasComponents<Ts...>(m_ID);
+		return m_ECS.HasComponents<Ts...>(m_Entity);
 	}
 
 	template<std::derived_from<Component> T>
 	T* Object::GetComponent()
 	{
-		return m_ECS.GetComponent<T>(m_ID);
+		return m_ECS.GetComponent<T>(m_Entity);
 	}
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <cstddef>
 #include <memory>
 #include <ranges>
+#include <span>
+#include <bit>
 
 #include <vulkan/vulkan.h>
 #include <GLFW/glfw3.h>
@@ -18,12 +20,25 @@
 #include "Log.h"
 #include "Types.h"
 #include "VkTypes.h"
+#include "Vertex.h"
 #include "Transform.h"
 #include "Object.h"
 #include "Camera.h"
+#include "BufferArena.h"
+#include "UploadContext.h"
 
 
 constexpr usize MAX_FRAMES_IN_FLIGHT = 2;
+// draw commands DrawIndexedIndirect can take per frame, past that it falls back to direct draws
+constexpr usize MAX_INDIRECT_DRAWS = 65536;
+// starting sizes of the shared geometry buffers, they double whenever an allocation doesn't fit
+constexpr u64 VERTEX_ARENA_SIZE = 32ull << 20;
+constexpr u64 INDEX_ARENA_SIZE = 16ull << 20;
+constexpr u64 UPLOAD_STAGING_SIZE = 64ull << 20;
+// starting slots of the gpu-driven object buffers, they double whenever GPUScene uses more
+constexpr u32 GPU_OBJECT_CAPACITY = 65536;
+// object records copied into the object buffer per frame, the rest wait for the next frame
+constexpr u32 MAX_GPU_OBJECT_UPDATES = 16384;
 
 namespace Core
 {
@@ -58,10 +73,55 @@ namespace Core
 		void SetBackgroundColor(const VkClearColorValue& color) { m_ClearColor = color; };
 		void SetWireframeMode(const bool enabled) { m_WireframeMode = enabled; }
 
-		MeshBuffers CreateMeshBuffers(const std::vector<objl::Vertex>& vertices, const std::vector<u32>& indices);
+		MeshBuffers CreateMeshBuffers(const std::vector<Vertex>& vertices, const std::vector<u32>& indices);
+		// uploads already encoded vertex and index data, the returned Vertices and Indices are left empty
+		MeshBuffers CreateMeshBuffers(std::span<const u8> vertexData, std::span<const u8> indexData);
+
+		// sub-allocates and uploads a mesh's encoded vertices and indices into the shared geometry buffers,
+		// vertexStride and indexType describe the data so the range can be addressed in elements
+		GeometryRange AllocateGeometry(std::span<const u8> vertexData, u32 vertexStride, std::span<const u8> indexData, VkIndexType indexType);
+		// the range goes back to the arena once the frames that may still draw from it are done
+		void FreeGeometry(GeometryRange& range);
+
+		// queued on the upload context, the next frame submitted waits for them on the gpu
+		// buffers and images written this way need VK_*_USAGE_TRANSFER_DST_BIT
+		void UploadBuffer(VkBuffer buffer, VkDeviceSize offset, std::span<const u8> data) { m_UploadContext.UploadBuffer(buffer, offset, data); }
+		void UploadImage(const Image& image, std::span<const u8> data) { m_UploadContext.UploadImage(image.Image, image.Extent.width, image.Extent.height, data); }
+
+		// the geometry buffers are bound once in BeginRenderToTexture, this only rebinds the index buffer when
+		// indexType changes, vertex or index buffers bound without going through here have to come after every mesh draw
+		void BindGeometryBuffers(VkIndexType indexType);
+
+		// binds the graphics (or wireframe) pipeline reading format, skipped when the last bind made through here
+		// since BeginRenderToTexture was for the same format
+		void BindGraphicsShader(VertexFormat format);
+
+		// copies the commands into this frame's indirect buffer and draws them with one vkCmdDrawIndexedIndirect,
+		// the vertex and index buffers have to be bound already
+		void DrawIndexedIndirect(std::span<const VkDrawIndexedIndirectCommand> commands);
+
+		// queues an object record for the gpu-driven path, records are copied on the graphics queue before the culling pass
+		void UpdateGPUObject(u32 index, const GPUObject& object);
+		// records the culling pass for objects [0, objectCount) at the start of the next BeginRenderToTexture,
+		// ObjectCount and MaxDrawsPerBucket of constants are filled in here, the object buffers grow to fit then
+		void CullGPUObjects(const GPUCullConstants& constants, u32 objectCount);
+		// draws everything the culling pass of this frame let through with one vkCmdDrawIndexedIndirectCount
+		// per bucket, does nothing if CullGPUObjects wasn't called for the frame
+		void DrawGPUObjects();
+		// counts written by the culling pass of the last frame that finished on the gpu
+		[[nodiscard]] const GPUCullStats& GetGPUCullStats() const { return m_GPUCullStats; }
+		[[nodiscard]] static u32 GetDrawBucket(VertexFormat format, VkIndexType indexType)
+		{ return static_cast<u32>(format) * 2 + (indexType == VK_INDEX_TYPE_UINT16 ? 1 : 0); }
+
+		// points binding 1 of every object pipeline at the current materials buffer, call after replacing it
+		void UpdateMaterialsDescriptors();
+
+		static void GetVertexInputDescription(VertexFormat format, VkVertexInputBindingDescription& binding,
+			std::vector<VkVertexInputAttributeDescription>& attributes);
 
 		[[nodiscard]] VkCommandBuffer GetCurrentCommandBuffer() const { return m_CurrentCommandBuffer; }
-		[[nodiscard]] VkPipelineLayout GetGraphicsPipelineLayout() const { return m_GraphicsShader.PipelineLayout; }
+		// every format's pipeline layout is created from the same bindings and push constants, so they're compatible
+		[[nodiscard]] VkPipelineLayout GetGraphicsPipelineLayout() const { return m_GraphicsShaders[0].PipelineLayout; }
 
 		[[nodiscard]] vkb::Device GetDevice() const noexcept { return m_CoreData.Device; }
 		[[nodiscard]] VkInstance GetVulkanInstance() const { return m_CoreData.Instance; }
@@ -79,8 +139,10 @@ namespace Core
 		[[nodiscard]] Buffer& GetMaterialsBuffer() { return m_MaterialsBuffer; }
 		[[nodiscard]] VkSampleCountFlagBits GetMSAASamples() const { return m_MSAASamples; }
 		[[nodiscard]] VkPhysicalDeviceLimits GetPhysicalDeviceLimits() const { return m_PhysDeviceLimits; }
+		// DrawGPUObjects needs it, DrawIndexedIndirect falls back to direct draws without it
+		[[nodiscard]] bool SupportsMultiDrawIndirect() const { return m_MultiDrawIndirect; }
 
-		[[nodiscard]] Shader& GetGraphicsShader() { return m_GraphicsShader; }
+		[[nodiscard]] Shader& GetGraphicsShader(VertexFormat format = VertexFormat::Full) { return m_GraphicsShaders[static_cast<usize>(format)]; }
 
 		[[nodiscard]] const f32 GetGPUTime(const TimestampType& type) const
 		{ return static_cast<f32>(m_Timestamps.at(type).End - m_Timestamps.at(type).Start) * m_PhysDeviceLimits.timestampPeriod / 1000000.0f; }
@@ -104,6 +166,9 @@ namespace Core
 			const std::filesystem::path& frag,
 			const std::filesystem::path& geom = "");
 
+		Shader CreateComputeShader(const std::vector<DescriptorBinding>& bindings, const std::vector<VkPushConstantRange>& pushConstantRanges,
+			const std::filesystem::path& comp);
+
 		void UpdateDescriptorSets(const Shader& shader);
 
 		Buffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage);
@@ -119,10 +184,26 @@ namespace Core
 		void InitCoreData();
 		void SetPhysDevicePropertiesAndLimits();
 		void CreateBuffers();
+		void CreateUploadContext();
+		// destroys what FreeGeometry, arena and gpu object growth left behind once no frame in flight can use it
+		void ReleaseRetiredResources();
+		Buffer CreateDeviceLocalBuffer(std::span<const u8> data, VkBufferUsageFlags usage);
+		// grows buffer and arena until size fits, existing ranges keep their offsets
+		u64 AllocateFromArena(BufferArena& arena, Buffer& buffer, VkBufferUsageFlags usage, u64 size, u64 alignment);
 		void CreateSwapchain();
 		void GetQueues();
 		void CreateDepthResources();
 		void CreateGP();
+		void CreateCullPipeline();
+		// descriptor layout, pool and set plus the pipeline layout, shared by graphics and compute shaders
+		void CreateShaderLayout(Shader& shader, const std::vector<DescriptorBinding>& bindings,
+			const std::vector<VkPushConstantRange>& pushConstantRanges, VkShaderStageFlags stages);
+		void CreateDescriptorSet(Shader& shader);
+		// points the shader at its current Bindings through a new set, for bindings that change while frames are in flight
+		void ReplaceDescriptorSet(Shader& shader);
+		void RecordGPUCulling();
+		// carries the objects over into larger buffers, the old buffers and descriptor sets are retired, not waited on
+		void GrowGPUObjectBuffers(u32 objectCount);
 		void CreateBlitPipeline();
 		void CreateRenderTextures();
 		void CreateCommandPool();
@@ -150,8 +231,12 @@ namespace Core
 		Image m_DepthImage;
 		Image m_DepthImageMSAA;
 
-		Shader m_GraphicsShader;
-		Shader m_WireframeShader;
+		std::array<Shader, VertexFormatCount> m_GraphicsShaders;
+		std::array<Shader, VertexFormatCount> m_WireframeShaders;
+		std::array<Shader, VertexFormatCount> m_IndirectShaders;
+		std::array<Shader, VertexFormatCount> m_IndirectWireframeShaders;
+		Shader m_CullShader;
+		VertexFormat m_BoundVertexFormat = VertexFormat::Full;
 		Shader m_BlitShader;
 
 		Image m_RenderTexture;
@@ -161,6 +246,49 @@ namespace Core
 		Buffer m_VPBuffer;
 		Buffer m_MaterialsBuffer;
 
+		// every mesh's geometry, device local and sub-allocated through the arenas so draws share one binding
+		Buffer m_VertexArenaBuffer;
+		Buffer m_IndexArenaBuffer;
+		BufferArena m_VertexArena;
+		BufferArena m_IndexArena;
+		VkIndexType m_BoundIndexType = VK_INDEX_TYPE_UINT32;
+
+		UploadContext m_UploadContext;
+		u64 m_FrameCount = 0;
+		// tagged with m_FrameCount when they were retired
+		std::vector<std::pair<u64, GeometryRange>> m_RetiredGeometry;
+		std::vector<std::pair<u64, Buffer>> m_RetiredBuffers;
+		std::vector<std::pair<u64, VkDescriptorPool>> m_RetiredDescriptorPools;
+
+		// host visible and mapped for the renderer's lifetime, one per frame in flight so the cpu never writes what the gpu reads
+		std::array<Buffer, MAX_FRAMES_IN_FLIGHT> m_IndirectBuffers;
+		std::array<VkDrawIndexedIndirectCommand*, MAX_FRAMES_IN_FLIGHT> m_IndirectCommands = {};
+		usize m_IndirectCount = 0;
+		bool m_MultiDrawIndirect = false;
+
+		// gpu-driven path, the object, lod state, draw and count buffers are only touched by the graphics queue
+		Buffer m_GPUObjectBuffer;
+		Buffer m_GPULODStateBuffer;
+		Buffer m_GPUDrawBuffer; // GPUDrawBucketCount runs of m_GPUObjectCapacity commands
+		Buffer m_GPUDrawCountBuffer; // a count per bucket, then the GPUCullStats
+		u32 m_GPUObjectCapacity = GPU_OBJECT_CAPACITY;
+		bool m_GPUObjectsCleared = false;
+		std::array<Buffer, MAX_FRAMES_IN_FLIGHT> m_GPUObjectStagingBuffers;
+		std::array<GPUObject*, MAX_FRAMES_IN_FLIGHT> m_GPUObjectStaging = {};
+		std::array<Buffer, MAX_FRAMES_IN_FLIGHT> m_GPUCullReadbackBuffers;
+		std::array<const u32*, MAX_FRAMES_IN_FLIGHT> m_GPUCullReadback = {};
+		std::array<bool, MAX_FRAMES_IN_FLIGHT> m_GPUCullReadbackPending = {};
+
+		// latest record of every object, m_PendingGPUObjects lists the ones not copied yet
+		std::vector<GPUObject> m_GPUObjects;
+		std::vector<u8> m_GPUObjectPending;
+		std::vector<u32> m_PendingGPUObjects;
+
+		GPUCullConstants m_CullConstants;
+		bool m_CullRequested = false;
+		bool m_CullRecorded = false;
+		GPUCullStats m_GPUCullStats;
+
 		VmaAllocator m_Allocator;
 
 		VkClearColorValue m_ClearColor = {0.0f, 0.0f, 0.0f, 1.0f};
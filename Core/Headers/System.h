@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+#include "Types.h"
+#include "TypeID.h"
+
+namespace Core
+{
+	// a per-entity update registered through ECS::AddSystem, const component types are reads and the rest are writes
+	struct System
+	{
+		std::string Name;
+		std::vector<TypeID> Reads;
+		std::vector<TypeID> Writes;
+		usize MinBatchSize = 64;
+
+		std::function<usize()> GetCandidateCount;
+		std::function<void(f32, usize, usize)> Run;
+
+		[[nodiscard]] bool ConflictsWith(const System& other) const
+		{
+			auto writesAny = [](const std::vector<TypeID>& writes, const std::vector<TypeID>& types) {
+				return std::ranges::any_of(writes, [&](TypeID type) { return std::ranges::find(types, type) != types.end(); });
+			};
+
+			return writesAny(Writes, other.Reads) || writesAny(Writes, other.Writes) || writesAny(other.Writes, Reads);
+		}
+	};
+}
@@ -18,6 +18,17 @@ namespace Core
 
 		void LoadFromFile(const std::filesystem::path& path);
 
+		// decodes the image into cpu memory, safe to call from a worker thread
+		bool Decode(const std::filesystem::path& path);
+		// creates the image and sampler and copies the decoded pixels, main thread only
+		void Upload();
+
+		// the imgui descriptor set isn't recreated, textures shown through it have to be pinned
+		virtual void Release() override;
+
+		[[nodiscard]] virtual usize GetCPUMemoryUsage() const noexcept override;
+		[[nodiscard]] virtual usize GetGPUMemoryUsage() const noexcept override;
+
 		[[nodiscard]] VkDescriptorSet GetDescriptorSet() const noexcept { return m_DescriptorSet; }
 		[[nodiscard]] u32 GetWidth() const noexcept { return m_Width; }
 		[[nodiscard]] u32 GetHeight() const noexcept { return m_Height; }
@@ -29,12 +40,14 @@ namespace Core
 
 		void SetDescriptorSet(VkDescriptorSet descriptorSet) noexcept { m_DescriptorSet = descriptorSet; }
  	private:
-		VkDescriptorSet m_DescriptorSet;
-		u32 m_Width;
-		u32 m_Height;
-		u32 m_Channels;
+		VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+		u32 m_Width = 0;
+		u32 m_Height = 0;
+		u32 m_Channels = 4;
+
+		u8* m_Pixels = nullptr; // decoded but not uploaded yet
 
 		Image m_Image;
-		VkSampler m_Sampler;
+		VkSampler m_Sampler = VK_NULL_HANDLE;
 	};
 }
\ No newline at end of file
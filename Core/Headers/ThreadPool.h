@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <exception>
+
+#include "Types.h"
+
+namespace Core
+{
+	// counts the unfinished jobs of one batch, ThreadPool::Wait blocks on it
+	// the first exception thrown by one of its jobs is kept and rethrown by Wait once the rest finished
+	struct JobGroup
+	{
+		std::atomic<u32> Pending = 0;
+		std::exception_ptr Exception;
+	};
+
+	// background jobs (asset decoding) only run when no frame job is queued and never on every worker at once,
+	// so they can't hold up the per-frame batches
+	enum class JobPriority : u8
+	{
+		Frame,
+		Background
+	};
+
+	class ThreadPool
+	{
+	public:
+		explicit ThreadPool(u32 threadCount);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// shared pool with one worker per hardware thread besides the calling one
+		static ThreadPool& Get();
+
+		// jobs submitted from inside a job get the priority of the job that submitted them
+		void Submit(JobGroup& group, std::function<void()> job);
+		void Submit(JobGroup& group, std::function<void()> job, JobPriority priority);
+
+		// note: the waiting thread executes the group's queued jobs, so waiting from inside a job does not deadlock
+		// and waiting on a batch never runs someone else's long job on the calling thread
+		// rethrows the group's exception, if a job threw one
+		void Wait(JobGroup& group);
+
+		// splits [0, count) into ranges of at least minBatchSize and calls func(begin, end) for each of them
+		template<typename Func>
+		void ParallelFor(usize count, usize minBatchSize, Func&& func);
+
+		[[nodiscard]] u32 GetThreadCount() const noexcept { return static_cast<u32>(m_Workers.size()); }
+	private:
+		void WorkerLoop();
+
+		// group = nullptr takes any job a worker may run, otherwise only a job of that group
+		bool TryRunJob(JobGroup* group);
+	private:
+		struct Job
+		{
+			JobGroup* Group = nullptr;
+			std::function<void()> Function;
+			JobPriority Priority = JobPriority::Frame;
+		};
+
+		// both need m_Mutex
+		[[nodiscard]] bool CanRunBackgroundJob() const noexcept;
+		[[nodiscard]] bool HasJobOf(const JobGroup& group) const noexcept;
+
+		std::vector<std::thread> m_Workers;
+		std::deque<Job> m_Jobs;
+		std::deque<Job> m_BackgroundJobs;
+		u32 m_RunningBackgroundJobs = 0;
+		u32 m_MaxBackgroundJobs = 1;
+		std::mutex m_Mutex;
+		std::condition_variable m_JobAvailable;
+		std::condition_variable m_JobFinished;
+		bool m_Stopping = false;
+	};
+
+	template<typename Func>
+	void ThreadPool::ParallelFor(usize count, usize minBatchSize, Func&& func)
+	{
+		if (count == 0)
+			return;
+
+		usize maxBatches = static_cast<usize>(GetThreadCount()) + 1;
+		usize batchSize = std::max(std::max<usize>(minBatchSize, 1), (count + maxBatches - 1) / maxBatches);
+
+		if (batchSize >= count)
+		{
+			func(usize(0), count);
+			return;
+		}
+
+		JobGroup group;
+
+		for (usize begin = batchSize; begin < count; begin += batchSize)
+		{
+			usize end = std::min(begin + batchSize, count);
+			Submit(group, [&func, begin, end]() { func(begin, end); });
+		}
+
+		try
+		{
+			func(usize(0), batchSize);
+		}
+		catch (...)
+		{
+			// the submitted ranges reference func and group, they have to finish before either goes away
+			Wait(group);
+			throw;
+		}
+
+		Wait(group);
+	}
+}
@@ -5,6 +5,7 @@
 #include <glm/gtc/quaternion.hpp>
 
 #include "Component.h"
+#include "Entity.h"
 
 namespace Core
 {
@@ -16,5 +17,24 @@ namespace Core
 
 		[[nodiscard]] glm::mat4 GetModelMatrix() const;
 		[[nodiscard]] glm::quat GetRotationQuat() const;
+
+		// decomposes a translate * rotate * scale matrix back into Position/Rotation/Scale, skew is dropped
+		void SetFromMatrix(const glm::mat4& matrix);
+	};
+
+	// cached model matrix in world space, refreshed by the TransformSystem only for dirty subtrees
+	// the refreshed ones are marked changed, so ChangedSince/EachChangedSince see moves inherited from a parent
+	struct WorldTransform : public Component
+	{
+		glm::mat4 Matrix = glm::mat4(1.0f);
+		glm::mat3 NormalMatrix = glm::mat3(1.0f); // inverse transpose of Matrix, so shaders don't invert per vertex
+	};
+
+	// only present on entities that have a parent, the Transform of such an entity is relative to the parent
+	// note: change the parent through TransformSystem::SetParent so cycles are rejected
+	struct Hierarchy : public Component
+	{
+		Entity Parent = NullEntity;
+		glm::mat4 LocalMatrix = glm::mat4(1.0f);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <new>
+
+#include <glm/glm.hpp>
+
+#include "Types.h"
+#include "Transform.h"
+
+namespace Core
+{
+	template<typename T, usize Alignment>
+	struct AlignedAllocator
+	{
+		using value_type = T;
+
+		template<typename U>
+		struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+		AlignedAllocator() noexcept = default;
+
+		template<typename U>
+		AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+		[[nodiscard]] T* allocate(usize count) { return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment))); }
+		void deallocate(T* ptr, usize) noexcept { ::operator delete(ptr, std::align_val_t(Alignment)); }
+
+		template<typename U>
+		bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+	};
+
+	// Transform split into one array per scalar, with the euler rotation converted to a quaternion once when it's written,
+	// so ComposeMatrices can load 4 (SSE) or 8 (AVX2) transforms per register
+	class TransformSoA
+	{
+	public:
+		using Array = std::vector<f32, AlignedAllocator<f32, 32>>;
+
+		void Resize(usize count);
+		void Set(usize index, const Transform& transform);
+
+		[[nodiscard]] usize Size() const noexcept { return m_Count; }
+	public:
+		Array PositionX, PositionY, PositionZ;
+		Array RotationX, RotationY, RotationZ, RotationW;
+		Array ScaleX, ScaleY, ScaleZ;
+	private:
+		usize m_Count = 0;
+	};
+
+	// writes the model matrix (translate * rotate * scale) and the normal matrix (its inverse transpose)
+	// of transforms [begin, end) to models[i] and normals[i], the result matches Transform::GetModelMatrix
+	void ComposeMatrices(const TransformSoA& transforms, usize begin, usize end, glm::mat4* models, glm::mat3* normals);
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+#include "Types.h"
+#include "ECS.h"
+#include "Transform.h"
+#include "TransformBatch.h"
+
+namespace Core
+{
+	// propagates Transform -> WorldTransform through the parent/child hierarchy
+	// entities are kept in an array sorted by depth, so every level only depends on the one before it
+	// and can be processed in parallel, and only subtrees below a changed Transform are recomputed
+	// changed local transforms are copied into a TransformSoA and composed several at a time by ComposeMatrices
+	class TransformSystem
+	{
+	public:
+		void Update(ECS& ecs);
+
+		// parent = NullEntity detaches the entity, returns false if the link would create a cycle
+		// with keepWorldTransform the child's Transform is rewritten so it doesn't move in world space
+		static bool SetParent(ECS& ecs, Entity child, Entity parent, bool keepWorldTransform = false);
+		[[nodiscard]] static Entity GetParent(ECS& ecs, Entity entity);
+
+		// world matrix of the parent, identity for root entities
+		[[nodiscard]] static glm::mat4 GetParentWorldMatrix(ECS& ecs, Entity entity);
+	private:
+		void Rebuild(ECS& ecs);
+		void UpdateRange(ECS& ecs, usize begin, usize end, u32 sinceTick, bool rebuilt);
+	private:
+		static constexpr u32 NoParent = std::numeric_limits<u32>::max();
+
+		struct Node
+		{
+			Entity Handle;
+			u32 Parent = NoParent; // index into m_Nodes
+			const Transform* Local = nullptr;
+			WorldTransform* World = nullptr;
+			Hierarchy* Link = nullptr; // null for roots
+		};
+
+		// pointers into the pools stay valid until the next structural change, which triggers a rebuild
+		std::vector<Node> m_Nodes;
+		std::vector<u32> m_LevelOffsets; // nodes of depth d are [m_LevelOffsets[d], m_LevelOffsets[d + 1])
+		std::vector<u8> m_Dirty;
+		std::vector<u8> m_LocalChanged;
+
+		// indexed like m_Nodes
+		TransformSoA m_Locals;
+		std::vector<glm::mat4> m_LocalMatrices;
+		std::vector<glm::mat3> m_LocalNormals;
+
+		u32 m_StructureVersion = std::numeric_limits<u32>::max();
+		u32 m_LastTick = 0;
+	};
+}
\ No newline at end of file
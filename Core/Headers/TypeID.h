@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <limits>
+
+#include "Types.h"
+
+namespace Core
+{
+	using TypeID = u32;
+
+	constexpr TypeID INVALID_TYPE_ID = std::numeric_limits<TypeID>::max();
+
+	// hands out dense ids (0, 1, 2, ...) per family in first use order, so they can index arrays and bitsets
+	template<typename Family>
+	class TypeRegistry
+	{
+	public:
+		template<typename T>
+		[[nodiscard]] static TypeID Get() noexcept
+		{
+			static const TypeID id = s_NextID.fetch_add(1, std::memory_order_relaxed);
+			return id;
+		}
+
+		[[nodiscard]] static TypeID Count() noexcept { return s_NextID.load(std::memory_order_relaxed); }
+	private:
+		static inline std::atomic<TypeID> s_NextID = 0;
+	};
+}
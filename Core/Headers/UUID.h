@@ -1,27 +1,30 @@
 #pragma once
 
 #include <string>
-#include <sstream>
-#include <iomanip>
 #include <random>
 
 #include "Types.h"
 
 namespace Core
 {
+	// 128-bit version 4 UUID, kept in binary form and only turned into a string for display
 	class UUID
 	{
 	public:
 		UUID();
+		UUID(u64 high, u64 low) : m_High(high), m_Low(low) {}
 
-		[[nodiscard]] operator std::string() const noexcept { return m_UUID; }
+		[[nodiscard]] operator std::string() const;
 
-		bool operator==(const UUID& other) const noexcept
-		{
-			return m_UUID == other.m_UUID;
-		}
+		[[nodiscard]] u64 GetHigh() const noexcept { return m_High; }
+		[[nodiscard]] u64 GetLow() const noexcept { return m_Low; }
+
+		bool operator==(const UUID& other) const noexcept = default;
 	private:
-		std::string m_UUID;
+		u64 m_High = 0;
+		u64 m_Low = 0;
+
+		static inline thread_local std::mt19937_64 s_Rng = std::mt19937_64(std::random_device{}());
 	};
 }
 
@@ -30,6 +33,6 @@ struct std::hash<Core::UUID>
 {
 	std::size_t operator()(const Core::UUID& uuid) const noexcept
 	{
-		return std::hash<std::string>()(static_cast<std::string>(uuid));
+		return std::hash<u64>()(uuid.GetHigh() ^ (uuid.GetLow() * 0x9E3779B97F4A7C15ull));
 	}
 };
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <span>
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+#include "Types.h"
+#include "VkTypes.h"
+
+namespace Core
+{
+	// records copies into gpu resources on one command buffer per batch and submits them on its own queue,
+	// the data goes through a persistently mapped staging ring so nothing is allocated per upload
+	// every flushed batch signals the next value of a timeline semaphore, work that reads the uploads waits
+	// for GetSubmittedValue on the gpu instead of the cpu waiting for the queue
+	// note: main thread only
+	class UploadContext
+	{
+	public:
+		void Init(VkDevice device, VmaAllocator allocator, VkQueue queue, u32 queueFamily, VkDeviceSize stagingSize);
+		void Cleanup();
+
+		void UploadBuffer(VkBuffer buffer, VkDeviceSize offset, std::span<const u8> data);
+		// the whole image goes from undefined to shader read only, data is tightly packed texels
+		void UploadImage(VkImage image, u32 width, u32 height, std::span<const u8> data);
+		// ordered after every copy recorded before it and before every copy recorded after it
+		void CopyBuffer(VkBuffer source, VkBuffer destination, VkDeviceSize size);
+
+		// submits what was recorded since the last flush, returns the timeline value it signals
+		u64 Flush();
+		void Wait(u64 value);
+
+		[[nodiscard]] VkSemaphore GetTimelineSemaphore() const noexcept { return m_Timeline; }
+		[[nodiscard]] u64 GetSubmittedValue() const noexcept { return m_SubmittedValue; }
+	private:
+		struct Batch
+		{
+			VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+			u64 Value = 0;
+			u64 StagingEnd = 0;
+			std::vector<Buffer> RetiredBuffers;
+		};
+
+		// returns where to write size bytes, buffer and offset are what the copy reads from, an upload bigger than
+		// the whole ring gets a buffer of its own instead
+		u8* AllocateStaging(VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset);
+		VkCommandBuffer GetCommandBuffer();
+		void Reclaim();
+	private:
+		VkDevice m_Device = VK_NULL_HANDLE;
+		VmaAllocator m_Allocator = VK_NULL_HANDLE;
+		VkQueue m_Queue = VK_NULL_HANDLE;
+
+		VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> m_FreeCommandBuffers;
+
+		VkSemaphore m_Timeline = VK_NULL_HANDLE;
+		u64 m_SubmittedValue = 0;
+
+		Buffer m_Staging;
+		u8* m_StagingData = nullptr;
+		VkDeviceSize m_StagingSize = 0;
+		// positions in the ring only ever grow, the byte offset is position % m_StagingSize
+		u64 m_Head = 0;
+		u64 m_Tail = 0;
+
+		Batch m_Recording;
+		std::deque<Batch> m_InFlight;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Types.h"
+
+namespace Core
+{
+	// position, normal and uv, the layout the importers produce and object.vert reads
+	struct Vertex
+	{
+		glm::vec3 Position = glm::vec3(0.0f);
+		glm::vec3 Normal = glm::vec3(0.0f);
+		glm::vec2 TextureCoordinate = glm::vec2(0.0f);
+	};
+
+	static_assert(sizeof(Vertex) == 32);
+
+	enum class VertexFormat : u8
+	{
+		Full,
+		Packed
+	};
+
+	constexpr usize VertexFormatCount = 2;
+
+	// the gpu side of a mesh in VertexFormat::Packed, read by object_packed.vert:
+	// position quantized to 16 bits per axis over the mesh bounds (w is padding), the model matrix carries the dequantization,
+	// normal octahedral-encoded into two snorm16s, uv as half floats
+	struct PackedVertex
+	{
+		u16 Position[4];
+		i16 Normal[2];
+		u16 TextureCoordinate[2];
+	};
+
+	static_assert(sizeof(PackedVertex) == 16);
+}
\ No newline at end of file
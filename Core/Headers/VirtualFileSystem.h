@@ -0,0 +1,57 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <vector>
+#include <memory>
+#include <optional>
+
+#include "Types.h"
+#include "MappedFile.h"
+#include "AssetPack.h"
+
+namespace Core
+{
+	// contents of a file opened through the VirtualFileSystem, a slice of a mounted pack or a mapping of the loose file
+	class VirtualFile
+	{
+	public:
+		VirtualFile() = default;
+		VirtualFile(std::span<const u8> packedData, u64 contentHash);
+		explicit VirtualFile(MappedFile mapping);
+
+		[[nodiscard]] bool IsOpen() const noexcept { return m_Open; }
+		[[nodiscard]] bool IsPacked() const noexcept { return m_Packed; }
+
+		[[nodiscard]] std::span<const u8> GetData() const noexcept { return m_Data; }
+
+		// HashBytes of the contents, read from the pack or computed on first use for loose files
+		[[nodiscard]] u64 GetContentHash() const;
+	private:
+		MappedFile m_Mapping;
+		std::span<const u8> m_Data;
+		mutable std::optional<u64> m_ContentHash;
+		bool m_Open = false;
+		bool m_Packed = false;
+	};
+
+	// packs mounted over a directory are searched before the loose files under it, the last mount wins
+	// note: mount packs before loading assets, Open is called from loader threads without locking
+	class VirtualFileSystem
+	{
+	public:
+		static VirtualFileSystem& Get();
+
+		bool Mount(const std::filesystem::path& packPath, const std::filesystem::path& mountPoint);
+
+		[[nodiscard]] VirtualFile Open(const std::filesystem::path& path) const;
+	private:
+		struct MountedPack
+		{
+			AssetPack Pack;
+			std::filesystem::path MountPoint;
+		};
+
+		std::vector<std::unique_ptr<MountedPack>> m_Mounts;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Component.h"
+
+namespace Core
+{
+	struct Visibility : public Component
+	{
+		bool IsVisible = true;
+	};
+}
\ No newline at end of file
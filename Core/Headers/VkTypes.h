@@ -1,13 +1,14 @@
 #pragma once
 
 #include <vector>
+#include <array>
 
 #include <VkBootstrap.h>
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 
 #include "Types.h"
-#include "OBJ-Loader.h"
+#include "Vertex.h"
 
 namespace Core
 {
@@ -26,6 +27,9 @@ namespace Core
 		VkQueue GraphicsQueue;
 		VkQueue PresentQueue;
 		u32 QueueFamily;
+		// a transfer-only family when the device has one, otherwise the graphics queue again
+		VkQueue TransferQueue;
+		u32 TransferQueueFamily;
 
 		std::vector<VkImage> SwapchainImages;
 		std::vector<VkImageView> SwapchainImageViews;
@@ -43,17 +47,17 @@ namespace Core
 
 	struct Buffer
 	{
-		VkBuffer Buffer;
-		VmaAllocation Allocation;
+		VkBuffer Buffer = VK_NULL_HANDLE;
+		VmaAllocation Allocation = VK_NULL_HANDLE;
 	};
 
 	struct Image
 	{
-		VkImage Image;
-		VkImageView View;
-		VkExtent3D Extent;
-		VkFormat Format;
-		VmaAllocation Allocation;
+		VkImage Image = VK_NULL_HANDLE;
+		VkImageView View = VK_NULL_HANDLE;
+		VkExtent3D Extent = {};
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		VmaAllocation Allocation = VK_NULL_HANDLE;
 	};
 
 	struct DescriptorBinding
@@ -133,14 +137,77 @@ namespace Core
 	struct ObjPushConstants
 	{
 		glm::mat4 Model;
+		glm::mat3x4 NormalMatrix; // mat3 in glsl, push constants pad every column to 16 bytes
 		u32 MaterialIndex;
 	};
 
+	// one entity as the gpu-driven path sees it, mirrors Object in cull.comp and the *_indirect.vert shaders (std430)
+	struct GPUObjectLOD
+	{
+		u32 FirstIndex = 0; // already offset by the mesh's GeometryRange::FirstIndex
+		u32 IndexCount = 0;
+		f32 Error = 0.0f; // in world units
+		u32 Padding = 0;
+	};
+
+	constexpr u32 GPUObjectMaxLODs = 5;
+	// objects in this bucket are skipped by the culling pass
+	constexpr u32 GPUInactiveBucket = ~0u;
+	// one bucket per vertex format and index type, every bucket is drawn with its own pipeline and index buffer binding
+	constexpr u32 GPUDrawBucketCount = 4;
+
+	struct GPUObject
+	{
+		glm::mat4 Model; // world matrix times the mesh's dequantization matrix
+		glm::mat3x4 NormalMatrix;
+		glm::vec4 BoundingSphere; // world space center and radius
+		u32 MaterialIndex = ~0u;
+		u32 Bucket = GPUInactiveBucket;
+		i32 VertexOffset = 0;
+		u32 LODCount = 0;
+		std::array<GPUObjectLOD, GPUObjectMaxLODs> LODs = {};
+	};
+
+	static_assert(sizeof(GPUObject) == 224, "GPUObject has to match the std430 layout of the shaders");
+
+	// push constants of cull.comp, the planes are normalized and in world space
+	struct GPUCullConstants
+	{
+		std::array<glm::vec4, 6> Planes = {};
+		glm::vec3 CameraPosition = glm::vec3(0.0f);
+		f32 PixelsPerUnitAtOne = 0.0f; // pixels one world unit covers at distance 1
+		u32 ObjectCount = 0;
+		u32 MaxDrawsPerBucket = 0;
+		f32 MaxLODPixelError = 0.0f;
+		f32 LODHysteresis = 1.0f;
+	};
+
+	// what the culling pass of a finished frame let through
+	struct GPUCullStats
+	{
+		u32 VisibleObjects = 0;
+		u32 VisibleTriangles = 0;
+	};
+
+	// a mesh's share of the renderer's geometry buffers, VertexOffset and FirstIndex are in vertices and indices
+	// of the mesh's own format so they go straight into draw commands
+	struct GeometryRange
+	{
+		u64 VertexByteOffset = 0;
+		u64 VertexBytes = 0;
+		u64 IndexByteOffset = 0;
+		u64 IndexBytes = 0;
+		i32 VertexOffset = 0;
+		u32 FirstIndex = 0;
+
+		[[nodiscard]] bool IsValid() const noexcept { return VertexBytes != 0; }
+	};
+
 	struct MeshBuffers
 	{
 		Buffer VertexBuffer;
 		Buffer IndexBuffer;
-		std::vector<objl::Vertex> Vertices;
+		std::vector<Vertex> Vertices;
 		std::vector<u32> Indices;
 	};
 }
@@ -0,0 +1,7 @@
+#!/bin/sh
+set -e
+mkdir -p Shaders/Compiled
+for f in Shaders/*.frag Shaders/*.vert Shaders/*.comp Shaders/*.geom; do
+    [ -e "$f" ] || continue
+    glslangValidator "$f" -V -o "Shaders/Compiled/$(basename "$f").spv"
+done
\ No newline at end of file
@@ -22,6 +22,7 @@ layout (binding = 1) readonly buffer MaterialBuffer
 layout(push_constant) uniform PushConstants 
 {
 	mat4 model;
+	mat3 normalMatrix;
 	uint materialIndex;
 } pushConstants;
 
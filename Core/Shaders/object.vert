@@ -30,6 +30,7 @@ layout (binding = 1) readonly buffer MaterialBuffer
 layout(push_constant) uniform PushConstants 
 {
 	mat4 model;
+	mat3 normalMatrix;
 	uint materialIndex;
 } pushConstants;
 
@@ -37,7 +38,7 @@ void main()
 {
 	gl_Position = vp.projection * vp.view * pushConstants.model * vec4(inPosition, 1.0);
 
-	fragNormal = mat3(transpose(inverse(pushConstants.model))) * inNormal;
+	fragNormal = pushConstants.normalMatrix * inNormal;
 	fragTexCoord = inTexCoord;
 
 	if(pushConstants.materialIndex == -1)
@@ -0,0 +1,74 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+
+layout (location = 0) out vec3 fragColor;
+layout (location = 1) out vec3 fragNormal;
+layout (location = 2) out vec2 fragTexCoord;
+
+struct Material
+{
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+	float shininess;
+};
+
+layout(binding = 0) readonly buffer VP
+{
+	mat4 view;
+	mat4 projection;
+} vp;
+
+layout (binding = 1) readonly buffer MaterialBuffer
+{
+	Material[] materials;
+};
+
+struct LOD
+{
+	uint firstIndex;
+	uint indexCount;
+	float error;
+	uint padding;
+};
+
+// written by GPUScene, the draw's firstInstance is the object's index
+struct Object
+{
+	mat4 model;
+	mat3 normalMatrix;
+	vec4 boundingSphere;
+	uint materialIndex;
+	uint bucket;
+	int vertexOffset;
+	uint lodCount;
+	LOD lods[5];
+};
+
+layout (binding = 2) readonly buffer Objects
+{
+	Object objects[];
+};
+
+void main()
+{
+	mat4 model = objects[gl_InstanceIndex].model;
+	uint materialIndex = objects[gl_InstanceIndex].materialIndex;
+
+	gl_Position = vp.projection * vp.view * model * vec4(inPosition, 1.0);
+
+	fragNormal = objects[gl_InstanceIndex].normalMatrix * inNormal;
+	fragTexCoord = inTexCoord;
+
+	if(materialIndex == -1)
+	{
+		fragColor = vec3(0.5, 0.5, 0.5);
+	}
+	else
+	{
+		fragColor = materials[materialIndex].diffuse;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#version 450
+
+// VertexFormat::Packed, the model matrix already includes the mesh's dequantization
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+
+layout (location = 0) out vec3 fragColor;
+layout (location = 1) out vec3 fragNormal;
+layout (location = 2) out vec2 fragTexCoord;
+
+struct Material
+{
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+	float shininess;
+};
+
+layout(binding = 0) readonly buffer VP
+{
+	mat4 view;
+	mat4 projection;
+} vp;
+
+layout (binding = 1) readonly buffer MaterialBuffer
+{
+	Material[] materials;
+};
+
+layout(push_constant) uniform PushConstants 
+{
+	mat4 model;
+	mat3 normalMatrix;
+	uint materialIndex;
+} pushConstants;
+
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-normal.z, 0.0);
+	normal.x += normal.x >= 0.0 ? -fold : fold;
+	normal.y += normal.y >= 0.0 ? -fold : fold;
+	return normalize(normal);
+}
+
+void main()
+{
+	gl_Position = vp.projection * vp.view * pushConstants.model * vec4(inPosition, 1.0);
+
+	fragNormal = pushConstants.normalMatrix * DecodeOctahedral(inNormal);
+	fragTexCoord = inTexCoord;
+
+	if(pushConstants.materialIndex == -1)
+	{
+		fragColor = vec3(0.5, 0.5, 0.5);
+	}
+	else
+	{
+		fragColor = materials[pushConstants.materialIndex].diffuse;
+	}
+}
\ No newline at end of file
@@ -183,8 +183,13 @@ namespace Core
 		s_Instance->m_Renderer->SetBackgroundColor(color);
 	}
 
-	MeshBuffers Application::CreateMeshBuffers(const std::vector<objl::Vertex>& vertices, const std::vector<u32>& indices)
+	MeshBuffers Application::CreateMeshBuffers(const std::vector<Vertex>& vertices, const std::vector<u32>& indices)
 	{
 		return s_Instance->m_Renderer->CreateMeshBuffers(vertices, indices);
 	}
+
+	MeshBuffers Application::CreateMeshBuffers(std::span<const u8> vertexData, std::span<const u8> indexData)
+	{
+		return s_Instance->m_Renderer->CreateMeshBuffers(vertexData, indexData);
+	}
 }
\ No newline at end of file
@@ -1,35 +1,392 @@
 #include "AssetManager.h"
 
+#include <algorithm>
+#include <optional>
+
+#include "VirtualFileSystem.h"
+
 namespace Core
 {
 	AssetManager::~AssetManager()
 	{
-		m_Assets.clear();
+		// workers still decoding write into assets owned by the slots
+		for (AssetSlot& slot : m_Slots)
+		{
+			if (slot.Decoding)
+				ThreadPool::Get().Wait(*slot.Decoding);
+		}
+
+		m_Slots.clear();
 	}
 
-	Asset* AssetManager::GetAssetByID(const UUID& id)
+	void AssetManager::Update(u32 maxUploads)
 	{
-		for (const auto& [path, asset] : m_Assets)
+		std::vector<CompletedLoad> completed;
+
 		{
-			if (asset->GetID() == id)
+			std::lock_guard lock(m_CompletedMutex);
+
+			while (!m_CompletedLoads.empty() && completed.size() < maxUploads)
 			{
-				return asset.get();
+				completed.push_back(std::move(m_CompletedLoads.front()));
+				m_CompletedLoads.pop_front();
 			}
 		}
-		LOG_WARN("Asset with ID: {} not found.", static_cast<std::string>(id));
-		return nullptr;
+
+		for (const CompletedLoad& load : completed)
+			CompleteLoad(load);
+
+		// evicted assets come back once they're referenced and used again
+		std::erase_if(m_EvictedSlots, [this](u32 index)
+		{
+			const AssetSlot& slot = m_Slots[index];
+
+			if (slot.State != AssetState::Evicted)
+				return true;
+
+			if (slot.References == 0 || m_LastUsed[index].load(std::memory_order_relaxed) == 0)
+				return false;
+
+			QueueDecode(index);
+			return true;
+		});
+
+		m_Frame++;
 	}
 
-	std::filesystem::path AssetManager::GetAssetPathByID(const UUID& id)
+	void AssetManager::Flush()
 	{
-		for (const auto& [path, asset] : m_Assets)
+		while (m_PendingLoads != 0)
 		{
-			if (asset->GetID() == id)
+			for (AssetSlot& slot : m_Slots)
 			{
-				return path;
+				if (slot.Decoding)
+					ThreadPool::Get().Wait(*slot.Decoding);
 			}
+
+			Update(std::numeric_limits<u32>::max());
+		}
+	}
+
+	void AssetManager::WaitForLoad(u32 index)
+	{
+		// runs the decode right here if no worker started it yet, the other pending loads keep streaming
+		ThreadPool::Get().Wait(*m_Slots[index].Decoding);
+
+		AssetHandle<> handle = { index, m_Slots[index].Generation };
+		std::optional<CompletedLoad> load;
+
+		{
+			std::lock_guard lock(m_CompletedMutex);
+
+			if (auto it = std::ranges::find(m_CompletedLoads, handle, &CompletedLoad::Handle); it != m_CompletedLoads.end())
+			{
+				load = *it;
+				m_CompletedLoads.erase(it);
+			}
+		}
+
+		if (load)
+			CompleteLoad(*load);
+	}
+
+	void AssetManager::CompleteLoad(const CompletedLoad& load)
+	{
+		AssetSlot& slot = m_Slots[load.Handle.Index];
+		m_PendingLoads--;
+
+		if (slot.Generation != load.Handle.Generation)
+			return;
+
+		if (!load.Decoded)
+		{
+			slot.State = AssetState::Failed;
+			LOG_ERROR("Failed to load asset: {}", slot.Path.string());
+			return;
+		}
+
+		slot.Upload(slot.Instance.get());
+		slot.State = AssetState::Ready;
+		MakeResident(load.Handle.Index);
+		m_Version++;
+	}
+
+	bool AssetManager::MountPack(const std::filesystem::path& packPath, const std::filesystem::path& mountPoint)
+	{
+		return VirtualFileSystem::Get().Mount(packPath, mountPoint);
+	}
+
+	void AssetManager::AddReference(AssetHandle<> handle)
+	{
+		if (handle.Index >= m_Slots.size() || m_Slots[handle.Index].Generation != handle.Generation)
+			return;
+
+		AssetSlot& slot = m_Slots[handle.Index];
+
+		if (slot.References++ == 0 && slot.State == AssetState::Evicted)
+			QueueDecode(handle.Index);
+	}
+
+	void AssetManager::ReleaseReference(AssetHandle<> handle)
+	{
+		if (handle.Index >= m_Slots.size() || m_Slots[handle.Index].Generation != handle.Generation)
+			return;
+
+		AssetSlot& slot = m_Slots[handle.Index];
+
+		if (slot.References == 0)
+		{
+			LOG_ERROR("Asset: {} was released more times than it was referenced.", slot.Path.string());
+			return;
+		}
+
+		slot.References--;
+	}
+
+	void AssetManager::Pin(const UUID& id)
+	{
+		u32 slot = FindSlot(id);
+
+		if (slot == AssetHandle<>::InvalidIndex)
+		{
+			LOG_WARN("Asset with ID: {} not found.", static_cast<std::string>(id));
+			return;
+		}
+
+		m_Slots[slot].Pinned = true;
+	}
+
+	void AssetManager::Unload(AssetHandle<> handle)
+	{
+		if (handle.Index >= m_Slots.size() || m_Slots[handle.Index].Generation != handle.Generation)
+			return;
+
+		AssetSlot& slot = m_Slots[handle.Index];
+
+		if (slot.References != 0 || slot.Pinned)
+		{
+			LOG_WARN("Asset: {} is still referenced or pinned, not unloading it.", slot.Path.string());
+			return;
+		}
+
+		// a worker is decoding into the instance
+		if (slot.State == AssetState::Loading)
+		{
+			LOG_WARN("Asset: {} is still loading, not unloading it.", slot.Path.string());
+			return;
+		}
+
+		if (slot.State == AssetState::Ready)
+		{
+			m_Stats.CPUBytes -= slot.CPUBytes;
+			m_Stats.GPUBytes -= slot.GPUBytes;
+			m_Version++;
+		}
+		else if (slot.State == AssetState::Evicted)
+		{
+			m_Stats.EvictedAssets--;
+		}
+
+		// the decode job may not have let go of its group yet
+		if (slot.Decoding)
+			ThreadPool::Get().Wait(*slot.Decoding);
+
+		m_IDIndex.erase(slot.Instance->GetID());
+		m_PathIndex.erase(slot.Path);
+
+		// the evicted list drops the slot on the next Update since it's no longer Evicted
+		slot = AssetSlot{ .Generation = slot.Generation + 1, .State = AssetState::Failed };
+		m_LastUsed[handle.Index].store(0, std::memory_order_relaxed);
+		m_FreeSlots.push_back(handle.Index);
+	}
+
+	void AssetManager::SetMemoryBudget(usize cpuBytes, usize gpuBytes) noexcept
+	{
+		m_Stats.CPUBudget = cpuBytes;
+		m_Stats.GPUBudget = gpuBytes;
+	}
+
+	void AssetManager::EvictToBudget()
+	{
+		auto overBudget = [this]() { return m_Stats.CPUBytes > m_Stats.CPUBudget || m_Stats.GPUBytes > m_Stats.GPUBudget; };
+
+		if (!overBudget())
+			return;
+
+		struct Candidate
+		{
+			u32 Slot;
+			bool Referenced;
+			u32 LastUsed;
+		};
+
+		std::vector<Candidate> candidates;
+
+		for (u32 i = 0; i < m_Slots.size(); i++)
+		{
+			const AssetSlot& slot = m_Slots[i];
+
+			if (slot.State != AssetState::Ready || slot.Pinned || !slot.Decode || slot.CPUBytes + slot.GPUBytes == 0)
+				continue;
+
+			u32 lastUsed = m_LastUsed[i].load(std::memory_order_relaxed);
+			bool referenced = slot.References != 0;
+
+			if (referenced && m_Frame - lastUsed < ColdFrameCount)
+				continue;
+
+			candidates.push_back({ i, referenced, lastUsed });
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+		{
+			return a.Referenced != b.Referenced ? !a.Referenced : a.LastUsed < b.LastUsed;
+		});
+
+		for (const Candidate& candidate : candidates)
+		{
+			if (!overBudget())
+				break;
+
+			Evict(candidate.Slot);
+		}
+	}
+
+	Asset* AssetManager::GetAsset(AssetHandle<> handle) noexcept
+	{
+		if (handle.Index >= m_Slots.size() || m_Slots[handle.Index].Generation != handle.Generation)
+			return nullptr;
+
+		return m_Slots[handle.Index].Instance.get();
+	}
+
+	AssetState AssetManager::GetState(AssetHandle<> handle) const noexcept
+	{
+		if (handle.Index >= m_Slots.size() || m_Slots[handle.Index].Generation != handle.Generation)
+			return AssetState::Failed;
+
+		return m_Slots[handle.Index].State;
+	}
+
+	Asset* AssetManager::GetAssetByID(const UUID& id)
+	{
+		u32 slot = FindSlot(id);
+
+		if (slot == AssetHandle<>::InvalidIndex)
+		{
+			LOG_WARN("Asset with ID: {} not found.", static_cast<std::string>(id));
+			return nullptr;
+		}
+
+		return m_Slots[slot].Instance.get();
+	}
+
+	std::filesystem::path AssetManager::GetAssetPathByID(const UUID& id)
+	{
+		u32 slot = FindSlot(id);
+
+		if (slot == AssetHandle<>::InvalidIndex)
+		{
+			LOG_WARN("Asset with ID: {} not found.", static_cast<std::string>(id));
+			return std::filesystem::path();
 		}
-		LOG_WARN("Asset with ID: {} not found.", static_cast<std::string>(id));
-		return std::filesystem::path();
+
+		return m_Slots[slot].Path;
+	}
+
+	u32 AssetManager::FindSlot(const UUID& id) const
+	{
+		auto it = m_IDIndex.find(id);
+		return it != m_IDIndex.end() ? it->second : AssetHandle<>::InvalidIndex;
+	}
+
+	AssetHandle<> AssetManager::AddSlot(std::unique_ptr<Asset> asset, const std::filesystem::path& path, AssetState state)
+	{
+		u32 index;
+
+		if (!m_FreeSlots.empty())
+		{
+			// the generation was bumped by Unload, handles to the previous asset don't match it
+			index = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+
+			m_Slots[index] = { std::move(asset), path, m_Slots[index].Generation, state };
+			m_LastUsed[index].store(m_Frame, std::memory_order_relaxed);
+		}
+		else
+		{
+			index = static_cast<u32>(m_Slots.size());
+
+			m_Slots.push_back({ std::move(asset), path, 0, state });
+			m_LastUsed.emplace_back(m_Frame);
+		}
+
+		m_IDIndex[m_Slots[index].Instance->GetID()] = index;
+		m_PathIndex[path] = index;
+
+		if (state == AssetState::Ready)
+		{
+			MakeResident(index);
+			m_Version++;
+		}
+
+		return { index, m_Slots[index].Generation };
+	}
+
+	void AssetManager::QueueDecode(u32 index)
+	{
+		AssetSlot& slot = m_Slots[index];
+
+		if (slot.State == AssetState::Evicted)
+		{
+			m_Stats.EvictedAssets--;
+			m_Stats.Reloads++;
+		}
+
+		slot.State = AssetState::Loading;
+		m_PendingLoads++;
+
+		if (!slot.Decoding)
+			slot.Decoding = std::make_unique<JobGroup>();
+
+		// the worker only touches the asset it decodes, the slot table is only changed on the main thread
+		// decoding is background work so it never delays the per-frame system batches
+		ThreadPool::Get().Submit(*slot.Decoding, [this, asset = slot.Instance.get(), decode = slot.Decode, path = slot.Path, handle = AssetHandle<>{ index, slot.Generation }]()
+		{
+			bool decoded = decode(asset, path);
+
+			std::lock_guard lock(m_CompletedMutex);
+			m_CompletedLoads.push_back({ handle, decoded });
+		}, JobPriority::Background);
+	}
+
+	void AssetManager::MakeResident(u32 index)
+	{
+		AssetSlot& slot = m_Slots[index];
+
+		slot.CPUBytes = slot.Instance->GetCPUMemoryUsage();
+		slot.GPUBytes = slot.Instance->GetGPUMemoryUsage();
+		m_Stats.CPUBytes += slot.CPUBytes;
+		m_Stats.GPUBytes += slot.GPUBytes;
+	}
+
+	void AssetManager::Evict(u32 index)
+	{
+		AssetSlot& slot = m_Slots[index];
+
+		slot.Instance->Release();
+		slot.State = AssetState::Evicted;
+
+		m_Stats.CPUBytes -= slot.CPUBytes;
+		m_Stats.GPUBytes -= slot.GPUBytes;
+		slot.CPUBytes = 0;
+		slot.GPUBytes = 0;
+
+		m_LastUsed[index].store(0, std::memory_order_relaxed);
+		m_EvictedSlots.push_back(index);
+
+		m_Stats.EvictedAssets++;
+		m_Stats.Evictions++;
+		m_Version++;
 	}
 }
\ No newline at end of file
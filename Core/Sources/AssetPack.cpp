@@ -0,0 +1,189 @@
+#include "AssetPack.h"
+
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+#include "Hash.h"
+#include "Log.h"
+
+namespace Core
+{
+	namespace
+	{
+		constexpr u64 AlignOffset(u64 offset) noexcept
+		{
+			return (offset + AssetPack::PayloadAlignment - 1) & ~static_cast<u64>(AssetPack::PayloadAlignment - 1);
+		}
+	}
+
+	bool AssetPack::Build(const std::filesystem::path& directory, const std::filesystem::path& packPath)
+	{
+		struct PackedFile
+		{
+			std::filesystem::path Path;
+			PackEntry Entry;
+		};
+
+		std::vector<PackedFile> files;
+		std::error_code error;
+
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, error))
+		{
+			std::error_code notPacked;
+
+			if (!entry.is_regular_file() || std::filesystem::equivalent(entry.path(), packPath, notPacked))
+				continue;
+
+			PackedFile file;
+			file.Path = entry.path();
+			file.Entry.PathHash = HashPath(entry.path().lexically_relative(directory));
+			files.push_back(file);
+		}
+
+		if (error)
+		{
+			LOG_ERROR("Couldn't read the directory: {}", directory.string());
+			return false;
+		}
+
+		std::sort(files.begin(), files.end(), [](const PackedFile& a, const PackedFile& b) { return a.Entry.PathHash < b.Entry.PathHash; });
+
+		for (usize i = 1; i < files.size(); i++)
+		{
+			if (files[i].Entry.PathHash == files[i - 1].Entry.PathHash)
+			{
+				LOG_ERROR("Path hash collision between {} and {}", files[i - 1].Path.string(), files[i].Path.string());
+				return false;
+			}
+		}
+
+		PackHeader header;
+		header.Magic = Magic;
+		header.Version = Version;
+		header.EntryCount = static_cast<u32>(files.size());
+		header.PayloadAlignment = PayloadAlignment;
+		header.TocOffset = sizeof(PackHeader);
+
+		std::filesystem::path tempPath = packPath;
+		tempPath += ".tmp";
+
+		{
+			std::ofstream pack(tempPath, std::ios::binary | std::ios::trunc);
+
+			if (!pack)
+			{
+				LOG_ERROR("Couldn't create the asset pack: {}", tempPath.string());
+				return false;
+			}
+
+			// the table is written again once the offsets and hashes are known
+			pack.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			pack.seekp(static_cast<std::streamoff>(header.TocOffset + files.size() * sizeof(PackEntry)));
+
+			u64 offset = header.TocOffset + files.size() * sizeof(PackEntry);
+			const char padding[PayloadAlignment] = {};
+
+			for (PackedFile& file : files)
+			{
+				MappedFile source(file.Path);
+				std::span<const u8> data = source.GetData();
+
+				u64 alignedOffset = AlignOffset(offset);
+				pack.write(padding, static_cast<std::streamsize>(alignedOffset - offset));
+				pack.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+				file.Entry.Offset = alignedOffset;
+				file.Entry.Size = data.size();
+				file.Entry.StoredSize = data.size();
+				file.Entry.ContentHash = HashBytes(data);
+				file.Entry.Compression = PackCompression::None;
+
+				offset = alignedOffset + data.size();
+			}
+
+			pack.seekp(static_cast<std::streamoff>(header.TocOffset));
+
+			for (const PackedFile& file : files)
+				pack.write(reinterpret_cast<const char*>(&file.Entry), sizeof(PackEntry));
+
+			if (!pack)
+			{
+				LOG_ERROR("Couldn't write the asset pack: {}", tempPath.string());
+				pack.close();
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+		}
+
+		std::filesystem::rename(tempPath, packPath, error);
+
+		if (error)
+		{
+			LOG_ERROR("Couldn't write the asset pack: {}", packPath.string());
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+
+		LOG_INFO("Packed {} files from {} into {}", files.size(), directory.string(), packPath.string());
+		return true;
+	}
+
+	u64 AssetPack::HashPath(const std::filesystem::path& relativePath)
+	{
+		return HashString(relativePath.lexically_normal().generic_string());
+	}
+
+	bool AssetPack::Open(const std::filesystem::path& packPath)
+	{
+		MappedFile file(packPath);
+
+		if (!file.IsOpen() || file.GetSize() < sizeof(PackHeader))
+		{
+			LOG_ERROR("Couldn't open the asset pack: {}", packPath.string());
+			return false;
+		}
+
+		const PackHeader* header = reinterpret_cast<const PackHeader*>(file.GetData().data());
+
+		if (header->Magic != Magic || header->Version != Version || header->TocOffset % alignof(PackEntry) != 0 ||
+			header->TocOffset + static_cast<u64>(header->EntryCount) * sizeof(PackEntry) > file.GetSize())
+		{
+			LOG_ERROR("Invalid asset pack: {}", packPath.string());
+			return false;
+		}
+
+		std::span<const PackEntry> entries(reinterpret_cast<const PackEntry*>(file.GetData().data() + header->TocOffset), header->EntryCount);
+
+		for (const PackEntry& entry : entries)
+		{
+			// uncompressed entries are read back as Size bytes at Offset, Size has to be what was stored and fit in the file
+			if (entry.Compression != PackCompression::None || entry.Size != entry.StoredSize ||
+				entry.Offset > file.GetSize() || entry.Size > file.GetSize() - entry.Offset)
+			{
+				LOG_ERROR("Invalid asset pack: {}", packPath.string());
+				return false;
+			}
+		}
+
+		m_Path = packPath;
+		m_File = std::move(file);
+		m_Entries = entries;
+
+		return true;
+	}
+
+	const PackEntry* AssetPack::Find(const std::filesystem::path& relativePath) const
+	{
+		u64 hash = HashPath(relativePath);
+
+		auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), hash, [](const PackEntry& entry, u64 value) { return entry.PathHash < value; });
+
+		return it != m_Entries.end() && it->PathHash == hash ? &*it : nullptr;
+	}
+
+	std::span<const u8> AssetPack::GetData(const PackEntry& entry) const noexcept
+	{
+		return m_File.GetData().subspan(entry.Offset, entry.Size);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "BufferArena.h"
+
+#include <bit>
+
+#include "Log.h"
+
+namespace Core
+{
+	BufferArena::BufferArena(u64 capacity)
+	{
+		Grow(capacity);
+	}
+
+	u64 BufferArena::Allocate(u64 size, u64 alignment)
+	{
+		ASSERT(std::has_single_bit(alignment));
+
+		if (size == 0)
+			return InvalidOffset;
+
+		auto best = m_FreeBlocks.end();
+		u64 bestWaste = std::numeric_limits<u64>::max();
+
+		for (auto it = m_FreeBlocks.begin(); it != m_FreeBlocks.end(); ++it)
+		{
+			u64 aligned = (it->first + alignment - 1) & ~(alignment - 1);
+
+			if (aligned + size > it->first + it->second)
+				continue;
+
+			u64 waste = it->second - size;
+
+			if (waste < bestWaste)
+			{
+				bestWaste = waste;
+				best = it;
+
+				if (waste == 0)
+					break;
+			}
+		}
+
+		if (best == m_FreeBlocks.end())
+			return InvalidOffset;
+
+		u64 blockOffset = best->first;
+		u64 blockEnd = best->first + best->second;
+		u64 offset = (blockOffset + alignment - 1) & ~(alignment - 1);
+
+		m_FreeBlocks.erase(best);
+
+		// whatever alignment skipped at the front and the rest at the back stay free
+		if (offset > blockOffset)
+			m_FreeBlocks.emplace(blockOffset, offset - blockOffset);
+
+		if (offset + size < blockEnd)
+			m_FreeBlocks.emplace(offset + size, blockEnd - offset - size);
+
+		m_UsedBytes += size;
+
+		return offset;
+	}
+
+	void BufferArena::Free(u64 offset, u64 size)
+	{
+		if (offset == InvalidOffset || size == 0)
+			return;
+
+		ASSERT(offset + size <= m_Capacity);
+
+		m_UsedBytes -= size;
+		AddFreeBlock(offset, size);
+	}
+
+	void BufferArena::Grow(u64 capacity)
+	{
+		if (capacity <= m_Capacity)
+			return;
+
+		u64 previousCapacity = m_Capacity;
+		m_Capacity = capacity;
+
+		AddFreeBlock(previousCapacity, capacity - previousCapacity);
+	}
+
+	void BufferArena::AddFreeBlock(u64 offset, u64 size)
+	{
+		auto next = m_FreeBlocks.lower_bound(offset);
+
+		if (next != m_FreeBlocks.end() && offset + size == next->first)
+		{
+			size += next->second;
+			next = m_FreeBlocks.erase(next);
+		}
+
+		if (next != m_FreeBlocks.begin())
+		{
+			auto previous = std::prev(next);
+
+			if (previous->first + previous->second == offset)
+			{
+				previous->second += size;
+				return;
+			}
+		}
+
+		m_FreeBlocks.emplace_hint(next, offset, size);
+	}
+}
\ No newline at end of file
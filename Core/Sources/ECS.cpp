@@ -2,30 +2,166 @@
 
 namespace Core
 {
-	UUID ECS::CreateEntity()
+	Entity ECS::CreateEntity()
 	{
-		UUID id;
-		m_EntityComponentMap.emplace(id, std::vector<std::unique_ptr<Component>>());
-		m_EntityAssetMap.emplace(id, std::unordered_map<std::type_index, UUID>());
+		if (!CanChangeStructure())
+			return NullEntity;
 
-		return id;
+		m_StructureVersion++;
+		Entity entity;
+
+		if (!m_FreeIndices.empty())
+		{
+			entity.Index = m_FreeIndices.back();
+			entity.Generation = m_Generations[entity.Index];
+			m_FreeIndices.pop_back();
+
+			return entity;
+		}
+
+		entity.Index = static_cast<u32>(m_Generations.size());
+		entity.Generation = 0;
+
+		m_Generations.push_back(entity.Generation);
+		m_ComponentMasks.emplace_back();
+
+		return entity;
 	}
 
-	std::vector<Asset*> ECS::GetAllEntityAssets(const UUID& entity)
+	void ECS::DestroyEntity(Entity entity)
 	{
-		std::vector<Asset*> assets;
-		auto it = m_EntityAssetMap.find(entity);
+		if (!IsAlive(entity))
+		{
+			LOG_ERROR("Entity {} does not exist.", entity.Index);
+			return;
+		}
+
+		if (!CanChangeStructure())
+			return;
+
+		ComponentMask& mask = m_ComponentMasks[entity.Index];
+
+		for (TypeID id = 0; id < m_ComponentPools.size(); id++)
+		{
+			if (!mask.test(id))
+				continue;
+
+			if (m_AssetTypes.test(id))
+				m_AssetManager->ReleaseReference(*static_cast<ComponentPool<AssetHandle<>>*>(m_ComponentPools[id].get())->Get(entity.Index));
+
+			m_ComponentPools[id]->Remove(entity.Index);
+		}
+
+		mask.reset();
+		m_StructureVersion++;
+
+		// skip the pending marker so a recycled slot can never look like a command buffer placeholder
+		u32& generation = m_Generations[entity.Index];
+		generation = generation + 1 == Entity::PendingGeneration ? 0 : generation + 1;
+
+		m_FreeIndices.push_back(entity.Index);
+	}
+
+	bool ECS::IsAlive(Entity entity) const noexcept
+	{
+		return entity.Index < m_Generations.size() && m_Generations[entity.Index] == entity.Generation;
+	}
+
+	bool ECS::CanChangeStructure() const
+	{
+		if (IsIterating())
+		{
+			LOG_ERROR("Structural ECS change while iterating, record it in an EntityCommandBuffer instead.");
+			return false;
+		}
+
+		return true;
+	}
 
-		if (it == m_EntityAssetMap.end())
+	void ECS::RunSystems(f32 deltaTime)
+	{
+		if (m_SystemStagesDirty)
+			BuildSystemStages();
+
+		ThreadPool& threadPool = ThreadPool::Get();
+		usize maxBatches = static_cast<usize>(threadPool.GetThreadCount()) + 1;
+
+		for (const auto& stage : m_SystemStages)
+		{
+			JobGroup group;
+
+			for (u32 systemIndex : stage)
+			{
+				const System& system = m_Systems[systemIndex];
+
+				usize count = system.GetCandidateCount();
+				usize batchSize = std::max(std::max<usize>(system.MinBatchSize, 1), (count + maxBatches - 1) / maxBatches);
+
+				for (usize begin = 0; begin < count; begin += batchSize)
+				{
+					usize end = std::min(begin + batchSize, count);
+					threadPool.Submit(group, [&system, deltaTime, begin, end]() { system.Run(deltaTime, begin, end); });
+				}
+			}
+
+			threadPool.Wait(group);
+		}
+
+		m_CommandBuffer.Playback(*this);
+	}
+
+	void ECS::BuildSystemStages()
+	{
+		// a system lands in the first stage after every earlier system it conflicts with,
+		// so conflicting systems keep their registration order and the rest share a stage
+		std::vector<u32> systemStage(m_Systems.size(), 0);
+		m_SystemStages.clear();
+
+		for (u32 i = 0; i < m_Systems.size(); i++)
+		{
+			for (u32 j = 0; j < i; j++)
+			{
+				if (m_Systems[i].ConflictsWith(m_Systems[j]))
+					systemStage[i] = std::max(systemStage[i], systemStage[j] + 1);
+			}
+
+			if (systemStage[i] >= m_SystemStages.size())
+				m_SystemStages.resize(systemStage[i] + 1);
+
+			m_SystemStages[systemStage[i]].push_back(i);
+		}
+
+		m_SystemStagesDirty = false;
+	}
+
+	void ECS::ReleaseFreePages()
+	{
+		for (auto& pool : m_ComponentPools)
 		{
-			LOG_ERROR("Entity {} does not exist.", static_cast<std::string>(entity));
+			if (pool)
+				pool->ReleaseFreePages();
+		}
+	}
+
+	std::vector<Asset*> ECS::GetAllEntityAssets(Entity entity)
+	{
+		std::vector<Asset*> assets;
+		if (!IsAlive(entity))
+		{
+			LOG_ERROR("Entity {} does not exist.", entity.Index);
 			return assets;
 		}
 
-		for (const auto& [typeIdx, assetId] : it->second)
+		ComponentMask assetMask = m_ComponentMasks[entity.Index] & m_AssetTypes;
+
+		for (TypeID id = 0; id < m_ComponentPools.size(); id++)
 		{
-			assets.push_back(m_AssetManager->GetAssetByID(assetId));
+			if (!assetMask.test(id))
+				continue;
+
+			auto pool = static_cast<ComponentPool<AssetHandle<>>*>(m_ComponentPools[id].get());
+			assets.push_back(m_AssetManager->GetAsset(*pool->Get(entity.Index)));
 		}
 		return assets;
 	}
-}
\ No newline at end of file
+}
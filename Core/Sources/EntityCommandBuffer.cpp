@@ -0,0 +1,65 @@
+#include "EntityCommandBuffer.h"
+#include "ECS.h"
+
+namespace Core
+{
+	Entity EntityCommandBuffer::CreateEntity()
+	{
+		std::lock_guard lock(m_Mutex);
+
+		Entity placeholder = { m_PendingEntities++, Entity::PendingGeneration };
+		m_Commands.push_back({ placeholder, nullptr });
+
+		return placeholder;
+	}
+
+	void EntityCommandBuffer::DestroyEntity(Entity entity)
+	{
+		Record(entity, [](ECS& ecs, Entity target) { ecs.DestroyEntity(target); });
+	}
+
+	void EntityCommandBuffer::Playback(ECS& ecs)
+	{
+		if (ecs.IsIterating())
+		{
+			LOG_ERROR("Command buffer playback while the ECS is being iterated, commands are kept for the next playback.");
+			return;
+		}
+
+		std::vector<Command> commands;
+		u32 pendingEntities = 0;
+
+		{
+			// commands recorded while playing back land in the next batch
+			std::lock_guard lock(m_Mutex);
+			commands.swap(m_Commands);
+			pendingEntities = std::exchange(m_PendingEntities, 0);
+		}
+
+		std::vector<Entity> createdEntities(pendingEntities);
+
+		for (auto& command : commands)
+		{
+			if (!command.Apply)
+			{
+				createdEntities[command.Target.Index] = ecs.CreateEntity();
+				continue;
+			}
+
+			Entity target = command.Target.IsPending() ? createdEntities[command.Target.Index] : command.Target;
+			command.Apply(ecs, target);
+		}
+	}
+
+	bool EntityCommandBuffer::IsEmpty()
+	{
+		std::lock_guard lock(m_Mutex);
+		return m_Commands.empty();
+	}
+
+	void EntityCommandBuffer::Record(Entity entity, std::function<void(ECS&, Entity)> apply)
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Commands.push_back({ entity, std::move(apply) });
+	}
+}
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "GPUScene.h"
+
+#include <algorithm>
+
+#include "MeshOptimizer.h"
+
+namespace Core
+{
+	static_assert(GPUObjectMaxLODs >= MaxMeshLODs, "GPUObject can't hold every level of a mesh");
+
+	void GPUScene::Update(ECS& ecs, AssetManager& assetManager, const std::function<u32(Entity)>& materialIndexOf)
+	{
+		u32 sinceTick = m_LastTick;
+		m_LastTick = ecs.AdvanceTick();
+
+		if (m_StructureVersion != ecs.GetStructureVersion() || m_AssetVersion != assetManager.GetVersion())
+		{
+			m_StructureVersion = ecs.GetStructureVersion();
+			m_AssetVersion = assetManager.GetVersion();
+
+			Rewrite(ecs, assetManager, materialIndexOf);
+		}
+		else
+		{
+			auto write = [&](Entity entity, const WorldTransform& worldTransform, const Visibility& visibility)
+			{
+				u32 slot = GetSlot(entity);
+
+				if (slot == InvalidSlot)
+					return;
+
+				AssetHandle<Mesh> handle = ecs.GetAssetHandle<Mesh>(entity);
+
+				if (const Mesh* mesh = assetManager.Peek<Mesh>(handle))
+					Write(slot, worldTransform, handle, *mesh, visibility.IsVisible, materialIndexOf(entity));
+			};
+
+			auto& view = ecs.View<const WorldTransform, const Visibility>();
+			view.EachChangedSince<WorldTransform>(sinceTick, write);
+			view.EachChangedSince<Visibility>(sinceTick, write);
+		}
+	}
+
+	void GPUScene::Rewrite(ECS& ecs, AssetManager& assetManager, const std::function<u32(Entity)>& materialIndexOf)
+	{
+		std::vector<u8> live(m_SlotEntities.size(), 0);
+
+		m_ObjectCount = 0;
+
+		// the meshes are peeked, a rewrite after an eviction would otherwise bring every evicted mesh straight back
+		ecs.View<const WorldTransform, const Visibility>().Each(
+			[&](Entity entity, const WorldTransform& worldTransform, const Visibility& visibility)
+			{
+				AssetHandle<Mesh> handle = ecs.GetAssetHandle<Mesh>(entity);
+				const Mesh* mesh = assetManager.Peek<Mesh>(handle);
+
+				if (!mesh)
+					return;
+
+				u32 slot = GetSlot(entity);
+
+				if (slot == InvalidSlot)
+				{
+					slot = AllocateSlot(entity);
+					live.resize(m_SlotEntities.size(), 0);
+				}
+
+				Write(slot, worldTransform, handle, *mesh, visibility.IsVisible, materialIndexOf(entity));
+				live[slot] = 1;
+				m_ObjectCount++;
+			});
+
+		// entities that lost their mesh or were destroyed give their slot back and leave an inactive object behind
+		Application& app = Application::Get();
+
+		for (u32 slot = 0; slot < live.size(); slot++)
+		{
+			Entity& entity = m_SlotEntities[slot];
+
+			if (live[slot] || entity.IsNull())
+				continue;
+
+			// a new entity under the same index may already have a slot of its own
+			if (m_EntitySlots[entity.Index] == slot)
+				m_EntitySlots[entity.Index] = InvalidSlot;
+
+			entity = Entity();
+			m_SlotMeshes[slot] = {};
+			m_FreeSlots.push_back(slot);
+			app.UpdateGPUObject(slot, GPUObject());
+		}
+	}
+
+	u32 GPUScene::GetSlot(Entity entity) const noexcept
+	{
+		if (entity.Index >= m_EntitySlots.size())
+			return InvalidSlot;
+
+		u32 slot = m_EntitySlots[entity.Index];
+		return slot != InvalidSlot && m_SlotEntities[slot] == entity ? slot : InvalidSlot;
+	}
+
+	u32 GPUScene::AllocateSlot(Entity entity)
+	{
+		u32 slot;
+
+		if (!m_FreeSlots.empty())
+		{
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+			m_SlotEntities[slot] = entity;
+		}
+		else
+		{
+			slot = static_cast<u32>(m_SlotEntities.size());
+			m_SlotEntities.push_back(entity);
+			m_SlotMeshes.emplace_back();
+			m_SlotSpheres.emplace_back(0.0f);
+		}
+
+		if (entity.Index >= m_EntitySlots.size())
+			m_EntitySlots.resize(entity.Index + 1, InvalidSlot);
+
+		m_EntitySlots[entity.Index] = slot;
+		return slot;
+	}
+
+	void GPUScene::Write(u32 slot, const WorldTransform& worldTransform, AssetHandle<Mesh> handle, const Mesh& mesh, bool visible, u32 materialIndex)
+	{
+		// lod errors are in mesh units, the largest axis scale turns them into world units
+		const glm::mat4& matrix = worldTransform.Matrix;
+		f32 scale = std::max({ glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2])) });
+
+		const MeshBounds& bounds = mesh.GetBounds();
+		glm::vec3 center = glm::vec3(matrix * glm::vec4((bounds.Min + bounds.Max) * 0.5f, 1.0f));
+
+		GPUObject object;
+		object.Model = matrix * mesh.GetDequantizationMatrix();
+		object.NormalMatrix = glm::mat3x4(worldTransform.NormalMatrix);
+		object.BoundingSphere = glm::vec4(center, glm::length(bounds.Max - bounds.Min) * 0.5f * scale);
+		object.MaterialIndex = materialIndex;
+
+		const GeometryRange& geometry = mesh.GetGeometry();
+		const std::vector<MeshLOD>& lods = mesh.GetLODs();
+
+		if (visible && geometry.IsValid() && !lods.empty())
+		{
+			object.Bucket = Renderer::GetDrawBucket(mesh.GetVertexFormat(), mesh.GetIndexType());
+			object.VertexOffset = geometry.VertexOffset;
+			object.LODCount = std::min(static_cast<u32>(lods.size()), GPUObjectMaxLODs);
+
+			for (u32 i = 0; i < object.LODCount; i++)
+				object.LODs[i] = { geometry.FirstIndex + lods[i].FirstIndex, lods[i].IndexCount, lods[i].Error * scale };
+		}
+
+		// an evicted or still loading mesh is drawn as the placeholder but kept here, so being in view brings it back
+		m_SlotMeshes[slot] = visible ? handle : AssetHandle<Mesh>();
+		m_SlotSpheres[slot] = object.BoundingSphere;
+
+		Application::Get().UpdateGPUObject(slot, object);
+	}
+
+	void GPUScene::Cull(AssetManager& assetManager, const glm::mat4& viewProjection, const glm::vec3& cameraPosition, f32 pixelsPerUnitAtOne)
+	{
+		// frustum planes in world space (Gribb and Hartmann), depth is [0, w]
+		const glm::mat4 rows = glm::transpose(viewProjection);
+
+		GPUCullConstants constants;
+		constants.Planes = {
+			rows[3] + rows[0], rows[3] - rows[0],
+			rows[3] + rows[1], rows[3] - rows[1],
+			rows[2], rows[3] - rows[2]
+		};
+
+		for (glm::vec4& plane : constants.Planes)
+			plane /= glm::length(glm::vec3(plane));
+
+		// the gpu doesn't report which objects it drew, so the same frustum test runs here and only the meshes of
+		// objects that pass count as used, the rest can go cold and get evicted
+		for (u32 slot = 0; slot < m_SlotMeshes.size(); slot++)
+		{
+			AssetHandle<Mesh> handle = m_SlotMeshes[slot];
+			const glm::vec4& sphere = m_SlotSpheres[slot];
+
+			if (handle.IsNull())
+				continue;
+
+			bool inside = std::all_of(constants.Planes.begin(), constants.Planes.end(),
+				[&](const glm::vec4& plane) { return glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w >= -sphere.w; });
+
+			if (inside)
+				(void)assetManager.Get<Mesh>(handle);
+		}
+
+		constants.CameraPosition = cameraPosition;
+		constants.PixelsPerUnitAtOne = pixelsPerUnitAtOne;
+		constants.MaxLODPixelError = Mesh::MaxLODPixelError;
+		constants.LODHysteresis = Mesh::LODHysteresis;
+
+		Application::Get().CullGPUObjects(constants, static_cast<u32>(m_SlotEntities.size()));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Core
+{
+#ifdef _WIN32
+	MappedFile::MappedFile(const std::filesystem::path& path)
+	{
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+			return;
+
+		m_File = file;
+
+		LARGE_INTEGER size = {};
+
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			Close();
+			return;
+		}
+
+		m_Mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (!m_Mapping)
+		{
+			Close();
+			return;
+		}
+
+		m_Data = static_cast<const u8*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+		m_Size = m_Data ? static_cast<usize>(size.QuadPart) : 0;
+
+		if (!m_Data)
+			Close();
+	}
+
+	void MappedFile::Close() noexcept
+	{
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+
+		if (m_Mapping)
+			CloseHandle(m_Mapping);
+
+		if (m_File)
+			CloseHandle(m_File);
+
+		m_Data = nullptr;
+		m_Size = 0;
+		m_Mapping = nullptr;
+		m_File = nullptr;
+	}
+#else
+	MappedFile::MappedFile(const std::filesystem::path& path)
+	{
+		int file = open(path.c_str(), O_RDONLY);
+
+		if (file < 0)
+			return;
+
+		struct stat status = {};
+
+		if (fstat(file, &status) == 0 && status.st_size > 0)
+		{
+			void* data = mmap(nullptr, static_cast<usize>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+			if (data != MAP_FAILED)
+			{
+				madvise(data, static_cast<usize>(status.st_size), MADV_SEQUENTIAL);
+				m_Data = static_cast<const u8*>(data);
+				m_Size = static_cast<usize>(status.st_size);
+			}
+		}
+
+		// the mapping keeps its own reference to the file
+		close(file);
+	}
+
+	void MappedFile::Close() noexcept
+	{
+		if (m_Data)
+			munmap(const_cast<u8*>(m_Data), m_Size);
+
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+#endif
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept :
+		m_Data(std::exchange(other.m_Data, nullptr)), m_Size(std::exchange(other.m_Size, 0))
+#ifdef _WIN32
+		, m_File(std::exchange(other.m_File, nullptr)), m_Mapping(std::exchange(other.m_Mapping, nullptr))
+#endif
+	{
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+
+			m_Data = std::exchange(other.m_Data, nullptr);
+			m_Size = std::exchange(other.m_Size, 0);
+#ifdef _WIN32
+			m_File = std::exchange(other.m_File, nullptr);
+			m_Mapping = std::exchange(other.m_Mapping, nullptr);
+#endif
+		}
+
+		return *this;
+	}
+}
\ No newline at end of file
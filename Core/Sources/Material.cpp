@@ -1,18 +1,30 @@
 #include "Material.h"
 
+#include <spanstream>
+
+#include "VirtualFileSystem.h"
+
 
 namespace Core
 {
 	void Material::LoadFromFile(const std::filesystem::path& path)
 	{
-		std::ifstream file(path);
+		Decode(path);
+	}
+
+	bool Material::Decode(const std::filesystem::path& path)
+	{
+		VirtualFile source = VirtualFileSystem::Get().Open(path);
 
-		if (!file.is_open())
+		if (!source.IsOpen())
 		{
 			LOG_ERROR("Couldn't find the .mtl file: {}", path.string());
-			return;
+			return false;
 		}
 
+		std::span<const u8> data = source.GetData();
+		std::ispanstream file(std::span<const char>(reinterpret_cast<const char*>(data.data()), data.size()));
+
 		Ambient = glm::vec3(0.2f);
 		Diffuse = glm::vec3(0.8f);
 		Specular = glm::vec3(1.0f);
@@ -55,6 +67,6 @@ namespace Core
 			}
 		}
 
-		file.close();
+		return true;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "MemoryResource.h"
+
+namespace Core
+{
+	AllocationStats CountingResource::GetStats() const noexcept
+	{
+		AllocationStats stats;
+		stats.Allocations = m_Allocations.load(std::memory_order_relaxed);
+		stats.Deallocations = m_Deallocations.load(std::memory_order_relaxed);
+		stats.BytesInUse = m_BytesInUse.load(std::memory_order_relaxed);
+		stats.PeakBytesInUse = m_PeakBytesInUse.load(std::memory_order_relaxed);
+
+		return stats;
+	}
+
+	void* CountingResource::do_allocate(usize bytes, usize alignment)
+	{
+		void* ptr = m_Upstream->allocate(bytes, alignment);
+
+		m_Allocations.fetch_add(1, std::memory_order_relaxed);
+		u64 inUse = m_BytesInUse.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+		u64 peak = m_PeakBytesInUse.load(std::memory_order_relaxed);
+		while (inUse > peak && !m_PeakBytesInUse.compare_exchange_weak(peak, inUse, std::memory_order_relaxed));
+
+		return ptr;
+	}
+
+	void CountingResource::do_deallocate(void* ptr, usize bytes, usize alignment)
+	{
+		m_Upstream->deallocate(ptr, bytes, alignment);
+
+		m_Deallocations.fetch_add(1, std::memory_order_relaxed);
+		m_BytesInUse.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+}
\ No newline at end of file
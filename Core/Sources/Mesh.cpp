@@ -1,58 +1,232 @@
 #include "Mesh.h"
 
+#include <algorithm>
+
+#include "VirtualFileSystem.h"
+#include "ObjImporter.h"
+#include "MeshOptimizer.h"
+
 namespace Core
 {
-	Mesh::Mesh(const MeshBuffers& meshBuffers) :
-		m_VertexBuffer(meshBuffers.VertexBuffer),
-		m_IndexBuffer(meshBuffers.IndexBuffer),
-		m_Vertices(meshBuffers.Vertices),
-		m_Indices(meshBuffers.Indices)
+	Mesh::Mesh(std::vector<Vertex> vertices, std::vector<u32> indices) :
+		m_Vertices(std::move(vertices)),
+		m_Indices(std::move(indices)),
+		m_LODs({ { 0, static_cast<u32>(m_Indices.size()), 0.0f } }),
+		m_Bounds(MeshCache::ComputeBounds(m_Vertices))
 	{
-
+		Upload();
 	}
 
 	Mesh::~Mesh()
 	{
-		Destroy(Core::Application::Get().GetVmaAllocator());
+		Destroy();
 	}
 
 	void Mesh::LoadFromFile(const std::filesystem::path& path)
 	{
-		objl::Loader loader;
-		loader.LoadFile(path.string());
+		if (Decode(path))
+			Upload();
+	}
+
+	bool Mesh::Decode(const std::filesystem::path& path)
+	{
+		VirtualFile file = VirtualFileSystem::Get().Open(path);
+
+		if (!file.IsOpen())
+		{
+			LOG_ERROR("Couldn't load the mesh: {}", path.string());
+			return false;
+		}
+
+		u64 sourceHash = file.GetContentHash();
+
+		if (MeshCache::Load(sourceHash, m_Vertices, m_Indices, m_LODs, m_Meshlets, m_Bounds))
+			return true;
+
+		std::span<const u8> data = file.GetData();
+
+		if (!ImportObj(std::span<const char>(reinterpret_cast<const char*>(data.data()), data.size()), m_Vertices, m_Indices))
+		{
+			LOG_ERROR("Couldn't load the mesh: {}", path.string());
+			return false;
+		}
+
+		WeldStats weld = WeldVertices(m_Vertices, m_Indices);
+		LOG_INFO("Welded {}: {} -> {} vertices, {} KiB saved", path.filename().string(), weld.VerticesBefore, weld.VerticesAfter, weld.GetSavedBytes() / 1024);
+
+		// runs once per source, the optimized order is what gets cooked
+		VertexCacheStats before = AnalyzeVertexCache(m_Indices, m_Vertices.size());
+
+		OptimizeVertexCache(m_Indices, m_Vertices.size());
+		OptimizeOverdraw(m_Indices, m_Vertices);
+		m_Meshlets = BuildMeshlets(m_Vertices, m_Indices);
+		OptimizeVertexFetch(m_Vertices, m_Indices);
 
-		MeshBuffers meshBuffers = Application::Get().CreateMeshBuffers(loader.LoadedVertices, loader.LoadedIndices);
+		VertexCacheStats after = AnalyzeVertexCache(m_Indices, m_Vertices.size());
+		LOG_INFO("Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {} meshlets", path.filename().string(), before.ACMR, after.ACMR,
+			before.ATVR, after.ATVR, m_Meshlets.size());
 
-		m_VertexBuffer = meshBuffers.VertexBuffer;
-		m_IndexBuffer = meshBuffers.IndexBuffer;
-		m_Vertices = meshBuffers.Vertices;
-		m_Indices = meshBuffers.Indices;
+		// the coarser levels index the same vertices, so the fetch order above is tuned for level 0 only
+		m_LODs = BuildLODChain(m_Vertices, m_Indices);
+
+		for (usize i = 1; i < m_LODs.size(); i++)
+			LOG_INFO("LOD {} of {}: {} triangles, error {:.4f}", i, path.filename().string(), m_LODs[i].IndexCount / 3, m_LODs[i].Error);
+
+		m_Bounds = MeshCache::ComputeBounds(m_Vertices);
+
+		if (!MeshCache::Store(sourceHash, m_Vertices, m_Indices, m_LODs, m_Meshlets, m_Bounds))
+			LOG_WARN("Couldn't cache the mesh: {}", path.string());
+
+		return true;
 	}
 
-	void Mesh::Destroy(VmaAllocator allocator)
+	void Mesh::Upload()
 	{
-		if (m_VertexBuffer.Buffer != VK_NULL_HANDLE)
+		m_VertexFormat = s_DefaultVertexFormat;
+		m_IndexType = m_Vertices.size() <= std::numeric_limits<u16>::max() ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+		std::vector<PackedVertex> packedVertices;
+		std::span<const u8> vertexData(reinterpret_cast<const u8*>(m_Vertices.data()), m_Vertices.size() * sizeof(Vertex));
+
+		if (m_VertexFormat == VertexFormat::Packed)
 		{
-			vmaDestroyBuffer(allocator, m_VertexBuffer.Buffer, m_VertexBuffer.Allocation);
-			m_VertexBuffer.Buffer = VK_NULL_HANDLE;
+			packedVertices = PackVertices(m_Vertices, m_Bounds);
+			vertexData = std::span<const u8>(reinterpret_cast<const u8*>(packedVertices.data()), packedVertices.size() * sizeof(PackedVertex));
 		}
 
-		if (m_IndexBuffer.Buffer != VK_NULL_HANDLE)
+		m_DequantizationMatrix = m_VertexFormat == VertexFormat::Packed ? Core::GetDequantizationMatrix(m_Bounds) : glm::mat4(1.0f);
+
+		std::vector<u16> shortIndices;
+		std::span<const u8> indexData(reinterpret_cast<const u8*>(m_Indices.data()), m_Indices.size() * sizeof(u32));
+
+		if (m_IndexType == VK_INDEX_TYPE_UINT16)
 		{
-			vmaDestroyBuffer(allocator, m_IndexBuffer.Buffer, m_IndexBuffer.Allocation);
-			m_IndexBuffer.Buffer = VK_NULL_HANDLE;
+			shortIndices.assign(m_Indices.begin(), m_Indices.end());
+			indexData = std::span<const u8>(reinterpret_cast<const u8*>(shortIndices.data()), shortIndices.size() * sizeof(u16));
 		}
 
+		u32 vertexStride = m_VertexFormat == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+
+		Application::Get().FreeGeometry(m_Geometry);
+		m_Geometry = Application::Get().AllocateGeometry(vertexData, vertexStride, indexData, m_IndexType);
+		m_GPUBytes = vertexData.size() + indexData.size();
+	}
+
+	void Mesh::Destroy()
+	{
+		if (m_Geometry.IsValid())
+			Application::Get().FreeGeometry(m_Geometry);
+
 		m_Vertices.clear();
 		m_Indices.clear();
+		m_LODs.clear();
+		m_Meshlets.clear();
+		m_GPUBytes = 0;
+	}
+
+	void Mesh::Release()
+	{
+		Destroy();
+
+		m_Vertices.shrink_to_fit();
+		m_Indices.shrink_to_fit();
+		m_LODs.shrink_to_fit();
+		m_Meshlets.shrink_to_fit();
 	}
-	void Mesh::Draw(VkCommandBuffer commandBuffer) const
+
+	usize Mesh::GetCPUMemoryUsage() const noexcept
+	{
+		return m_Vertices.capacity() * sizeof(Vertex) + m_Indices.capacity() * sizeof(u32) + m_LODs.capacity() * sizeof(MeshLOD) +
+			m_Meshlets.capacity() * sizeof(Meshlet);
+	}
+
+	usize Mesh::GetGPUMemoryUsage() const noexcept
+	{
+		return m_GPUBytes;
+	}
+
+	u32 Mesh::SelectLOD(f32 pixelsPerUnit, u32 currentLOD) const noexcept
+	{
+		if (m_LODs.empty())
+			return 0;
+
+		u32 lod = std::min(currentLOD, static_cast<u32>(m_LODs.size() - 1));
+
+		while (lod > 0 && m_LODs[lod].Error * pixelsPerUnit > MaxLODPixelError)
+			lod--;
+
+		while (lod + 1 < m_LODs.size() && m_LODs[lod + 1].Error * pixelsPerUnit * LODHysteresis <= MaxLODPixelError)
+			lod++;
+
+		return lod;
+	}
+
+	u32 Mesh::CullMeshlets(const glm::mat4& clipFromMesh, const glm::vec3& cameraPosition, bool coneCulling,
+		std::vector<VkDrawIndexedIndirectCommand>& commands) const
+	{
+		// frustum planes in mesh space (Gribb and Hartmann), depth is [0, w]
+		const glm::mat4 rows = glm::transpose(clipFromMesh);
+		const std::array<glm::vec4, 6> planes = {
+			rows[3] + rows[0], rows[3] - rows[0],
+			rows[3] + rows[1], rows[3] - rows[1],
+			rows[2], rows[3] - rows[2]
+		};
+
+		std::array<f32, 6> planeLengths;
+
+		for (usize i = 0; i < planes.size(); i++)
+			planeLengths[i] = glm::length(glm::vec3(planes[i]));
+
+		usize firstCommand = commands.size();
+		u32 visible = 0;
+
+		for (const Meshlet& meshlet : m_Meshlets)
+		{
+			bool inside = true;
+
+			for (usize i = 0; i < planes.size() && inside; i++)
+				inside = glm::dot(glm::vec3(planes[i]), meshlet.Center) + planes[i].w >= -meshlet.Radius * planeLengths[i];
+
+			if (!inside)
+				continue;
+
+			if (coneCulling && glm::dot(glm::normalize(meshlet.ConeApex - cameraPosition), meshlet.ConeAxis) > meshlet.ConeCutoff)
+				continue;
+
+			visible++;
+
+			// meshlets are stored back to back, neighbours that both pass become one draw
+			u32 firstIndex = m_Geometry.FirstIndex + meshlet.FirstIndex;
+
+			if (commands.size() > firstCommand && commands.back().firstIndex + commands.back().indexCount == firstIndex)
+			{
+				commands.back().indexCount += meshlet.IndexCount;
+				continue;
+			}
+
+			commands.push_back({ meshlet.IndexCount, 1, firstIndex, m_Geometry.VertexOffset, 0 });
+		}
+
+		return visible;
+	}
+
+	void Mesh::DrawIndirect(VkCommandBuffer commandBuffer, std::span<const VkDrawIndexedIndirectCommand> commands) const
+	{
+		if (commands.empty())
+			return;
+
+		Application::Get().BindGeometryBuffers(m_IndexType);
+		Application::Get().DrawIndexedIndirect(commands);
+	}
+
+	void Mesh::Draw(VkCommandBuffer commandBuffer, u32 lod) const
 	{
-		VkDeviceSize offset = 0;
+		if (m_LODs.empty())
+			return;
 
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_VertexBuffer.Buffer, &offset);
-		vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer.Buffer, 0, VK_INDEX_TYPE_UINT32);
+		const MeshLOD& level = m_LODs[std::min(lod, static_cast<u32>(m_LODs.size() - 1))];
 
-		vkCmdDrawIndexed(commandBuffer, m_Indices.size(), 1, 0, 0, 0);
+		Application::Get().BindGeometryBuffers(m_IndexType);
+		vkCmdDrawIndexed(commandBuffer, level.IndexCount, 1, m_Geometry.FirstIndex + level.FirstIndex, m_Geometry.VertexOffset, 0);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "MeshCache.h"
+
+#include <fstream>
+#include <format>
+#include <cstring>
+#include <thread>
+#include <limits>
+#include <type_traits>
+
+#include "MappedFile.h"
+#include "Log.h"
+
+namespace Core
+{
+	static_assert(std::is_trivially_copyable_v<Vertex>, "Vertices are written to the cache as raw bytes.");
+
+	namespace
+	{
+		std::filesystem::path& Directory()
+		{
+			static std::filesystem::path directory = []()
+			{
+				std::error_code error;
+				std::filesystem::path temp = std::filesystem::temp_directory_path(error);
+				return (error ? std::filesystem::path() : temp) / "VkGameEngine" / "MeshCache";
+			}();
+
+			return directory;
+		}
+
+		constexpr u64 AlignOffset(u64 offset) noexcept
+		{
+			return (offset + MeshCache::BlobAlignment - 1) & ~static_cast<u64>(MeshCache::BlobAlignment - 1);
+		}
+	}
+
+	void MeshCache::SetDirectory(const std::filesystem::path& directory)
+	{
+		Directory() = directory;
+	}
+
+	const std::filesystem::path& MeshCache::GetDirectory()
+	{
+		return Directory();
+	}
+
+	bool MeshCache::Load(u64 sourceHash, std::vector<Vertex>& vertices, std::vector<u32>& indices, std::vector<MeshLOD>& lods,
+		std::vector<Meshlet>& meshlets, MeshBounds& bounds)
+	{
+		MappedFile file(GetCachePath(sourceHash));
+
+		if (!file.IsOpen() || file.GetSize() < sizeof(MeshCacheHeader))
+			return false;
+
+		const u8* data = file.GetData().data();
+
+		MeshCacheHeader header = {};
+		std::memcpy(&header, data, sizeof(header));
+
+		if (header.Magic != Magic || header.ImporterVersion != ImporterVersion || header.SourceHash != sourceHash ||
+			header.VertexStride != sizeof(Vertex) || header.IndexStride != sizeof(u32))
+			return false;
+
+		u64 vertexBytes = static_cast<u64>(header.VertexCount) * sizeof(Vertex);
+		u64 indexBytes = static_cast<u64>(header.IndexCount) * sizeof(u32);
+		u64 lodBytes = static_cast<u64>(header.LODCount) * sizeof(MeshLOD);
+		u64 meshletBytes = static_cast<u64>(header.MeshletCount) * sizeof(Meshlet);
+
+		if (header.VertexOffset + vertexBytes > file.GetSize() || header.IndexOffset + indexBytes > file.GetSize() ||
+			header.LODOffset + lodBytes > file.GetSize() || header.MeshletOffset + meshletBytes > file.GetSize())
+		{
+			LOG_WARN("Truncated mesh cache file: {}", GetCachePath(sourceHash).string());
+			return false;
+		}
+
+		vertices.resize(header.VertexCount);
+		indices.resize(header.IndexCount);
+		lods.resize(header.LODCount);
+		meshlets.resize(header.MeshletCount);
+
+		std::memcpy(vertices.data(), data + header.VertexOffset, vertexBytes);
+		std::memcpy(indices.data(), data + header.IndexOffset, indexBytes);
+		std::memcpy(lods.data(), data + header.LODOffset, lodBytes);
+		std::memcpy(meshlets.data(), data + header.MeshletOffset, meshletBytes);
+
+		for (const MeshLOD& lod : lods)
+		{
+			if (static_cast<u64>(lod.FirstIndex) + lod.IndexCount > indices.size())
+			{
+				LOG_WARN("Corrupt mesh cache file: {}", GetCachePath(sourceHash).string());
+				return false;
+			}
+		}
+
+		for (const Meshlet& meshlet : meshlets)
+		{
+			if (static_cast<u64>(meshlet.FirstIndex) + meshlet.IndexCount > indices.size())
+			{
+				LOG_WARN("Corrupt mesh cache file: {}", GetCachePath(sourceHash).string());
+				return false;
+			}
+		}
+
+		bounds = header.Bounds;
+
+		return true;
+	}
+
+	bool MeshCache::Store(u64 sourceHash, std::span<const Vertex> vertices, std::span<const u32> indices, std::span<const MeshLOD> lods,
+		std::span<const Meshlet> meshlets, const MeshBounds& bounds)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(Directory(), error);
+
+		MeshCacheHeader header = {};
+		header.Magic = Magic;
+		header.ImporterVersion = ImporterVersion;
+		header.SourceHash = sourceHash;
+		header.VertexCount = static_cast<u32>(vertices.size());
+		header.VertexStride = sizeof(Vertex);
+		header.IndexCount = static_cast<u32>(indices.size());
+		header.IndexStride = sizeof(u32);
+		header.VertexOffset = AlignOffset(sizeof(MeshCacheHeader));
+		header.IndexOffset = AlignOffset(header.VertexOffset + vertices.size_bytes());
+		header.LODCount = static_cast<u32>(lods.size());
+		header.LODOffset = AlignOffset(header.IndexOffset + indices.size_bytes());
+		header.MeshletCount = static_cast<u32>(meshlets.size());
+		header.MeshletOffset = AlignOffset(header.LODOffset + lods.size_bytes());
+		header.Bounds = bounds;
+
+		std::filesystem::path cachePath = GetCachePath(sourceHash);
+
+		// written next to the final file and renamed, so a reader never maps a half written cache
+		std::filesystem::path tempPath = cachePath;
+		tempPath += std::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+			if (!file)
+			{
+				LOG_WARN("Couldn't write the mesh cache file: {}", tempPath.string());
+				return false;
+			}
+
+			const char padding[BlobAlignment] = {};
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(padding, static_cast<std::streamsize>(header.VertexOffset - sizeof(header)));
+			file.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertices.size_bytes()));
+			file.write(padding, static_cast<std::streamsize>(header.IndexOffset - header.VertexOffset - vertices.size_bytes()));
+			file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indices.size_bytes()));
+			file.write(padding, static_cast<std::streamsize>(header.LODOffset - header.IndexOffset - indices.size_bytes()));
+			file.write(reinterpret_cast<const char*>(lods.data()), static_cast<std::streamsize>(lods.size_bytes()));
+			file.write(padding, static_cast<std::streamsize>(header.MeshletOffset - header.LODOffset - lods.size_bytes()));
+			file.write(reinterpret_cast<const char*>(meshlets.data()), static_cast<std::streamsize>(meshlets.size_bytes()));
+
+			if (!file)
+			{
+				LOG_WARN("Couldn't write the mesh cache file: {}", tempPath.string());
+				file.close();
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+		}
+
+		std::filesystem::rename(tempPath, cachePath, error);
+
+		if (error)
+		{
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+
+		return true;
+	}
+
+	MeshBounds MeshCache::ComputeBounds(std::span<const Vertex> vertices) noexcept
+	{
+		if (vertices.empty())
+			return {};
+
+		MeshBounds bounds = { glm::vec3(std::numeric_limits<f32>::max()), glm::vec3(std::numeric_limits<f32>::lowest()) };
+
+		for (const Vertex& vertex : vertices)
+		{
+			const glm::vec3& position = vertex.Position;
+			bounds.Min = glm::min(bounds.Min, position);
+			bounds.Max = glm::max(bounds.Max, position);
+		}
+
+		return bounds;
+	}
+
+	std::filesystem::path MeshCache::GetCachePath(u64 sourceHash)
+	{
+		return Directory() / std::format("{:016x}.vkmesh", sourceHash);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,1134 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Log.h"
+
+namespace Core
+{
+	namespace
+	{
+		constexpr u32 InvalidVertex = std::numeric_limits<u32>::max();
+
+		// Vertex is 8 floats, welding compares and hashes them as 8 words, 64 bit so a small epsilon
+		// far from the origin still quantises without wrapping
+		constexpr usize VertexFloats = sizeof(Vertex) / sizeof(f32);
+		using VertexKey = std::array<i64, VertexFloats>;
+		static_assert(sizeof(Vertex) == VertexFloats * sizeof(f32), "Vertex has padding, welding would compare garbage.");
+
+		// well inside i64, llround past its range is undefined
+		constexpr f64 MaxQuantised = 4611686018427387904.0;
+
+		VertexKey MakeKey(const Vertex& vertex, f32 inverseEpsilon) noexcept
+		{
+			std::array<f32, VertexFloats> values;
+			std::memcpy(values.data(), &vertex, sizeof(Vertex));
+
+			VertexKey key;
+
+			for (usize i = 0; i < VertexFloats; i++)
+			{
+				if (inverseEpsilon == 0.0f)
+					key[i] = std::bit_cast<u32>(values[i]);
+				else if (std::isnan(values[i]))
+					key[i] = std::numeric_limits<i64>::max();
+				else
+					key[i] = std::llround(std::clamp(static_cast<f64>(values[i]) * inverseEpsilon, -MaxQuantised, MaxQuantised));
+			}
+
+			return key;
+		}
+
+		u64 HashKey(const VertexKey& key) noexcept
+		{
+			u64 hash = 14695981039346656037ull;
+
+			for (i64 word : key)
+			{
+				hash ^= static_cast<u64>(word);
+				hash *= 1099511628211ull;
+			}
+
+			return hash ^ (hash >> 32);
+		}
+
+		// Forsyth's scoring, the last triangle's vertices get a fixed score so the strip doesn't flip direction,
+		// the rest decay with their cache position, vertices with few triangles left get a boost to finish them off
+		constexpr u32 ForsythCacheSize = 32;
+		constexpr u32 ForsythMaxValence = 32;
+
+		struct ForsythTables
+		{
+			std::array<f32, ForsythCacheSize> Cache = {};
+			std::array<f32, ForsythMaxValence> Valence = {};
+
+			ForsythTables()
+			{
+				for (u32 i = 0; i < 3; i++)
+					Cache[i] = 0.75f;
+
+				for (u32 i = 3; i < ForsythCacheSize; i++)
+					Cache[i] = std::pow(1.0f - static_cast<f32>(i - 3) / static_cast<f32>(ForsythCacheSize - 3), 1.5f);
+
+				for (u32 i = 1; i < ForsythMaxValence; i++)
+					Valence[i] = 2.0f / std::sqrt(static_cast<f32>(i));
+			}
+		};
+
+		f32 ForsythScore(const ForsythTables& tables, i32 cachePosition, u32 liveTriangles) noexcept
+		{
+			if (liveTriangles == 0)
+				return -1.0f;
+
+			f32 score = cachePosition >= 0 ? tables.Cache[cachePosition] : 0.0f;
+			return score + tables.Valence[std::min(liveTriangles, ForsythMaxValence - 1)];
+		}
+
+		glm::vec3 ToVec3(const Vertex& vertex) noexcept
+		{
+			return vertex.Position;
+		}
+
+		// symmetric 4x4 error quadric (Garland and Heckbert), Error gives the weighted sum of squared distances
+		// to the accumulated planes, divided by Weight it's the mean squared distance
+		struct Quadric
+		{
+			f64 XX = 0.0, XY = 0.0, XZ = 0.0, XW = 0.0;
+			f64 YY = 0.0, YZ = 0.0, YW = 0.0;
+			f64 ZZ = 0.0, ZW = 0.0;
+			f64 WW = 0.0;
+			f64 Weight = 0.0;
+
+			void AddPlane(const glm::dvec3& normal, f64 distance, f64 weight) noexcept
+			{
+				XX += weight * normal.x * normal.x; XY += weight * normal.x * normal.y; XZ += weight * normal.x * normal.z; XW += weight * normal.x * distance;
+				YY += weight * normal.y * normal.y; YZ += weight * normal.y * normal.z; YW += weight * normal.y * distance;
+				ZZ += weight * normal.z * normal.z; ZW += weight * normal.z * distance;
+				WW += weight * distance * distance;
+				Weight += weight;
+			}
+
+			void Add(const Quadric& other) noexcept
+			{
+				XX += other.XX; XY += other.XY; XZ += other.XZ; XW += other.XW;
+				YY += other.YY; YZ += other.YZ; YW += other.YW;
+				ZZ += other.ZZ; ZW += other.ZW;
+				WW += other.WW;
+				Weight += other.Weight;
+			}
+
+			[[nodiscard]] f64 Error(const glm::dvec3& p) const noexcept
+			{
+				f64 error = XX * p.x * p.x + YY * p.y * p.y + ZZ * p.z * p.z +
+					2.0 * (XY * p.x * p.y + XZ * p.x * p.z + YZ * p.y * p.z + XW * p.x + YW * p.y + ZW * p.z) + WW;
+
+				return Weight > 0.0 ? std::max(error, 0.0) / Weight : 0.0;
+			}
+		};
+
+		struct Collapse
+		{
+			f64 Cost = 0.0;
+			u32 From = 0;
+			u32 To = 0;
+		};
+
+		// boundary edges get a plane through them perpendicular to their triangle so open borders hold their shape
+		constexpr f64 BoundaryWeight = 4.0;
+
+		// gives vertices that share a position the same id, simplification moves positions and carries every
+		// vertex at a position along, so uv and normal seams don't stop collapses
+		u32 BuildPositionIDs(const std::vector<Vertex>& vertices, std::vector<u32>& positionIDs, std::vector<u32>& firstVertex)
+		{
+			usize capacity = std::bit_ceil(std::max<usize>(vertices.size() * 2, 16));
+			std::vector<u32> table(capacity, InvalidVertex);
+
+			positionIDs.resize(vertices.size());
+			firstVertex.clear();
+
+			auto samePosition = [&](u32 a, u32 b) {
+				return std::memcmp(&vertices[a].Position, &vertices[b].Position, sizeof(glm::vec3)) == 0;
+			};
+
+			for (usize i = 0; i < vertices.size(); i++)
+			{
+				std::array<u32, 3> words;
+				std::memcpy(words.data(), &vertices[i].Position, sizeof(words));
+
+				u64 hash = 14695981039346656037ull;
+
+				for (u32 word : words)
+				{
+					hash ^= word;
+					hash *= 1099511628211ull;
+				}
+
+				usize slot = (hash ^ (hash >> 32)) & (capacity - 1);
+
+				while (table[slot] != InvalidVertex && !samePosition(firstVertex[table[slot]], static_cast<u32>(i)))
+					slot = (slot + 1) & (capacity - 1);
+
+				if (table[slot] == InvalidVertex)
+				{
+					table[slot] = static_cast<u32>(firstVertex.size());
+					firstVertex.push_back(static_cast<u32>(i));
+				}
+
+				positionIDs[i] = table[slot];
+			}
+
+			return static_cast<u32>(firstVertex.size());
+		}
+
+		u32 Resolve(std::vector<u32>& collapsedTo, u32 position) noexcept
+		{
+			while (collapsedTo[position] != position)
+			{
+				collapsedTo[position] = collapsedTo[collapsedTo[position]];
+				position = collapsedTo[position];
+			}
+
+			return position;
+		}
+
+		i16 PackSnorm16(f32 value) noexcept
+		{
+			return static_cast<i16>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+		}
+
+		// projects the normal onto the octahedron |x| + |y| + |z| = 1 and folds the lower half over the upper one,
+		// object_packed.vert undoes it, a zero normal comes back as +z
+		void PackOctahedral(const glm::vec3& normal, i16 (&packed)[2]) noexcept
+		{
+			f32 length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+
+			if (length == 0.0f)
+			{
+				packed[0] = packed[1] = 0;
+				return;
+			}
+
+			f32 x = normal.x / length;
+			f32 y = normal.y / length;
+
+			if (normal.z < 0.0f)
+			{
+				f32 foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+				f32 foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+				x = foldedX;
+				y = foldedY;
+			}
+
+			packed[0] = PackSnorm16(x);
+			packed[1] = PackSnorm16(y);
+		}
+	}
+
+	WeldStats WeldVertices(std::vector<Vertex>& vertices, std::vector<u32>& indices, f32 epsilon)
+	{
+		WeldStats stats;
+		stats.VerticesBefore = vertices.size();
+
+		f32 inverseEpsilon = epsilon > 0.0f ? 1.0f / epsilon : 0.0f;
+
+		// open addressing with linear probing, at most half full
+		usize capacity = std::bit_ceil(std::max<usize>(vertices.size() * 2, 16));
+		std::vector<u32> table(capacity, InvalidVertex);
+
+		std::vector<VertexKey> uniqueKeys;
+		std::vector<Vertex> unique;
+		std::vector<u32> remap(vertices.size());
+
+		uniqueKeys.reserve(vertices.size());
+		unique.reserve(vertices.size());
+
+		for (usize i = 0; i < vertices.size(); i++)
+		{
+			VertexKey key = MakeKey(vertices[i], inverseEpsilon);
+			usize slot = HashKey(key) & (capacity - 1);
+
+			while (table[slot] != InvalidVertex && uniqueKeys[table[slot]] != key)
+				slot = (slot + 1) & (capacity - 1);
+
+			if (table[slot] == InvalidVertex)
+			{
+				table[slot] = static_cast<u32>(unique.size());
+				uniqueKeys.push_back(key);
+				unique.push_back(vertices[i]);
+			}
+
+			remap[i] = table[slot];
+		}
+
+		for (u32& index : indices)
+			index = remap[index];
+
+		vertices = std::move(unique);
+		vertices.shrink_to_fit();
+
+		stats.VerticesAfter = vertices.size();
+		return stats;
+	}
+
+	VertexCacheStats AnalyzeVertexCache(const std::vector<u32>& indices, usize vertexCount, u32 cacheSize)
+	{
+		VertexCacheStats stats;
+
+		if (indices.empty() || vertexCount == 0)
+			return stats;
+
+		// a vertex is in the fifo while fewer than cacheSize misses happened since it was loaded
+		std::vector<u64> loadedAt(vertexCount, 0);
+		u64 misses = 0;
+
+		for (u32 index : indices)
+		{
+			if (loadedAt[index] == 0 || misses - loadedAt[index] >= cacheSize)
+				loadedAt[index] = ++misses;
+		}
+
+		stats.ACMR = static_cast<f32>(misses) / static_cast<f32>(indices.size() / 3);
+		stats.ATVR = static_cast<f32>(misses) / static_cast<f32>(vertexCount);
+		return stats;
+	}
+
+	void OptimizeVertexCache(std::vector<u32>& indices, usize vertexCount)
+	{
+		static const ForsythTables tables;
+
+		usize triangleCount = indices.size() / 3;
+
+		if (triangleCount == 0)
+			return;
+
+		// triangles of every vertex, live ones are kept at the front of each vertex's range
+		std::vector<u32> liveTriangles(vertexCount, 0);
+		std::vector<u32> adjacencyOffsets(vertexCount + 1, 0);
+		std::vector<u32> adjacency(indices.size());
+
+		for (u32 index : indices)
+			liveTriangles[index]++;
+
+		for (usize i = 0; i < vertexCount; i++)
+			adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriangles[i];
+
+		{
+			std::vector<u32> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+			for (usize i = 0; i < indices.size(); i++)
+				adjacency[cursor[indices[i]]++] = static_cast<u32>(i / 3);
+		}
+
+		std::vector<i32> cachePositions(vertexCount, -1);
+		std::vector<f32> vertexScores(vertexCount);
+
+		for (usize i = 0; i < vertexCount; i++)
+			vertexScores[i] = ForsythScore(tables, -1, liveTriangles[i]);
+
+		auto triangleScore = [&](usize t) {
+			return vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+		};
+
+		std::vector<bool> emitted(triangleCount, false);
+
+		u32 bestTriangle = 0;
+		f32 bestScore = triangleScore(0);
+
+		for (usize t = 1; t < triangleCount; t++)
+		{
+			f32 score = triangleScore(t);
+
+			if (score > bestScore)
+			{
+				bestScore = score;
+				bestTriangle = static_cast<u32>(t);
+			}
+		}
+
+		// 3 extra entries so the vertices pushed out by a triangle are still around to be rescored
+		std::vector<u32> cache, nextCache;
+		cache.reserve(ForsythCacheSize + 3);
+		nextCache.reserve(ForsythCacheSize + 3);
+
+		std::vector<u32> output;
+		output.reserve(indices.size());
+
+		usize scanCursor = 0;
+
+		while (output.size() < indices.size())
+		{
+			// nothing in the cache has triangles left, continue with the next unemitted one in input order
+			if (bestTriangle == InvalidVertex)
+			{
+				while (emitted[scanCursor])
+					scanCursor++;
+
+				bestTriangle = static_cast<u32>(scanCursor);
+			}
+
+			emitted[bestTriangle] = true;
+			const u32* triangle = &indices[bestTriangle * 3];
+
+			nextCache.clear();
+
+			for (u32 k = 0; k < 3; k++)
+			{
+				u32 vertex = triangle[k];
+				output.push_back(vertex);
+				nextCache.push_back(vertex);
+
+				u32* begin = &adjacency[adjacencyOffsets[vertex]];
+				u32* end = begin + liveTriangles[vertex];
+				*std::find(begin, end, bestTriangle) = *(end - 1);
+				liveTriangles[vertex]--;
+			}
+
+			for (u32 vertex : cache)
+			{
+				if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+					nextCache.push_back(vertex);
+			}
+
+			std::swap(cache, nextCache);
+
+			for (usize i = 0; i < cache.size(); i++)
+			{
+				u32 vertex = cache[i];
+				cachePositions[vertex] = i < ForsythCacheSize ? static_cast<i32>(i) : -1;
+				vertexScores[vertex] = ForsythScore(tables, cachePositions[vertex], liveTriangles[vertex]);
+			}
+
+			if (cache.size() > ForsythCacheSize)
+				cache.resize(ForsythCacheSize);
+
+			// only triangles touching the cache changed score, the best of them is the next one
+			bestTriangle = InvalidVertex;
+			bestScore = -1.0f;
+
+			for (u32 vertex : cache)
+			{
+				for (u32 i = 0; i < liveTriangles[vertex]; i++)
+				{
+					u32 t = adjacency[adjacencyOffsets[vertex] + i];
+					f32 score = triangleScore(t);
+
+					if (score > bestScore)
+					{
+						bestScore = score;
+						bestTriangle = t;
+					}
+				}
+			}
+		}
+
+		indices = std::move(output);
+	}
+
+	void OptimizeOverdraw(std::vector<u32>& indices, const std::vector<Vertex>& vertices, f32 threshold)
+	{
+		constexpr u32 CacheSize = 16;
+
+		usize triangleCount = indices.size() / 3;
+
+		if (triangleCount == 0)
+			return;
+
+		// replay the fifo with a cold cache at every cluster start, the same cost the reordered clusters will pay,
+		// next to the unsplit order, a split is only taken while the misses so far including that restart stay within
+		// threshold of the unsplit order's over the same triangles, so a cheap start can't pay for splits in a costly end
+		std::vector<usize> clusterStarts;
+		std::vector<u64> loadedAt(vertices.size(), 0);
+		std::vector<u64> unsplitLoadedAt(vertices.size(), 0);
+		u64 misses = 0;
+		u64 totalMisses = 0;
+		u64 unsplitMisses = 0;
+
+		for (usize t = 0; t < triangleCount; t++)
+		{
+			u32 triangleMisses = 0;
+
+			for (u32 k = 0; k < 3; k++)
+			{
+				u32 index = indices[t * 3 + k];
+
+				if (loadedAt[index] == 0 || misses - loadedAt[index] >= CacheSize)
+				{
+					loadedAt[index] = ++misses;
+					triangleMisses++;
+				}
+
+				if (unsplitLoadedAt[index] == 0 || unsplitMisses - unsplitLoadedAt[index] >= CacheSize)
+					unsplitLoadedAt[index] = ++unsplitMisses;
+			}
+
+			// the split makes this triangle miss on all three vertices, free where the cache restarts cold anyway
+			bool withinBudget = static_cast<f32>(totalMisses + 3) <= static_cast<f32>(unsplitMisses) * threshold;
+
+			if (t == 0 || withinBudget)
+			{
+				clusterStarts.push_back(t);
+
+				// the cluster may be drawn after any other, so its first triangle has to count as cold
+				misses += CacheSize;
+
+				for (u32 k = 0; k < 3; k++)
+					loadedAt[indices[t * 3 + k]] = ++misses;
+
+				triangleMisses = 3;
+			}
+
+			totalMisses += triangleMisses;
+		}
+
+		// the reloads a split causes further on aren't known when it's taken, the order stays if they added up past threshold
+		if (static_cast<f32>(totalMisses) > static_cast<f32>(unsplitMisses) * threshold)
+			return;
+
+		clusterStarts.push_back(triangleCount);
+
+		glm::vec3 meshCentroid(0.0f);
+		f32 meshArea = 0.0f;
+
+		struct Cluster
+		{
+			usize Begin = 0;
+			usize End = 0;
+			glm::vec3 Centroid = glm::vec3(0.0f);
+			glm::vec3 Normal = glm::vec3(0.0f);
+			f32 SortKey = 0.0f;
+		};
+
+		std::vector<Cluster> clusters(clusterStarts.size() - 1);
+
+		for (usize c = 0; c < clusters.size(); c++)
+		{
+			Cluster& cluster = clusters[c];
+			cluster.Begin = clusterStarts[c];
+			cluster.End = clusterStarts[c + 1];
+
+			f32 area = 0.0f;
+
+			for (usize t = cluster.Begin; t < cluster.End; t++)
+			{
+				glm::vec3 p0 = ToVec3(vertices[indices[t * 3]]);
+				glm::vec3 p1 = ToVec3(vertices[indices[t * 3 + 1]]);
+				glm::vec3 p2 = ToVec3(vertices[indices[t * 3 + 2]]);
+
+				// the cross product's length is twice the area, so summing it weights the normal by area
+				glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				f32 triangleArea = glm::length(normal);
+
+				cluster.Normal += normal;
+				cluster.Centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+				area += triangleArea;
+			}
+
+			meshCentroid += cluster.Centroid;
+			meshArea += area;
+
+			if (area > 0.0f)
+				cluster.Centroid /= area;
+
+			f32 normalLength = glm::length(cluster.Normal);
+
+			if (normalLength > 0.0f)
+				cluster.Normal /= normalLength;
+		}
+
+		if (meshArea > 0.0f)
+			meshCentroid /= meshArea;
+
+		// clusters far out along their own normal are likely to occlude the ones behind them
+		for (Cluster& cluster : clusters)
+			cluster.SortKey = glm::dot(cluster.Centroid - meshCentroid, cluster.Normal);
+
+		std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.SortKey > b.SortKey; });
+
+		std::vector<u32> output;
+		output.reserve(indices.size());
+
+		for (const Cluster& cluster : clusters)
+			output.insert(output.end(), indices.begin() + cluster.Begin * 3, indices.begin() + cluster.End * 3);
+
+		indices = std::move(output);
+	}
+
+	void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<u32>& indices)
+	{
+		std::vector<u32> remap(vertices.size(), InvalidVertex);
+		std::vector<Vertex> ordered;
+		ordered.reserve(vertices.size());
+
+		for (u32& index : indices)
+		{
+			if (remap[index] == InvalidVertex)
+			{
+				remap[index] = static_cast<u32>(ordered.size());
+				ordered.push_back(vertices[index]);
+			}
+
+			index = remap[index];
+		}
+
+		vertices = std::move(ordered);
+		vertices.shrink_to_fit();
+	}
+
+	std::vector<Meshlet> BuildMeshlets(const std::vector<Vertex>& vertices, std::span<u32> indices, u32 maxVertices, u32 maxTriangles)
+	{
+		ASSERT(maxVertices >= 3 && maxTriangles >= 1);
+
+		usize triangleCount = indices.size() / 3;
+
+		std::vector<u32> adjacencyOffsets(vertices.size() + 1, 0);
+		std::vector<u32> adjacency(triangleCount * 3);
+
+		for (usize i = 0; i < triangleCount * 3; i++)
+			adjacencyOffsets[indices[i] + 1]++;
+
+		for (usize v = 0; v < vertices.size(); v++)
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+
+		{
+			std::vector<u32> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+			for (usize i = 0; i < triangleCount * 3; i++)
+				adjacency[cursor[indices[i]]++] = static_cast<u32>(i / 3);
+		}
+
+		std::vector<Meshlet> meshlets;
+		std::vector<u32> result;
+		result.reserve(triangleCount * 3);
+
+		std::vector<bool> emitted(triangleCount, false);
+		// which meshlet last used a vertex, so membership checks need no clearing between meshlets
+		std::vector<u32> vertexMeshlet(vertices.size(), InvalidVertex);
+		std::vector<u32> meshletVertices, meshletTriangles;
+		usize scanCursor = 0;
+
+		auto newVertices = [&](u32 triangle) {
+			u32 meshlet = static_cast<u32>(meshlets.size());
+			return (vertexMeshlet[indices[triangle * 3]] != meshlet) + (vertexMeshlet[indices[triangle * 3 + 1]] != meshlet) +
+				(vertexMeshlet[indices[triangle * 3 + 2]] != meshlet);
+		};
+
+		auto flush = [&]() {
+			Meshlet meshlet;
+			meshlet.FirstIndex = static_cast<u32>(result.size());
+			meshlet.IndexCount = static_cast<u32>(meshletTriangles.size() * 3);
+			meshlet.VertexCount = static_cast<u32>(meshletVertices.size());
+
+			glm::vec3 min(std::numeric_limits<f32>::max()), max(std::numeric_limits<f32>::lowest());
+
+			for (u32 vertex : meshletVertices)
+			{
+				min = glm::min(min, ToVec3(vertices[vertex]));
+				max = glm::max(max, ToVec3(vertices[vertex]));
+			}
+
+			meshlet.Center = (min + max) * 0.5f;
+
+			for (u32 vertex : meshletVertices)
+				meshlet.Radius = std::max(meshlet.Radius, glm::length(ToVec3(vertices[vertex]) - meshlet.Center));
+
+			// the cone axis is the average facing, its spread the widest angle any triangle makes with it
+			std::vector<glm::vec3> normals;
+			normals.reserve(meshletTriangles.size());
+			glm::vec3 axis(0.0f);
+
+			for (u32 triangle : meshletTriangles)
+			{
+				glm::vec3 p0 = ToVec3(vertices[indices[triangle * 3]]);
+				glm::vec3 normal = glm::cross(ToVec3(vertices[indices[triangle * 3 + 1]]) - p0, ToVec3(vertices[indices[triangle * 3 + 2]]) - p0);
+				f32 length = glm::length(normal);
+
+				normals.push_back(length > 0.0f ? normal / length : glm::vec3(0.0f));
+				axis += normals.back();
+			}
+
+			f32 axisLength = glm::length(axis);
+			f32 minDot = 1.0f;
+
+			if (axisLength > 0.0f)
+			{
+				axis /= axisLength;
+
+				for (const glm::vec3& normal : normals)
+				{
+					if (normal != glm::vec3(0.0f))
+						minDot = std::min(minDot, glm::dot(axis, normal));
+				}
+			}
+
+			// a cone wider than about 84 degrees culls almost nothing, so it's left disabled
+			if (axisLength > 0.0f && minDot > 0.1f)
+			{
+				// the apex goes behind every triangle's plane along the axis, from there all of them face away together
+				f32 maxT = 0.0f;
+
+				for (usize t = 0; t < meshletTriangles.size(); t++)
+				{
+					if (normals[t] == glm::vec3(0.0f))
+						continue;
+
+					glm::vec3 p0 = ToVec3(vertices[indices[meshletTriangles[t] * 3]]);
+					maxT = std::max(maxT, glm::dot(meshlet.Center - p0, normals[t]) / glm::dot(axis, normals[t]));
+				}
+
+				meshlet.ConeAxis = axis;
+				meshlet.ConeApex = meshlet.Center - axis * maxT;
+				meshlet.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+			}
+			else
+			{
+				meshlet.ConeAxis = axis;
+				meshlet.ConeApex = meshlet.Center;
+				meshlet.ConeCutoff = 1.0f;
+			}
+
+			for (u32 triangle : meshletTriangles)
+				result.insert(result.end(), { indices[triangle * 3], indices[triangle * 3 + 1], indices[triangle * 3 + 2] });
+
+			meshlets.push_back(meshlet);
+			meshletVertices.clear();
+			meshletTriangles.clear();
+		};
+
+		for (usize added = 0; added < triangleCount; added++)
+		{
+			u32 bestTriangle = InvalidVertex;
+			u32 bestScore = 4;
+
+			// the unemitted triangle around the meshlet's vertices that brings in the fewest new ones
+			for (u32 vertex : meshletVertices)
+			{
+				for (u32 i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1] && bestScore > 0; i++)
+				{
+					u32 triangle = adjacency[i];
+
+					if (emitted[triangle])
+						continue;
+
+					u32 score = newVertices(triangle);
+
+					if (score < bestScore || (score == bestScore && triangle < bestTriangle))
+					{
+						bestScore = score;
+						bestTriangle = triangle;
+					}
+				}
+
+				if (bestScore == 0)
+					break;
+			}
+
+			// nothing connected left, continue with the next triangle in input order
+			if (bestTriangle == InvalidVertex)
+			{
+				while (emitted[scanCursor])
+					scanCursor++;
+
+				bestTriangle = static_cast<u32>(scanCursor);
+				bestScore = newVertices(bestTriangle);
+			}
+
+			if (meshletVertices.size() + bestScore > maxVertices || meshletTriangles.size() >= maxTriangles)
+				flush();
+
+			for (u32 k = 0; k < 3; k++)
+			{
+				u32 vertex = indices[bestTriangle * 3 + k];
+
+				if (vertexMeshlet[vertex] != static_cast<u32>(meshlets.size()))
+				{
+					vertexMeshlet[vertex] = static_cast<u32>(meshlets.size());
+					meshletVertices.push_back(vertex);
+				}
+			}
+
+			emitted[bestTriangle] = true;
+			meshletTriangles.push_back(bestTriangle);
+		}
+
+		if (!meshletTriangles.empty())
+			flush();
+
+		std::copy(result.begin(), result.end(), indices.begin());
+
+		return meshlets;
+	}
+
+	std::vector<PackedVertex> PackVertices(const std::vector<Vertex>& vertices, const MeshBounds& bounds)
+	{
+		glm::vec3 extent = bounds.Max - bounds.Min;
+		glm::vec3 inverseExtent = glm::vec3(
+			extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+			extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+			extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+		std::vector<PackedVertex> packed(vertices.size());
+
+		for (usize i = 0; i < vertices.size(); i++)
+		{
+			const Vertex& vertex = vertices[i];
+			PackedVertex& out = packed[i];
+
+			glm::vec3 normalized = glm::clamp((ToVec3(vertex) - bounds.Min) * inverseExtent, 0.0f, 1.0f);
+
+			for (u32 axis = 0; axis < 3; axis++)
+				out.Position[axis] = static_cast<u16>(std::round(normalized[axis] * 65535.0f));
+
+			out.Position[3] = 0;
+
+			PackOctahedral(vertex.Normal, out.Normal);
+
+			out.TextureCoordinate[0] = glm::packHalf1x16(vertex.TextureCoordinate.x);
+			out.TextureCoordinate[1] = glm::packHalf1x16(vertex.TextureCoordinate.y);
+		}
+
+		return packed;
+	}
+
+	glm::mat4 GetDequantizationMatrix(const MeshBounds& bounds)
+	{
+		return glm::scale(glm::translate(glm::mat4(1.0f), bounds.Min), bounds.Max - bounds.Min);
+	}
+
+	std::vector<u32> SimplifyMesh(const std::vector<Vertex>& vertices, const std::vector<u32>& indices, usize targetIndexCount, f32 targetError, f32& resultError)
+	{
+		resultError = 0.0f;
+
+		std::vector<u32> positionIDs, firstVertex;
+		u32 positionCount = BuildPositionIDs(vertices, positionIDs, firstVertex);
+
+		// errors are measured in a space where the mesh's largest extent is 1, so targetError is relative to the mesh size
+		MeshBounds bounds = MeshCache::ComputeBounds(vertices);
+		glm::vec3 extent = bounds.Max - bounds.Min;
+		f64 scale = std::max({ extent.x, extent.y, extent.z, std::numeric_limits<f32>::min() });
+
+		std::vector<glm::dvec3> positions(positionCount);
+
+		for (u32 p = 0; p < positionCount; p++)
+			positions[p] = (glm::dvec3(ToVec3(vertices[firstVertex[p]])) - glm::dvec3(bounds.Min)) / scale;
+
+		// triangles in position space, degenerate ones can't be drawn and are dropped right away
+		std::vector<u32> triangles;
+		triangles.reserve(indices.size());
+
+		for (usize i = 0; i + 2 < indices.size(); i += 3)
+		{
+			u32 a = positionIDs[indices[i]], b = positionIDs[indices[i + 1]], c = positionIDs[indices[i + 2]];
+
+			if (a != b && b != c && a != c)
+				triangles.insert(triangles.end(), { a, b, c });
+		}
+
+		std::vector<Quadric> quadrics(positionCount);
+		std::vector<bool> boundary(positionCount, false);
+
+		{
+			// an undirected edge used by a single triangle is on an open border
+			std::vector<u64> edges;
+			edges.reserve(triangles.size());
+
+			for (usize t = 0; t < triangles.size(); t += 3)
+			{
+				for (u32 k = 0; k < 3; k++)
+				{
+					u32 a = triangles[t + k], b = triangles[t + (k + 1) % 3];
+					edges.push_back((static_cast<u64>(std::min(a, b)) << 32) | std::max(a, b));
+				}
+			}
+
+			std::sort(edges.begin(), edges.end());
+
+			auto isBoundary = [&](u32 a, u32 b) {
+				u64 edge = (static_cast<u64>(std::min(a, b)) << 32) | std::max(a, b);
+				auto range = std::equal_range(edges.begin(), edges.end(), edge);
+				return range.second - range.first == 1;
+			};
+
+			for (usize t = 0; t < triangles.size(); t += 3)
+			{
+				const glm::dvec3& p0 = positions[triangles[t]];
+				const glm::dvec3& p1 = positions[triangles[t + 1]];
+				const glm::dvec3& p2 = positions[triangles[t + 2]];
+
+				glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+				f64 area = glm::length(normal);
+
+				if (area == 0.0)
+					continue;
+
+				normal /= area;
+
+				for (u32 k = 0; k < 3; k++)
+					quadrics[triangles[t + k]].AddPlane(normal, -glm::dot(normal, p0), area);
+
+				for (u32 k = 0; k < 3; k++)
+				{
+					u32 a = triangles[t + k], b = triangles[t + (k + 1) % 3];
+
+					if (!isBoundary(a, b))
+						continue;
+
+					glm::dvec3 edge = positions[b] - positions[a];
+					f64 length = glm::length(edge);
+
+					if (length == 0.0)
+						continue;
+
+					glm::dvec3 edgeNormal = glm::normalize(glm::cross(edge, normal));
+					f64 weight = length * length * BoundaryWeight;
+
+					quadrics[a].AddPlane(edgeNormal, -glm::dot(edgeNormal, positions[a]), weight);
+					quadrics[b].AddPlane(edgeNormal, -glm::dot(edgeNormal, positions[b]), weight);
+					boundary[a] = boundary[b] = true;
+				}
+			}
+		}
+
+		std::vector<u32> collapsedTo(positionCount);
+
+		for (u32 p = 0; p < positionCount; p++)
+			collapsedTo[p] = p;
+
+		f64 maxCost = static_cast<f64>(targetError) * static_cast<f64>(targetError);
+		f64 reachedCost = 0.0;
+
+		std::vector<Collapse> collapses;
+		std::vector<u32> adjacencyOffsets, adjacency;
+		std::vector<bool> locked;
+
+		// every pass collapses the cheapest edges that don't touch each other, then rebuilds the triangle list
+		while (triangles.size() > targetIndexCount)
+		{
+			collapses.clear();
+
+			for (usize t = 0; t < triangles.size(); t += 3)
+			{
+				for (u32 k = 0; k < 3; k++)
+				{
+					u32 a = triangles[t + k], b = triangles[t + (k + 1) % 3];
+
+					// each interior edge shows up once per direction, only the a < b copy is considered
+					if (a > b && !boundary[a] && !boundary[b])
+						continue;
+
+					Quadric merged = quadrics[a];
+					merged.Add(quadrics[b]);
+
+					// a border vertex may only slide along the border, interior ones may land anywhere
+					bool aToB = !boundary[a] || boundary[b];
+					bool bToA = !boundary[b] || boundary[a];
+
+					f64 costAToB = aToB ? merged.Error(positions[b]) : std::numeric_limits<f64>::max();
+					f64 costBToA = bToA ? merged.Error(positions[a]) : std::numeric_limits<f64>::max();
+
+					if (costAToB <= costBToA && aToB)
+						collapses.push_back({ costAToB, a, b });
+					else if (bToA)
+						collapses.push_back({ costBToA, b, a });
+				}
+			}
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+
+			adjacencyOffsets.assign(positionCount + 1, 0);
+
+			for (u32 position : triangles)
+				adjacencyOffsets[position + 1]++;
+
+			for (u32 p = 0; p < positionCount; p++)
+				adjacencyOffsets[p + 1] += adjacencyOffsets[p];
+
+			adjacency.resize(triangles.size());
+
+			{
+				std::vector<u32> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+				for (usize i = 0; i < triangles.size(); i++)
+					adjacency[cursor[triangles[i]]++] = static_cast<u32>(i / 3);
+			}
+
+			locked.assign(positionCount, false);
+
+			// each collapse removes about two triangles
+			usize trianglesToRemove = (triangles.size() - targetIndexCount) / 3;
+			usize removed = 0;
+			usize applied = 0;
+
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.Cost > maxCost || removed >= trianglesToRemove)
+					break;
+
+				if (locked[collapse.From] || locked[collapse.To])
+					continue;
+
+				// reject collapses that would flip a surviving triangle around From
+				bool flips = false;
+				usize shared = 0;
+
+				for (u32 i = adjacencyOffsets[collapse.From]; i < adjacencyOffsets[collapse.From + 1] && !flips; i++)
+				{
+					const u32* triangle = &triangles[adjacency[i] * 3];
+
+					if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To)
+					{
+						shared++;
+						continue;
+					}
+
+					glm::dvec3 before[3], after[3];
+
+					for (u32 k = 0; k < 3; k++)
+					{
+						before[k] = positions[triangle[k]];
+						after[k] = triangle[k] == collapse.From ? positions[collapse.To] : before[k];
+					}
+
+					glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+					glm::dvec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+					flips = glm::dot(normalBefore, normalAfter) <= 0.0;
+				}
+
+				if (flips)
+					continue;
+
+				collapsedTo[collapse.From] = collapse.To;
+				quadrics[collapse.To].Add(quadrics[collapse.From]);
+				reachedCost = std::max(reachedCost, collapse.Cost);
+
+				// the triangles around both ends changed, so their other vertices wait for the next pass
+				for (u32 end : { collapse.From, collapse.To })
+				{
+					for (u32 i = adjacencyOffsets[end]; i < adjacencyOffsets[end + 1]; i++)
+					{
+						for (u32 k = 0; k < 3; k++)
+							locked[triangles[adjacency[i] * 3 + k]] = true;
+					}
+				}
+
+				removed += shared;
+				applied++;
+			}
+
+			if (applied == 0)
+				break;
+
+			usize write = 0;
+
+			for (usize t = 0; t < triangles.size(); t += 3)
+			{
+				u32 a = Resolve(collapsedTo, triangles[t]);
+				u32 b = Resolve(collapsedTo, triangles[t + 1]);
+				u32 c = Resolve(collapsedTo, triangles[t + 2]);
+
+				if (a == b || b == c || a == c)
+					continue;
+
+				triangles[write++] = a;
+				triangles[write++] = b;
+				triangles[write++] = c;
+			}
+
+			triangles.resize(write);
+		}
+
+		resultError = static_cast<f32>(std::sqrt(reachedCost) * scale);
+
+		// back to real vertices, a corner whose position moved takes the vertex at the new position with the closest normal
+		std::vector<u32> vertexOffsets(positionCount + 1, 0);
+		std::vector<u32> positionVertices(vertices.size());
+
+		for (u32 position : positionIDs)
+			vertexOffsets[position + 1]++;
+
+		for (u32 p = 0; p < positionCount; p++)
+			vertexOffsets[p + 1] += vertexOffsets[p];
+
+		{
+			std::vector<u32> cursor(vertexOffsets.begin(), vertexOffsets.end() - 1);
+
+			for (usize v = 0; v < vertices.size(); v++)
+				positionVertices[cursor[positionIDs[v]]++] = static_cast<u32>(v);
+		}
+
+		auto pickVertex = [&](u32 vertex, u32 position) {
+			if (positionIDs[vertex] == position)
+				return vertex;
+
+			const glm::vec3& normal = vertices[vertex].Normal;
+			u32 best = positionVertices[vertexOffsets[position]];
+			f32 bestDot = std::numeric_limits<f32>::lowest();
+
+			for (u32 i = vertexOffsets[position]; i < vertexOffsets[position + 1]; i++)
+			{
+				f32 dot = glm::dot(normal, vertices[positionVertices[i]].Normal);
+
+				if (dot > bestDot)
+				{
+					bestDot = dot;
+					best = positionVertices[i];
+				}
+			}
+
+			return best;
+		};
+
+		std::vector<u32> result;
+		result.reserve(triangles.size());
+
+		for (usize i = 0; i + 2 < indices.size(); i += 3)
+		{
+			u32 a = Resolve(collapsedTo, positionIDs[indices[i]]);
+			u32 b = Resolve(collapsedTo, positionIDs[indices[i + 1]]);
+			u32 c = Resolve(collapsedTo, positionIDs[indices[i + 2]]);
+
+			if (a == b || b == c || a == c)
+				continue;
+
+			result.push_back(pickVertex(indices[i], a));
+			result.push_back(pickVertex(indices[i + 1], b));
+			result.push_back(pickVertex(indices[i + 2], c));
+		}
+
+		return result;
+	}
+
+	std::vector<MeshLOD> BuildLODChain(const std::vector<Vertex>& vertices, std::vector<u32>& indices)
+	{
+		std::vector<MeshLOD> lods = { { 0, static_cast<u32>(indices.size()), 0.0f } };
+		std::vector<u32> lod0(indices.begin(), indices.end());
+
+		for (u32 level = 1; level < MaxMeshLODs; level++)
+		{
+			usize previousCount = lods.back().IndexCount;
+			usize targetCount = (lod0.size() >> level) / 3 * 3;
+
+			f32 error = 0.0f;
+			std::vector<u32> simplified = SimplifyMesh(vertices, lod0, targetCount, LODMaxRelativeError, error);
+
+			// not worth a level of its own, the rest of the chain would only get closer to the error limit
+			if (simplified.empty() || static_cast<f32>(simplified.size()) > static_cast<f32>(previousCount) * LODMinReduction)
+				break;
+
+			OptimizeVertexCache(simplified, vertices.size());
+
+			lods.push_back({ static_cast<u32>(indices.size()), static_cast<u32>(simplified.size()), error });
+			indices.insert(indices.end(), simplified.begin(), simplified.end());
+		}
+
+		return lods;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,411 @@
+#include "ObjImporter.h"
+
+#include <charconv>
+#include <string_view>
+#include <algorithm>
+#include <type_traits>
+
+#include "OBJ-Loader.h"
+#include "ThreadPool.h"
+#include "Log.h"
+
+namespace Core
+{
+	namespace
+	{
+		constexpr usize MinChunkBytes = 256 * 1024;
+
+		enum CornerFlags : u8
+		{
+			HasTexCoord = 1 << 0,
+			HasNormal = 1 << 1,
+			// negative indices count back from the elements read so far, they're stored chunk relative
+			PositionRelative = 1 << 2,
+			TexCoordRelative = 1 << 3,
+			NormalRelative = 1 << 4
+		};
+
+		struct FaceCorner
+		{
+			i64 Position = 0;
+			i64 TexCoord = 0;
+			i64 Normal = 0;
+			u8 Flags = 0;
+		};
+
+		struct Chunk
+		{
+			std::string_view Text;
+
+			std::vector<objl::Vector3> Positions;
+			std::vector<objl::Vector2> TexCoords;
+			std::vector<objl::Vector3> Normals;
+			std::vector<FaceCorner> Corners;
+			std::vector<u32> FaceSizes;
+
+			usize PositionOffset = 0;
+			usize TexCoordOffset = 0;
+			usize NormalOffset = 0;
+
+			// objl's layout until the merge, so its triangulation can be reused
+			std::vector<objl::Vertex> Vertices;
+			std::vector<u32> Indices;
+
+			usize VertexOffset = 0;
+			usize IndexOffset = 0;
+
+			bool Failed = false;
+		};
+
+		bool IsSpace(char c) noexcept
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		std::string_view NextToken(std::string_view& line) noexcept
+		{
+			usize begin = 0;
+			while (begin < line.size() && IsSpace(line[begin]))
+				begin++;
+
+			usize end = begin;
+			while (end < line.size() && !IsSpace(line[end]))
+				end++;
+
+			std::string_view token = line.substr(begin, end - begin);
+			line.remove_prefix(end);
+
+			return token;
+		}
+
+		template<typename T>
+		bool ParseNumber(std::string_view token, T& value) noexcept
+		{
+			const char* first = token.data();
+			const char* last = token.data() + token.size();
+
+			if (first != last && *first == '+')
+				first++;
+
+			return std::from_chars(first, last, value).ec == std::errc();
+		}
+
+		bool ParseFloats(std::string_view line, f32* values, usize count) noexcept
+		{
+			for (usize i = 0; i < count; i++)
+			{
+				if (!ParseNumber(NextToken(line), values[i]))
+					return false;
+			}
+
+			return true;
+		}
+
+		// objl indices are 1 based, negative ones are relative to the elements read so far
+		bool ResolveIndex(std::string_view token, usize readSoFar, i64& index, u8& flags, u8 relativeFlag) noexcept
+		{
+			i64 value = 0;
+
+			if (!ParseNumber(token, value) || value == 0)
+				return false;
+
+			if (value < 0)
+			{
+				index = static_cast<i64>(readSoFar) + value;
+				flags |= relativeFlag;
+			}
+			else
+			{
+				index = value - 1;
+			}
+
+			return true;
+		}
+
+		// p, p/t, p//n or p/t/n
+		bool ParseCorner(std::string_view token, const Chunk& chunk, FaceCorner& corner) noexcept
+		{
+			usize firstSlash = token.find('/');
+			std::string_view position = token.substr(0, firstSlash);
+
+			if (!ResolveIndex(position, chunk.Positions.size(), corner.Position, corner.Flags, PositionRelative))
+				return false;
+
+			if (firstSlash == std::string_view::npos)
+				return true;
+
+			std::string_view rest = token.substr(firstSlash + 1);
+			usize secondSlash = rest.find('/');
+			std::string_view texCoord = rest.substr(0, secondSlash);
+
+			if (!texCoord.empty())
+			{
+				if (!ResolveIndex(texCoord, chunk.TexCoords.size(), corner.TexCoord, corner.Flags, TexCoordRelative))
+					return false;
+
+				corner.Flags |= HasTexCoord;
+			}
+
+			if (secondSlash == std::string_view::npos)
+				return true;
+
+			if (!ResolveIndex(rest.substr(secondSlash + 1), chunk.Normals.size(), corner.Normal, corner.Flags, NormalRelative))
+				return false;
+
+			corner.Flags |= HasNormal;
+			return true;
+		}
+
+		void ParseChunk(Chunk& chunk)
+		{
+			std::string_view text = chunk.Text;
+
+			// rough guesses from typical line lengths, saves most of the regrowth
+			chunk.Positions.reserve(text.size() / 96);
+			chunk.Normals.reserve(text.size() / 96);
+			chunk.Corners.reserve(text.size() / 24);
+			chunk.FaceSizes.reserve(text.size() / 72);
+
+			while (!text.empty() && !chunk.Failed)
+			{
+				usize lineEnd = text.find('\n');
+				std::string_view line = text.substr(0, lineEnd);
+				text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+
+				std::string_view keyword = NextToken(line);
+
+				if (keyword == "v")
+				{
+					f32 values[3] = {};
+					chunk.Failed = !ParseFloats(line, values, 3);
+					chunk.Positions.emplace_back(values[0], values[1], values[2]);
+				}
+				else if (keyword == "vt")
+				{
+					f32 values[2] = {};
+					chunk.Failed = !ParseFloats(line, values, 2);
+					chunk.TexCoords.emplace_back(values[0], values[1]);
+				}
+				else if (keyword == "vn")
+				{
+					f32 values[3] = {};
+					chunk.Failed = !ParseFloats(line, values, 3);
+					chunk.Normals.emplace_back(values[0], values[1], values[2]);
+				}
+				else if (keyword == "f")
+				{
+					u32 size = 0;
+
+					for (std::string_view token = NextToken(line); !token.empty(); token = NextToken(line))
+					{
+						FaceCorner& corner = chunk.Corners.emplace_back();
+
+						if (!ParseCorner(token, chunk, corner))
+						{
+							chunk.Failed = true;
+							break;
+						}
+
+						size++;
+					}
+
+					chunk.FaceSizes.push_back(size);
+				}
+			}
+		}
+
+		template<typename T>
+		const T* Fetch(const std::vector<T>& elements, i64 index, bool relative, usize chunkOffset) noexcept
+		{
+			if (relative)
+				index += static_cast<i64>(chunkOffset);
+
+			return index >= 0 && index < static_cast<i64>(elements.size()) ? &elements[index] : nullptr;
+		}
+
+		// mirrors objl::Loader::GenVerticesFromRawOBJ and the index generation of LoadFile
+		void BuildFaces(Chunk& chunk, const std::vector<objl::Vector3>& positions, const std::vector<objl::Vector2>& texCoords,
+			const std::vector<objl::Vector3>& normals)
+		{
+			objl::Loader triangulator;
+			std::vector<objl::Vertex> polygon;
+			std::vector<unsigned int> polygonIndices;
+
+			chunk.Vertices.reserve(chunk.Corners.size());
+			chunk.Indices.reserve(chunk.Corners.size());
+
+			usize cornerIndex = 0;
+
+			for (u32 size : chunk.FaceSizes)
+			{
+				u32 base = static_cast<u32>(chunk.Vertices.size());
+
+				// objl reuses one vertex for the whole face, faces with a corner missing its normal get the face normal
+				objl::Vertex vertex;
+				bool noNormal = false;
+
+				for (u32 i = 0; i < size; i++)
+				{
+					const FaceCorner& corner = chunk.Corners[cornerIndex++];
+
+					const objl::Vector3* position = Fetch(positions, corner.Position, corner.Flags & PositionRelative, chunk.PositionOffset);
+					const objl::Vector2* texCoord = corner.Flags & HasTexCoord ? Fetch(texCoords, corner.TexCoord, corner.Flags & TexCoordRelative, chunk.TexCoordOffset) : nullptr;
+					const objl::Vector3* normal = corner.Flags & HasNormal ? Fetch(normals, corner.Normal, corner.Flags & NormalRelative, chunk.NormalOffset) : nullptr;
+
+					if (!position || (corner.Flags & HasTexCoord && !texCoord) || (corner.Flags & HasNormal && !normal))
+					{
+						chunk.Failed = true;
+						return;
+					}
+
+					vertex.Position = *position;
+					vertex.TextureCoordinate = texCoord ? *texCoord : objl::Vector2(0, 0);
+
+					if (normal)
+						vertex.Normal = *normal;
+					else
+						noNormal = true;
+
+					chunk.Vertices.push_back(vertex);
+				}
+
+				objl::Vertex* face = chunk.Vertices.data() + base;
+
+				if (noNormal && size >= 3)
+				{
+					objl::Vector3 normal = objl::math::CrossV3(face[0].Position - face[1].Position, face[2].Position - face[1].Position);
+
+					for (u32 i = 0; i < size; i++)
+						face[i].Normal = normal;
+				}
+
+				if (size == 3)
+				{
+					chunk.Indices.insert(chunk.Indices.end(), { base, base + 1, base + 2 });
+					continue;
+				}
+
+				polygon.assign(face, face + size);
+				polygonIndices.clear();
+				triangulator.VertexTriangluation(polygonIndices, polygon);
+
+				for (unsigned int index : polygonIndices)
+					chunk.Indices.push_back(base + index);
+			}
+		}
+
+		std::vector<Chunk> SplitIntoChunks(std::string_view text)
+		{
+			usize maxChunks = (static_cast<usize>(ThreadPool::Get().GetThreadCount()) + 1) * 4;
+			usize chunkCount = std::clamp<usize>(text.size() / MinChunkBytes, 1, maxChunks);
+			usize chunkSize = text.size() / chunkCount + 1;
+
+			std::vector<Chunk> chunks;
+			chunks.reserve(chunkCount);
+
+			usize begin = 0;
+
+			while (begin < text.size())
+			{
+				usize end = begin + chunkSize < text.size() ? text.find('\n', begin + chunkSize) : std::string_view::npos;
+				end = end == std::string_view::npos ? text.size() : end + 1;
+
+				chunks.emplace_back().Text = text.substr(begin, end - begin);
+				begin = end;
+			}
+
+			return chunks;
+		}
+
+		Vertex ToVertex(const objl::Vertex& vertex) noexcept
+		{
+			return { glm::vec3(vertex.Position.X, vertex.Position.Y, vertex.Position.Z), glm::vec3(vertex.Normal.X, vertex.Normal.Y, vertex.Normal.Z),
+				glm::vec2(vertex.TextureCoordinate.X, vertex.TextureCoordinate.Y) };
+		}
+
+		template<typename T, typename Member>
+		void Gather(std::vector<Chunk>& chunks, std::vector<T>& out, Member member, usize Chunk::* offset)
+		{
+			usize total = 0;
+
+			for (Chunk& chunk : chunks)
+			{
+				chunk.*offset = total;
+				total += (chunk.*member).size();
+			}
+
+			out.resize(total);
+
+			ThreadPool::Get().ParallelFor(chunks.size(), 1, [&](usize begin, usize end)
+			{
+				for (usize i = begin; i < end; i++)
+				{
+					if constexpr (std::is_same_v<T, Vertex>)
+						std::transform((chunks[i].*member).begin(), (chunks[i].*member).end(), out.begin() + chunks[i].*offset, ToVertex);
+					else
+						std::copy((chunks[i].*member).begin(), (chunks[i].*member).end(), out.begin() + chunks[i].*offset);
+				}
+			});
+		}
+	}
+
+	bool ImportObj(std::span<const char> text, std::vector<Vertex>& vertices, std::vector<u32>& indices)
+	{
+		std::vector<Chunk> chunks = SplitIntoChunks(std::string_view(text.data(), text.size()));
+		ThreadPool& pool = ThreadPool::Get();
+
+		pool.ParallelFor(chunks.size(), 1, [&](usize begin, usize end)
+		{
+			for (usize i = begin; i < end; i++)
+				ParseChunk(chunks[i]);
+		});
+
+		std::vector<objl::Vector3> positions;
+		std::vector<objl::Vector2> texCoords;
+		std::vector<objl::Vector3> normals;
+
+		Gather(chunks, positions, &Chunk::Positions, &Chunk::PositionOffset);
+		Gather(chunks, texCoords, &Chunk::TexCoords, &Chunk::TexCoordOffset);
+		Gather(chunks, normals, &Chunk::Normals, &Chunk::NormalOffset);
+
+		pool.ParallelFor(chunks.size(), 1, [&](usize begin, usize end)
+		{
+			for (usize i = begin; i < end; i++)
+			{
+				if (!chunks[i].Failed)
+					BuildFaces(chunks[i], positions, texCoords, normals);
+			}
+		});
+
+		if (std::any_of(chunks.begin(), chunks.end(), [](const Chunk& chunk) { return chunk.Failed; }))
+		{
+			LOG_ERROR("Malformed .obj data.");
+			return false;
+		}
+
+		Gather(chunks, vertices, &Chunk::Vertices, &Chunk::VertexOffset);
+
+		usize indexCount = 0;
+
+		for (Chunk& chunk : chunks)
+		{
+			chunk.IndexOffset = indexCount;
+			indexCount += chunk.Indices.size();
+		}
+
+		indices.resize(indexCount);
+
+		// face indices are chunk local until they're offset by the vertices of the chunks before
+		pool.ParallelFor(chunks.size(), 1, [&](usize begin, usize end)
+		{
+			for (usize i = begin; i < end; i++)
+			{
+				u32 vertexOffset = static_cast<u32>(chunks[i].VertexOffset);
+				std::transform(chunks[i].Indices.begin(), chunks[i].Indices.end(), indices.begin() + chunks[i].IndexOffset,
+					[vertexOffset](u32 index) { return index + vertexOffset; });
+			}
+		});
+
+		return !vertices.empty() && !indices.empty();
+	}
+}
\ No newline at end of file
@@ -4,14 +4,21 @@ namespace Core
 {
 	Object::Object(ECS& ecs, const std::string& name):
 		m_ECS(ecs),
-		m_ID(ecs.CreateEntity()),
+		m_Entity(ecs.CreateEntity()),
 		m_Name(name)
 	{
 		AddComponent<Transform>();
+		AddComponent<WorldTransform>();
+		AddComponent<Visibility>();
+	}
+
+	Object::~Object()
+	{
+		m_ECS.DestroyEntity(m_Entity);
 	}
 
 	std::vector<Core::Asset*> Object::GetAllAssets()
 	{
-		return m_ECS.GetAllEntityAssets(m_ID);
+		return m_ECS.GetAllEntityAssets(m_Entity);
 	}
 }
\ No newline at end of file
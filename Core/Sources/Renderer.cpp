@@ -65,12 +65,14 @@ namespace Core
 		InitCoreData();
 		SetPhysDevicePropertiesAndLimits();
 		CreateImmediateCommandResources();
+		GetQueues();
+		CreateUploadContext();
 		CreateBuffers();
 		CreateSwapchain();
-		GetQueues();
 		CreateDepthResources();
 		CreateRenderTextures();
 		CreateGP();
+		CreateCullPipeline();
 		CreateBlitPipeline();
 		CreateCommandPool();
 		CreateCommandBuffers();
@@ -115,11 +117,18 @@ namespace Core
 		features12.bufferDeviceAddress = true;
 		features12.descriptorIndexing = true;
 		features12.hostQueryReset = true;
+		features12.timelineSemaphore = true;
+		features12.drawIndirectCount = true;
 
 		VkPhysicalDeviceFeatures features = {};
 		features.fillModeNonSolid = VK_TRUE;
 		features.geometryShader = VK_TRUE;
 		features.wideLines = VK_TRUE;
+		features.drawIndirectFirstInstance = VK_TRUE;
+
+		// optional in plain 1.3, without it every indirect call is limited to one draw
+		VkPhysicalDeviceFeatures multiDrawFeatures = {};
+		multiDrawFeatures.multiDrawIndirect = VK_TRUE;
 
 		vkb::PhysicalDeviceSelector selector(m_CoreData.Instance);
 		vkb::PhysicalDevice physicalDevice =
@@ -131,6 +140,11 @@ namespace Core
 			.select()
 			.value();
 
+		m_MultiDrawIndirect = physicalDevice.enable_features_if_present(multiDrawFeatures);
+
+		if (!m_MultiDrawIndirect)
+			LOG_WARN("multiDrawIndirect isn't supported, meshlets are drawn one by one and gpu-driven rendering is off.");
+
 		vkb::DeviceBuilder deviceBuilder(physicalDevice);
 		vkb::Device vkbDevice = deviceBuilder.build().value();
 
@@ -178,6 +192,46 @@ namespace Core
 	{
 		m_VPBuffer = CreateBuffer(sizeof(VP), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
 		m_MaterialsBuffer = CreateBuffer(sizeof(MaterialUBO) * 20, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+
+		constexpr VkBufferUsageFlags arenaUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+		m_VertexArenaBuffer = CreateBuffer(VERTEX_ARENA_SIZE, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | arenaUsage, VMA_MEMORY_USAGE_GPU_ONLY);
+		m_IndexArenaBuffer = CreateBuffer(INDEX_ARENA_SIZE, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | arenaUsage, VMA_MEMORY_USAGE_GPU_ONLY);
+		m_VertexArena = BufferArena(VERTEX_ARENA_SIZE);
+		m_IndexArena = BufferArena(INDEX_ARENA_SIZE);
+
+		for (usize i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			m_IndirectBuffers[i] = CreateBuffer(sizeof(VkDrawIndexedIndirectCommand) * MAX_INDIRECT_DRAWS, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+
+			void* data;
+			vmaMapMemory(m_Allocator, m_IndirectBuffers[i].Allocation, &data);
+			m_IndirectCommands[i] = static_cast<VkDrawIndexedIndirectCommand*>(data);
+		}
+
+		// the object and lod state buffers are copied from when they grow
+		m_GPUObjectBuffer = CreateBuffer(sizeof(GPUObject) * m_GPUObjectCapacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+		m_GPULODStateBuffer = CreateBuffer(sizeof(u32) * m_GPUObjectCapacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+		m_GPUDrawBuffer = CreateBuffer(sizeof(VkDrawIndexedIndirectCommand) * m_GPUObjectCapacity * GPUDrawBucketCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+		m_GPUDrawCountBuffer = CreateBuffer(sizeof(u32) * GPUDrawBucketCount + sizeof(GPUCullStats),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VMA_MEMORY_USAGE_GPU_ONLY);
+
+		for (usize i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			m_GPUObjectStagingBuffers[i] = CreateBuffer(sizeof(GPUObject) * MAX_GPU_OBJECT_UPDATES, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+			m_GPUCullReadbackBuffers[i] = CreateBuffer(sizeof(u32) * GPUDrawBucketCount + sizeof(GPUCullStats), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU);
+
+			void* data;
+			vmaMapMemory(m_Allocator, m_GPUObjectStagingBuffers[i].Allocation, &data);
+			m_GPUObjectStaging[i] = static_cast<GPUObject*>(data);
+
+			vmaMapMemory(m_Allocator, m_GPUCullReadbackBuffers[i].Allocation, &data);
+			m_GPUCullReadback[i] = static_cast<const u32*>(data);
+		}
 	}
 
 	void Renderer::CreateSwapchain()
@@ -208,6 +262,27 @@ namespace Core
 		m_RenderData.QueueFamily = m_CoreData.Device.get_queue_index(vkb::QueueType::graphics).value();
 
 		ASSERT(m_RenderData.GraphicsQueue && m_RenderData.PresentQueue);
+
+		// a dedicated transfer family is the dma engine on discrete gpus, copies there run beside rendering
+		auto transferQueue = m_CoreData.Device.get_dedicated_queue(vkb::QueueType::transfer);
+		auto transferFamily = m_CoreData.Device.get_dedicated_queue_index(vkb::QueueType::transfer);
+
+		if (!transferQueue)
+		{
+			transferQueue = m_CoreData.Device.get_queue(vkb::QueueType::transfer);
+			transferFamily = m_CoreData.Device.get_queue_index(vkb::QueueType::transfer);
+		}
+
+		m_RenderData.TransferQueue = transferQueue ? transferQueue.value() : m_RenderData.GraphicsQueue;
+		m_RenderData.TransferQueueFamily = transferQueue ? transferFamily.value() : m_RenderData.QueueFamily;
+
+		LOG_INFO("Uploads go through queue family {}{}", m_RenderData.TransferQueueFamily,
+			m_RenderData.TransferQueueFamily == m_RenderData.QueueFamily ? " (the graphics queue)" : "");
+	}
+
+	void Renderer::CreateUploadContext()
+	{
+		m_UploadContext.Init(m_CoreData.Device, m_Allocator, m_RenderData.TransferQueue, m_RenderData.TransferQueueFamily, UPLOAD_STAGING_SIZE);
 	}
 
 	void Renderer::CreateDepthResources()
@@ -256,29 +331,6 @@ namespace Core
 		objPushConstantRange.offset = 0;
 		objPushConstantRange.size = sizeof(ObjPushConstants);
 
-		VkVertexInputBindingDescription bindingDescription = {};
-		bindingDescription.binding = 0;
-		bindingDescription.stride = sizeof(objl::Vertex);
-		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-		std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
-		attributeDescriptions.resize(3);
-
-		attributeDescriptions[0].binding = 0;
-		attributeDescriptions[0].location = 0;
-		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[0].offset = offsetof(objl::Vertex, Position);
-
-		attributeDescriptions[1].binding = 0;
-		attributeDescriptions[1].location = 1;
-		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[1].offset = offsetof(objl::Vertex, Normal);
-
-		attributeDescriptions[2].binding = 0;
-		attributeDescriptions[2].location = 2;
-		attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-		attributeDescriptions[2].offset = offsetof(objl::Vertex, TextureCoordinate);
-
 		VkPipelineDepthStencilStateCreateInfo depthStencil = {};
 		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 		depthStencil.depthTestEnable = VK_TRUE;
@@ -293,7 +345,22 @@ namespace Core
 			DescriptorBinding(m_MaterialsBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
 		};
 
-		auto vert = m_ShaderDirectory / "Compiled" / "object.vert.spv";
+		std::array<std::filesystem::path, VertexFormatCount> verts =
+		{
+			m_ShaderDirectory / "Compiled" / "object.vert.spv",
+			m_ShaderDirectory / "Compiled" / "object_packed.vert.spv"
+		};
+
+		// the gpu-driven variants read the model matrix and material from the object buffer instead of push constants
+		std::vector<DescriptorBinding> indirectBindings = bindings;
+		indirectBindings.emplace_back(m_GPUObjectBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+		std::array<std::filesystem::path, VertexFormatCount> indirectVerts =
+		{
+			m_ShaderDirectory / "Compiled" / "object_indirect.vert.spv",
+			m_ShaderDirectory / "Compiled" / "object_packed_indirect.vert.spv"
+		};
+
 		auto frag = m_ShaderDirectory / "Compiled" / "object.frag.spv";
 		auto geom = m_ShaderDirectory / "Compiled" / "object.geom.spv";
 
@@ -310,17 +377,95 @@ namespace Core
 
 		auto graphicsRenderingInfo = GetGraphicsRenderingInfo();
 
-		m_GraphicsShader = CreateShader(&graphicsRenderingInfo, bindings, {objPushConstantRange},
-			&bindingDescription, attributeDescriptions, &viewport, &scissor, &depthStencil, dynamicStates, &multisampling, VK_CULL_MODE_BACK_BIT, VK_POLYGON_MODE_FILL, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, vert, frag);
+		// one pipeline per vertex format, meshes pick theirs when they're drawn
+		for (usize i = 0; i < VertexFormatCount; i++)
+		{
+			VkVertexInputBindingDescription bindingDescription = {};
+			std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+			GetVertexInputDescription(static_cast<VertexFormat>(i), bindingDescription, attributeDescriptions);
+
+			m_GraphicsShaders[i] = CreateShader(&graphicsRenderingInfo, bindings, {objPushConstantRange},
+				&bindingDescription, attributeDescriptions, &viewport, &scissor, &depthStencil, dynamicStates, &multisampling, VK_CULL_MODE_BACK_BIT, VK_POLYGON_MODE_FILL, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, verts[i], frag);
 
-		UpdateDescriptorSets(m_GraphicsShader);
+			UpdateDescriptorSets(m_GraphicsShaders[i]);
 
-		m_WireframeShader = CreateShader(
-			&graphicsRenderingInfo, bindings, {objPushConstantRange},
-			&bindingDescription, attributeDescriptions, &viewport, &scissor,
-			&depthStencil, dynamicStates, &multisampling, VK_CULL_MODE_NONE, VK_POLYGON_MODE_FILL, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, vert, frag, geom
-		);
-		UpdateDescriptorSets(m_WireframeShader);
+			m_WireframeShaders[i] = CreateShader(
+				&graphicsRenderingInfo, bindings, {objPushConstantRange},
+				&bindingDescription, attributeDescriptions, &viewport, &scissor,
+				&depthStencil, dynamicStates, &multisampling, VK_CULL_MODE_NONE, VK_POLYGON_MODE_FILL, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, verts[i], frag, geom
+			);
+			UpdateDescriptorSets(m_WireframeShaders[i]);
+
+			m_IndirectShaders[i] = CreateShader(&graphicsRenderingInfo, indirectBindings, {objPushConstantRange},
+				&bindingDescription, attributeDescriptions, &viewport, &scissor, &depthStencil, dynamicStates, &multisampling, VK_CULL_MODE_BACK_BIT, VK_POLYGON_MODE_FILL, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, indirectVerts[i], frag);
+			UpdateDescriptorSets(m_IndirectShaders[i]);
+
+			m_IndirectWireframeShaders[i] = CreateShader(&graphicsRenderingInfo, indirectBindings, {objPushConstantRange},
+				&bindingDescription, attributeDescriptions, &viewport, &scissor, &depthStencil, dynamicStates, &multisampling, VK_CULL_MODE_NONE, VK_POLYGON_MODE_FILL, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, indirectVerts[i], frag, geom);
+			UpdateDescriptorSets(m_IndirectWireframeShaders[i]);
+		}
+	}
+
+	void Renderer::CreateCullPipeline()
+	{
+		VkPushConstantRange cullPushConstantRange = {};
+		cullPushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		cullPushConstantRange.offset = 0;
+		cullPushConstantRange.size = sizeof(GPUCullConstants);
+
+		std::vector<DescriptorBinding> bindings =
+		{
+			DescriptorBinding(m_GPUObjectBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+			DescriptorBinding(m_GPUDrawBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+			DescriptorBinding(m_GPUDrawCountBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+			DescriptorBinding(m_GPULODStateBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+		};
+
+		m_CullShader = CreateComputeShader(bindings, {cullPushConstantRange}, m_ShaderDirectory / "Compiled" / "cull.comp.spv");
+		UpdateDescriptorSets(m_CullShader);
+	}
+
+	void Renderer::GetVertexInputDescription(VertexFormat format, VkVertexInputBindingDescription& binding,
+		std::vector<VkVertexInputAttributeDescription>& attributes)
+	{
+		binding = {};
+		binding.binding = 0;
+		binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		attributes.resize(3);
+
+		for (u32 i = 0; i < 3; i++)
+		{
+			attributes[i].binding = 0;
+			attributes[i].location = i;
+		}
+
+		if (format == VertexFormat::Packed)
+		{
+			binding.stride = sizeof(PackedVertex);
+
+			attributes[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+			attributes[0].offset = offsetof(PackedVertex, Position);
+
+			attributes[1].format = VK_FORMAT_R16G16_SNORM;
+			attributes[1].offset = offsetof(PackedVertex, Normal);
+
+			attributes[2].format = VK_FORMAT_R16G16_SFLOAT;
+			attributes[2].offset = offsetof(PackedVertex, TextureCoordinate);
+		}
+		else
+		{
+			binding.stride = sizeof(Vertex);
+
+			attributes[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+			attributes[0].offset = offsetof(Vertex, Position);
+
+			attributes[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+			attributes[1].offset = offsetof(Vertex, Normal);
+
+			attributes[2].format = VK_FORMAT_R32G32_SFLOAT;
+			attributes[2].offset = offsetof(Vertex, TextureCoordinate);
+		}
 	}
 
 	void Renderer::CreateBlitPipeline()
@@ -495,6 +640,17 @@ namespace Core
 		bufferInfo.usage = usage;
 		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+		// upload destinations are written on the transfer queue and read on the graphics queue, sharing them
+		// concurrently saves a queue family ownership transfer per upload
+		std::array queueFamilies = { m_RenderData.QueueFamily, m_RenderData.TransferQueueFamily };
+
+		if ((usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) && queueFamilies[0] != queueFamilies[1])
+		{
+			bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			bufferInfo.queueFamilyIndexCount = static_cast<u32>(queueFamilies.size());
+			bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+		}
+
 		VmaAllocationCreateInfo allocInfo = {};
 		allocInfo.usage = memoryUsage;
 
@@ -553,6 +709,15 @@ namespace Core
 		imageInfo.samples = samples;
 		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+		std::array queueFamilies = { m_RenderData.QueueFamily, m_RenderData.TransferQueueFamily };
+
+		if ((usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT) && queueFamilies[0] != queueFamilies[1])
+		{
+			imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			imageInfo.queueFamilyIndexCount = static_cast<u32>(queueFamilies.size());
+			imageInfo.pQueueFamilyIndices = queueFamilies.data();
+		}
+
 		VmaAllocationCreateInfo allocInfo = {};
 		allocInfo.usage = memoryUsage;
 
@@ -594,64 +759,7 @@ namespace Core
 		const std::filesystem::path& geom)
 	{
 		Shader shader;
-		shader.Bindings = bindings;
-
-		std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
-		std::unordered_map<VkDescriptorType, uint32_t> descriptorCounts;
-
-		for (size_t i = 0; i < bindings.size(); ++i)
-		{
-			layoutBindings.emplace_back(
-				static_cast<uint32_t>(i),
-				bindings[i].Type,
-				1,
-				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
-			);
-			descriptorCounts[bindings[i].Type]++;
-		}
-
-		std::vector<VkDescriptorPoolSize> poolSizes;
-		for (const auto& [type, count] : descriptorCounts)
-		{
-			poolSizes.emplace_back(type, count);
-		}
-
-		VkDescriptorSetLayoutCreateInfo layoutInfo = {};
-		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-		layoutInfo.pBindings = layoutBindings.data();
-
-		vkCreateDescriptorSetLayout(m_CoreData.Device, &layoutInfo, nullptr, &shader.DescriptorLayout);
-		ASSERT(shader.DescriptorLayout);
-
-		VkDescriptorPoolCreateInfo poolInfo = {};
-		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-		poolInfo.maxSets = 1;
-		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-		poolInfo.pPoolSizes = poolSizes.data();
-
-		vkCreateDescriptorPool(m_CoreData.Device, &poolInfo, nullptr, &shader.DescriptorPool);
-		ASSERT(shader.DescriptorPool);
-
-		VkDescriptorSetAllocateInfo allocInfo = {};
-		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		allocInfo.descriptorPool = shader.DescriptorPool;
-		allocInfo.descriptorSetCount = 1;
-		allocInfo.pSetLayouts = &shader.DescriptorLayout;
-
-		vkAllocateDescriptorSets(m_CoreData.Device, &allocInfo, &shader.DescriptorSet);
-		ASSERT(shader.DescriptorSet);
-
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = 1;
-		pipelineLayoutInfo.pSetLayouts = &shader.DescriptorLayout;
-		pipelineLayoutInfo.pPushConstantRanges = !pushConstantRange.empty() ? pushConstantRange.data() : nullptr;
-		pipelineLayoutInfo.pushConstantRangeCount = static_cast<u32>(pushConstantRange.size());
-
-		vkCreatePipelineLayout(m_CoreData.Device, &pipelineLayoutInfo, nullptr, &shader.PipelineLayout);
-		ASSERT(shader.PipelineLayout);
+		CreateShaderLayout(shader, bindings, pushConstantRange, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
 
 		auto vertCode = ReadFile(vert);
 		auto fragCode = ReadFile(frag);
@@ -777,6 +885,113 @@ namespace Core
 		return shader;
 	}
 
+	void Renderer::CreateShaderLayout(Shader& shader, const std::vector<DescriptorBinding>& bindings,
+		const std::vector<VkPushConstantRange>& pushConstantRanges, VkShaderStageFlags stages)
+	{
+		shader.Bindings = bindings;
+
+		std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+
+		for (size_t i = 0; i < bindings.size(); ++i)
+		{
+			layoutBindings.emplace_back(
+				static_cast<uint32_t>(i),
+				bindings[i].Type,
+				1,
+				stages
+			);
+		}
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = layoutBindings.data();
+
+		vkCreateDescriptorSetLayout(m_CoreData.Device, &layoutInfo, nullptr, &shader.DescriptorLayout);
+		ASSERT(shader.DescriptorLayout);
+
+		CreateDescriptorSet(shader);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &shader.DescriptorLayout;
+		pipelineLayoutInfo.pPushConstantRanges = !pushConstantRanges.empty() ? pushConstantRanges.data() : nullptr;
+		pipelineLayoutInfo.pushConstantRangeCount = static_cast<u32>(pushConstantRanges.size());
+
+		vkCreatePipelineLayout(m_CoreData.Device, &pipelineLayoutInfo, nullptr, &shader.PipelineLayout);
+		ASSERT(shader.PipelineLayout);
+	}
+
+	void Renderer::CreateDescriptorSet(Shader& shader)
+	{
+		std::unordered_map<VkDescriptorType, uint32_t> descriptorCounts;
+
+		for (const DescriptorBinding& binding : shader.Bindings)
+			descriptorCounts[binding.Type]++;
+
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		for (const auto& [type, count] : descriptorCounts)
+		{
+			poolSizes.emplace_back(type, count);
+		}
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+		poolInfo.maxSets = 1;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+
+		vkCreateDescriptorPool(m_CoreData.Device, &poolInfo, nullptr, &shader.DescriptorPool);
+		ASSERT(shader.DescriptorPool);
+
+		VkDescriptorSetAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = shader.DescriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &shader.DescriptorLayout;
+
+		vkAllocateDescriptorSets(m_CoreData.Device, &allocInfo, &shader.DescriptorSet);
+		ASSERT(shader.DescriptorSet);
+	}
+
+	void Renderer::ReplaceDescriptorSet(Shader& shader)
+	{
+		// frames in flight may still use the old set and updating one in use is invalid, so it goes with its pool
+		m_RetiredDescriptorPools.emplace_back(m_FrameCount, shader.DescriptorPool);
+
+		CreateDescriptorSet(shader);
+		UpdateDescriptorSets(shader);
+	}
+
+	Shader Renderer::CreateComputeShader(const std::vector<DescriptorBinding>& bindings, const std::vector<VkPushConstantRange>& pushConstantRanges,
+		const std::filesystem::path& comp)
+	{
+		Shader shader;
+		CreateShaderLayout(shader, bindings, pushConstantRanges, VK_SHADER_STAGE_COMPUTE_BIT);
+
+		auto compCode = ReadFile(comp);
+		VkShaderModule compModule = CreateShaderModule(m_CoreData, compCode);
+
+		ASSERT(compModule);
+
+		VkComputePipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = compModule;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.layout = shader.PipelineLayout;
+
+		vkCreateComputePipelines(m_CoreData.Device, nullptr, 1, &pipelineInfo, nullptr, &shader.Pipeline);
+		ASSERT(shader.Pipeline);
+
+		vkDestroyShaderModule(m_CoreData.Device, compModule, nullptr);
+
+		return shader;
+	}
+
 	void Renderer::UpdateDescriptorSets(const Shader& shader)
 	{
 		std::vector<VkWriteDescriptorSet> descriptorWrites;
@@ -883,6 +1098,15 @@ namespace Core
 	void Renderer::BeginFrame()
 	{
 		vkWaitForFences(m_CoreData.Device, 1, &m_RenderData.InFlightFences[m_RenderData.CurrentFrame], VK_TRUE, UINT64_MAX);
+		ReleaseRetiredResources();
+
+		if (m_GPUCullReadbackPending[m_RenderData.CurrentFrame])
+		{
+			const u32* counts = m_GPUCullReadback[m_RenderData.CurrentFrame];
+			m_GPUCullStats.VisibleObjects = counts[GPUDrawBucketCount];
+			m_GPUCullStats.VisibleTriangles = counts[GPUDrawBucketCount + 1];
+			m_GPUCullReadbackPending[m_RenderData.CurrentFrame] = false;
+		}
 
 		VkResult result = vkAcquireNextImageKHR(
 			m_CoreData.Device, m_CoreData.Swapchain, UINT64_MAX,
@@ -910,6 +1134,8 @@ namespace Core
 
 		m_CurrentCommandBuffer = m_RenderData.CommandBuffers[m_CurrentImageIndex];
 		vkResetCommandBuffer(m_CurrentCommandBuffer, 0);
+		m_IndirectCount = 0;
+		m_CullRecorded = false;
 
 		VkCommandBufferBeginInfo beginInfo = {};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -933,12 +1159,23 @@ namespace Core
 
 		vkEndCommandBuffer(m_CurrentCommandBuffer);
 
-		std::array waitSemaphores = { m_RenderData.AvailableSemaphores[m_RenderData.CurrentFrame] };
-		std::array waitStages = { static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT) };
+		// everything uploaded before or during this frame has to land before the frame reads it, the wait is on the gpu
+		u64 uploadValue = m_UploadContext.Flush();
+
+		std::array waitSemaphores = { m_RenderData.AvailableSemaphores[m_RenderData.CurrentFrame], m_UploadContext.GetTimelineSemaphore() };
+		std::array waitStages = { static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT),
+			static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT) };
+		std::array waitValues = { u64(0), uploadValue };
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.waitSemaphoreValueCount = static_cast<u32>(waitValues.size());
+		timelineInfo.pWaitSemaphoreValues = waitValues.data();
 
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.waitSemaphoreCount = static_cast<u32>(waitSemaphores.size());
 		submitInfo.pWaitSemaphores = waitSemaphores.data();
 		submitInfo.pWaitDstStageMask = waitStages.data();
 		submitInfo.commandBufferCount = 1;
@@ -975,6 +1212,7 @@ namespace Core
 		}
 
 		m_RenderData.CurrentFrame = (m_RenderData.CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+		m_FrameCount++;
 		m_FrameInProgress = false;
 	}
 
@@ -986,6 +1224,10 @@ namespace Core
 			return;
 		}
 
+		// compute can't run inside the render pass
+		if (m_CullRequested)
+			RecordGPUCulling();
+
 		VkImageMemoryBarrier barrier = {};
 		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 		barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
@@ -1046,12 +1288,19 @@ namespace Core
 
 		vkCmdBeginRendering(m_CurrentCommandBuffer, &renderingInfo);
 
-		Shader& activeShader = m_WireframeMode ? m_WireframeShader : m_GraphicsShader;
+		m_BoundVertexFormat = VertexFormat::Full;
+		Shader& activeShader = m_WireframeMode ? m_WireframeShaders[0] : m_GraphicsShaders[0];
 
 		vkCmdBindPipeline(m_CurrentCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, activeShader.Pipeline);
 		vkCmdBindDescriptorSets(m_CurrentCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
 			activeShader.PipelineLayout, 0, 1, &activeShader.DescriptorSet, 0, nullptr);
 
+		VkDeviceSize offset = 0;
+		m_BoundIndexType = VK_INDEX_TYPE_UINT32;
+
+		vkCmdBindVertexBuffers(m_CurrentCommandBuffer, 0, 1, &m_VertexArenaBuffer.Buffer, &offset);
+		vkCmdBindIndexBuffer(m_CurrentCommandBuffer, m_IndexArenaBuffer.Buffer, 0, m_BoundIndexType);
+
 		VkViewport viewport = {};
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
@@ -1224,56 +1473,421 @@ namespace Core
 		);
 	}
 
-	MeshBuffers Renderer::CreateMeshBuffers(const std::vector<objl::Vertex>& vertices, const std::vector<u32>& indices)
+	MeshBuffers Renderer::CreateMeshBuffers(const std::vector<Vertex>& vertices, const std::vector<u32>& indices)
 	{
-		MeshBuffers meshBuffers;
+		MeshBuffers meshBuffers = CreateMeshBuffers(
+			std::span<const u8>(reinterpret_cast<const u8*>(vertices.data()), vertices.size() * sizeof(Vertex)),
+			std::span<const u8>(reinterpret_cast<const u8*>(indices.data()), indices.size() * sizeof(u32)));
 		meshBuffers.Vertices = vertices;
 		meshBuffers.Indices = indices;
 
-		VkDeviceSize vertexBufferSize = sizeof(objl::Vertex) * vertices.size();
+		return meshBuffers;
+	}
+
+	MeshBuffers Renderer::CreateMeshBuffers(std::span<const u8> vertexData, std::span<const u8> indexData)
+	{
+		MeshBuffers meshBuffers;
+		meshBuffers.VertexBuffer = CreateDeviceLocalBuffer(vertexData, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+		meshBuffers.IndexBuffer = CreateDeviceLocalBuffer(indexData, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
 
-		Buffer stagingBuffer = CreateBuffer(
-			vertexBufferSize,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VMA_MEMORY_USAGE_CPU_ONLY
-		);
+		return meshBuffers;
+	}
 
-		void* data;
-		vmaMapMemory(m_Allocator, stagingBuffer.Allocation, &data);
-		std::memcpy(data, vertices.data(), vertexBufferSize);
-		vmaUnmapMemory(m_Allocator, stagingBuffer.Allocation);
+	GeometryRange Renderer::AllocateGeometry(std::span<const u8> vertexData, u32 vertexStride, std::span<const u8> indexData, VkIndexType indexType)
+	{
+		u32 indexSize = indexType == VK_INDEX_TYPE_UINT16 ? sizeof(u16) : sizeof(u32);
 
-		meshBuffers.VertexBuffer = CreateBuffer(
-			vertexBufferSize,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-			VMA_MEMORY_USAGE_GPU_ONLY
-		);
+		// the offsets have to be whole elements of the range's own format
+		GeometryRange range;
+		range.VertexByteOffset = AllocateFromArena(m_VertexArena, m_VertexArenaBuffer, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertexData.size(), std::bit_ceil(vertexStride));
+		range.VertexBytes = vertexData.size();
+		range.IndexByteOffset = AllocateFromArena(m_IndexArena, m_IndexArenaBuffer, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexData.size(), indexSize);
+		range.IndexBytes = indexData.size();
+		range.VertexOffset = static_cast<i32>(range.VertexByteOffset / vertexStride);
+		range.FirstIndex = static_cast<u32>(range.IndexByteOffset / indexSize);
 
-		CopyBuffer(stagingBuffer.Buffer, meshBuffers.VertexBuffer.Buffer, vertexBufferSize);
-		vmaDestroyBuffer(m_Allocator, stagingBuffer.Buffer, stagingBuffer.Allocation);
+		m_UploadContext.UploadBuffer(m_VertexArenaBuffer.Buffer, range.VertexByteOffset, vertexData);
+		m_UploadContext.UploadBuffer(m_IndexArenaBuffer.Buffer, range.IndexByteOffset, indexData);
 
-		VkDeviceSize indexBufferSize = sizeof(u32) * indices.size();
+		return range;
+	}
 
-		stagingBuffer = CreateBuffer(
-			indexBufferSize,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VMA_MEMORY_USAGE_CPU_ONLY
-		);
+	void Renderer::FreeGeometry(GeometryRange& range)
+	{
+		if (!range.IsValid())
+			return;
+
+		m_RetiredGeometry.emplace_back(m_FrameCount, range);
+		range = {};
+	}
+
+	void Renderer::ReleaseRetiredResources()
+	{
+		// called after waiting for this frame slot's fence, every frame up to m_FrameCount - MAX_FRAMES_IN_FLIGHT is done
+		auto isDone = [this](u64 retiredAt) { return retiredAt + MAX_FRAMES_IN_FLIGHT <= m_FrameCount; };
+
+		std::erase_if(m_RetiredGeometry, [&](const std::pair<u64, GeometryRange>& retired)
+		{
+			if (!isDone(retired.first))
+				return false;
+
+			m_VertexArena.Free(retired.second.VertexByteOffset, retired.second.VertexBytes);
+			m_IndexArena.Free(retired.second.IndexByteOffset, retired.second.IndexBytes);
+			return true;
+		});
+
+		std::erase_if(m_RetiredBuffers, [&](const std::pair<u64, Buffer>& retired)
+		{
+			if (!isDone(retired.first))
+				return false;
+
+			vmaDestroyBuffer(m_Allocator, retired.second.Buffer, retired.second.Allocation);
+			return true;
+		});
+
+		std::erase_if(m_RetiredDescriptorPools, [&](const std::pair<u64, VkDescriptorPool>& retired)
+		{
+			if (!isDone(retired.first))
+				return false;
+
+			vkDestroyDescriptorPool(m_CoreData.Device, retired.second, nullptr);
+			return true;
+		});
+	}
+
+	void Renderer::BindGeometryBuffers(VkIndexType indexType)
+	{
+		if (indexType == m_BoundIndexType)
+			return;
+
+		// an arena grew since the buffers were bound
+		if (m_BoundIndexType == VK_INDEX_TYPE_MAX_ENUM)
+		{
+			VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(m_CurrentCommandBuffer, 0, 1, &m_VertexArenaBuffer.Buffer, &offset);
+		}
+
+		m_BoundIndexType = indexType;
+		vkCmdBindIndexBuffer(m_CurrentCommandBuffer, m_IndexArenaBuffer.Buffer, 0, indexType);
+	}
+
+	u64 Renderer::AllocateFromArena(BufferArena& arena, Buffer& buffer, VkBufferUsageFlags usage, u64 size, u64 alignment)
+	{
+		u64 offset = arena.Allocate(size, alignment);
+
+		if (offset != BufferArena::InvalidOffset)
+			return offset;
+
+		u64 capacity = arena.GetCapacity();
+		u64 newCapacity = capacity * 2;
+
+		while (newCapacity < capacity + size + alignment)
+			newCapacity *= 2;
+
+		Buffer grown = CreateBuffer(newCapacity, usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+		// CopyBuffer's barriers order the copy after the uploads already recorded into the old buffer and before
+		// the ones into the new buffer, the old buffer stays until the frames that still bind it are done
+		m_UploadContext.CopyBuffer(buffer.Buffer, grown.Buffer, capacity);
+		m_RetiredBuffers.emplace_back(m_FrameCount, buffer);
+
+		buffer = grown;
+		m_BoundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+		arena.Grow(newCapacity);
+
+		LOG_INFO("Grew a geometry buffer to {} MiB", newCapacity >> 20);
+
+		offset = arena.Allocate(size, alignment);
+		ASSERT(offset != BufferArena::InvalidOffset);
+
+		return offset;
+	}
+
+	void Renderer::BindGraphicsShader(VertexFormat format)
+	{
+		if (format == m_BoundVertexFormat)
+			return;
+
+		m_BoundVertexFormat = format;
+
+		usize index = static_cast<usize>(format);
+		Shader& activeShader = m_WireframeMode ? m_WireframeShaders[index] : m_GraphicsShaders[index];
+
+		vkCmdBindPipeline(m_CurrentCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, activeShader.Pipeline);
+		vkCmdBindDescriptorSets(m_CurrentCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+			activeShader.PipelineLayout, 0, 1, &activeShader.DescriptorSet, 0, nullptr);
+
+		VkDeviceSize offset = 0;
+		m_BoundIndexType = VK_INDEX_TYPE_UINT32;
+
+		vkCmdBindVertexBuffers(m_CurrentCommandBuffer, 0, 1, &m_VertexArenaBuffer.Buffer, &offset);
+		vkCmdBindIndexBuffer(m_CurrentCommandBuffer, m_IndexArenaBuffer.Buffer, 0, m_BoundIndexType);
+	}
+
+	void Renderer::DrawIndexedIndirect(std::span<const VkDrawIndexedIndirectCommand> commands)
+	{
+		if (commands.empty())
+			return;
+
+		if (!m_MultiDrawIndirect || m_IndirectCount + commands.size() > MAX_INDIRECT_DRAWS)
+		{
+			for (const VkDrawIndexedIndirectCommand& command : commands)
+			{
+				vkCmdDrawIndexed(m_CurrentCommandBuffer, command.indexCount, command.instanceCount, command.firstIndex,
+					command.vertexOffset, command.firstInstance);
+			}
+
+			return;
+		}
+
+		usize frame = m_RenderData.CurrentFrame;
+		std::memcpy(m_IndirectCommands[frame] + m_IndirectCount, commands.data(), commands.size_bytes());
+
+		vmaFlushAllocation(m_Allocator, m_IndirectBuffers[frame].Allocation, m_IndirectCount * sizeof(VkDrawIndexedIndirectCommand), commands.size_bytes());
+
+		vkCmdDrawIndexedIndirect(m_CurrentCommandBuffer, m_IndirectBuffers[frame].Buffer, m_IndirectCount * sizeof(VkDrawIndexedIndirectCommand),
+			static_cast<u32>(commands.size()), sizeof(VkDrawIndexedIndirectCommand));
+
+		m_IndirectCount += commands.size();
+	}
+
+	void Renderer::UpdateGPUObject(u32 index, const GPUObject& object)
+	{
+		if (index >= m_GPUObjects.size())
+		{
+			m_GPUObjects.resize(index + 1);
+			m_GPUObjectPending.resize(index + 1, 0);
+		}
+
+		m_GPUObjects[index] = object;
+
+		if (!m_GPUObjectPending[index])
+		{
+			m_GPUObjectPending[index] = 1;
+			m_PendingGPUObjects.push_back(index);
+		}
+	}
+
+	void Renderer::CullGPUObjects(const GPUCullConstants& constants, u32 objectCount)
+	{
+		m_CullConstants = constants;
+		m_CullConstants.ObjectCount = objectCount;
+		m_CullRequested = true;
+	}
+
+	void Renderer::RecordGPUCulling()
+	{
+		m_CullRequested = false;
+
+		usize frame = m_RenderData.CurrentFrame;
+		VkCommandBuffer cmd = m_CurrentCommandBuffer;
+
+		// the last frame's culling wrote the counts and draws, its draws and readback copy read them and the objects
+		VkMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		u32 objectCount = std::max(m_CullConstants.ObjectCount, static_cast<u32>(m_GPUObjects.size()));
+
+		if (objectCount > m_GPUObjectCapacity)
+			GrowGPUObjectBuffers(objectCount);
+
+		m_CullConstants.MaxDrawsPerBucket = m_GPUObjectCapacity;
+
+		// unwritten slots read as GPUInactiveBucket
+		if (!m_GPUObjectsCleared)
+		{
+			vkCmdFillBuffer(cmd, m_GPUObjectBuffer.Buffer, 0, VK_WHOLE_SIZE, ~0u);
+			vkCmdFillBuffer(cmd, m_GPULODStateBuffer.Buffer, 0, VK_WHOLE_SIZE, 0);
+
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+			m_GPUObjectsCleared = true;
+		}
+
+		// pending records go through this frame's staging buffer, runs of consecutive objects become one region
+		usize updateCount = std::min<usize>(m_PendingGPUObjects.size(), MAX_GPU_OBJECT_UPDATES);
+		std::vector<VkBufferCopy> regions;
+
+		for (usize i = 0; i < updateCount; i++)
+		{
+			u32 index = m_PendingGPUObjects[i];
+			m_GPUObjectStaging[frame][i] = m_GPUObjects[index];
+			m_GPUObjectPending[index] = 0;
+
+			VkDeviceSize srcOffset = i * sizeof(GPUObject);
+			VkDeviceSize dstOffset = static_cast<VkDeviceSize>(index) * sizeof(GPUObject);
+
+			if (!regions.empty() && regions.back().srcOffset + regions.back().size == srcOffset && regions.back().dstOffset + regions.back().size == dstOffset)
+				regions.back().size += sizeof(GPUObject);
+			else
+				regions.push_back({ srcOffset, dstOffset, sizeof(GPUObject) });
+		}
+
+		m_PendingGPUObjects.erase(m_PendingGPUObjects.begin(), m_PendingGPUObjects.begin() + static_cast<std::ptrdiff_t>(updateCount));
+
+		if (!regions.empty())
+		{
+			vmaFlushAllocation(m_Allocator, m_GPUObjectStagingBuffers[frame].Allocation, 0, updateCount * sizeof(GPUObject));
+			vkCmdCopyBuffer(cmd, m_GPUObjectStagingBuffers[frame].Buffer, m_GPUObjectBuffer.Buffer, static_cast<u32>(regions.size()), regions.data());
+		}
+
+		vkCmdFillBuffer(cmd, m_GPUDrawCountBuffer.Buffer, 0, VK_WHOLE_SIZE, 0);
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_CullShader.Pipeline);
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_CullShader.PipelineLayout, 0, 1, &m_CullShader.DescriptorSet, 0, nullptr);
+		vkCmdPushConstants(cmd, m_CullShader.PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GPUCullConstants), &m_CullConstants);
+		vkCmdDispatch(cmd, (m_CullConstants.ObjectCount + 63) / 64, 1, 1);
+
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		// read back in BeginFrame once this frame's fence signals, the editor shows them and they make the pass checkable
+		VkBufferCopy countsRegion = { 0, 0, sizeof(u32) * GPUDrawBucketCount + sizeof(GPUCullStats) };
+		vkCmdCopyBuffer(cmd, m_GPUDrawCountBuffer.Buffer, m_GPUCullReadbackBuffers[frame].Buffer, 1, &countsRegion);
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		m_GPUCullReadbackPending[frame] = true;
+		m_CullRecorded = true;
+	}
+
+	void Renderer::GrowGPUObjectBuffers(u32 objectCount)
+	{
+		u32 oldCapacity = m_GPUObjectCapacity;
+		m_GPUObjectCapacity = std::bit_ceil(objectCount);
+
+		Buffer objects = CreateBuffer(sizeof(GPUObject) * m_GPUObjectCapacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+		Buffer lodStates = CreateBuffer(sizeof(u32) * m_GPUObjectCapacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+		Buffer draws = CreateBuffer(sizeof(VkDrawIndexedIndirectCommand) * m_GPUObjectCapacity * GPUDrawBucketCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+		// the objects already on the gpu carry over, objects past them read as GPUInactiveBucket until they're written
+		if (m_GPUObjectsCleared)
+		{
+			VkCommandBuffer cmd = m_CurrentCommandBuffer;
+
+			VkBufferCopy objectRegion = { 0, 0, sizeof(GPUObject) * oldCapacity };
+			VkBufferCopy lodStateRegion = { 0, 0, sizeof(u32) * oldCapacity };
 
-		vmaMapMemory(m_Allocator, stagingBuffer.Allocation, &data);
-		std::memcpy(data, indices.data(), indexBufferSize);
-		vmaUnmapMemory(m_Allocator, stagingBuffer.Allocation);
+			vkCmdCopyBuffer(cmd, m_GPUObjectBuffer.Buffer, objects.Buffer, 1, &objectRegion);
+			vkCmdCopyBuffer(cmd, m_GPULODStateBuffer.Buffer, lodStates.Buffer, 1, &lodStateRegion);
+			vkCmdFillBuffer(cmd, objects.Buffer, objectRegion.size, VK_WHOLE_SIZE, ~0u);
+			vkCmdFillBuffer(cmd, lodStates.Buffer, lodStateRegion.size, VK_WHOLE_SIZE, 0);
 
-		meshBuffers.IndexBuffer = CreateBuffer(
-			indexBufferSize,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+			VkMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+			vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		}
+
+		// the copies above and the frames in flight still use the old buffers
+		m_RetiredBuffers.emplace_back(m_FrameCount, m_GPUObjectBuffer);
+		m_RetiredBuffers.emplace_back(m_FrameCount, m_GPULODStateBuffer);
+		m_RetiredBuffers.emplace_back(m_FrameCount, m_GPUDrawBuffer);
+
+		m_GPUObjectBuffer = objects;
+		m_GPULODStateBuffer = lodStates;
+		m_GPUDrawBuffer = draws;
+
+		m_CullShader.Bindings[0] = DescriptorBinding(m_GPUObjectBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		m_CullShader.Bindings[1] = DescriptorBinding(m_GPUDrawBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		m_CullShader.Bindings[3] = DescriptorBinding(m_GPULODStateBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		ReplaceDescriptorSet(m_CullShader);
+
+		for (usize i = 0; i < VertexFormatCount; i++)
+		{
+			for (Shader* shader : { &m_IndirectShaders[i], &m_IndirectWireframeShaders[i] })
+			{
+				shader->Bindings[2] = DescriptorBinding(m_GPUObjectBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+				ReplaceDescriptorSet(*shader);
+			}
+		}
+
+		LOG_INFO("Grew the gpu object buffers to {} objects", m_GPUObjectCapacity);
+	}
+
+	void Renderer::DrawGPUObjects()
+	{
+		if (!m_CullRecorded)
+			return;
+
+		VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(m_CurrentCommandBuffer, 0, 1, &m_VertexArenaBuffer.Buffer, &offset);
+
+		constexpr std::array indexTypes = { VK_INDEX_TYPE_UINT32, VK_INDEX_TYPE_UINT16 };
+
+		for (usize i = 0; i < VertexFormatCount; i++)
+		{
+			Shader& shader = m_WireframeMode ? m_IndirectWireframeShaders[i] : m_IndirectShaders[i];
+
+			vkCmdBindPipeline(m_CurrentCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader.Pipeline);
+			vkCmdBindDescriptorSets(m_CurrentCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+				shader.PipelineLayout, 0, 1, &shader.DescriptorSet, 0, nullptr);
+
+			for (VkIndexType indexType : indexTypes)
+			{
+				u32 bucket = GetDrawBucket(static_cast<VertexFormat>(i), indexType);
+
+				vkCmdBindIndexBuffer(m_CurrentCommandBuffer, m_IndexArenaBuffer.Buffer, 0, indexType);
+				vkCmdDrawIndexedIndirectCount(m_CurrentCommandBuffer,
+					m_GPUDrawBuffer.Buffer, static_cast<VkDeviceSize>(bucket) * m_GPUObjectCapacity * sizeof(VkDrawIndexedIndirectCommand),
+					m_GPUDrawCountBuffer.Buffer, bucket * sizeof(u32),
+					m_GPUObjectCapacity, sizeof(VkDrawIndexedIndirectCommand));
+			}
+		}
+
+		// none of the graphics pipelines is bound anymore, the next BindGraphicsShader has to bind one
+		m_BoundVertexFormat = static_cast<VertexFormat>(VertexFormatCount);
+		m_BoundIndexType = indexTypes.back();
+	}
+
+	void Renderer::UpdateMaterialsDescriptors()
+	{
+		for (usize i = 0; i < VertexFormatCount; i++)
+		{
+			for (Shader* shader : { &m_GraphicsShaders[i], &m_WireframeShaders[i], &m_IndirectShaders[i], &m_IndirectWireframeShaders[i] })
+			{
+				shader->Bindings[1] = DescriptorBinding(m_MaterialsBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+				UpdateDescriptorSets(*shader);
+			}
+		}
+	}
+
+	Buffer Renderer::CreateDeviceLocalBuffer(std::span<const u8> data, VkBufferUsageFlags usage)
+	{
+		VkDeviceSize size = data.size();
+
+		Buffer buffer = CreateBuffer(
+			size,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage,
 			VMA_MEMORY_USAGE_GPU_ONLY
 		);
 
-		CopyBuffer(stagingBuffer.Buffer, meshBuffers.IndexBuffer.Buffer, indexBufferSize);
-		vmaDestroyBuffer(m_Allocator, stagingBuffer.Buffer, stagingBuffer.Allocation);
+		m_UploadContext.UploadBuffer(buffer.Buffer, 0, data);
 
-		return meshBuffers;
+		return buffer;
 	}
 
 	void Renderer::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
@@ -1377,8 +1991,19 @@ namespace Core
 
 	void Renderer::Cleanup()
 	{
+		m_UploadContext.Cleanup();
 		vkDeviceWaitIdle(m_CoreData.Device);
 
+		for (const auto& [frame, buffer] : m_RetiredBuffers)
+			vmaDestroyBuffer(m_Allocator, buffer.Buffer, buffer.Allocation);
+
+		for (const auto& [frame, pool] : m_RetiredDescriptorPools)
+			vkDestroyDescriptorPool(m_CoreData.Device, pool, nullptr);
+
+		m_RetiredBuffers.clear();
+		m_RetiredDescriptorPools.clear();
+		m_RetiredGeometry.clear();
+
 		for (auto& timestamp : m_Timestamps | std::ranges::views::values)
 		{
 			vkDestroyQueryPool(m_CoreData.Device, timestamp.QueryPool, nullptr);
@@ -1400,8 +2025,14 @@ namespace Core
 		vkDestroyCommandPool(m_CoreData.Device, m_RenderData.CommandPool, nullptr);
 		vkDestroyCommandPool(m_CoreData.Device, m_ImmediateCommandPool, nullptr);
 
-		m_GraphicsShader.Destroy(m_CoreData.Device);
-		m_WireframeShader.Destroy(m_CoreData.Device);
+		for (usize i = 0; i < VertexFormatCount; i++)
+		{
+			m_GraphicsShaders[i].Destroy(m_CoreData.Device);
+			m_WireframeShaders[i].Destroy(m_CoreData.Device);
+			m_IndirectShaders[i].Destroy(m_CoreData.Device);
+			m_IndirectWireframeShaders[i].Destroy(m_CoreData.Device);
+		}
+		m_CullShader.Destroy(m_CoreData.Device);
 		m_BlitShader.Destroy(m_CoreData.Device);
 
 
@@ -1418,6 +2049,24 @@ namespace Core
 
 		vmaDestroyBuffer(m_Allocator, m_VPBuffer.Buffer, m_VPBuffer.Allocation);
 		vmaDestroyBuffer(m_Allocator, m_MaterialsBuffer.Buffer, m_MaterialsBuffer.Allocation);
+		vmaDestroyBuffer(m_Allocator, m_VertexArenaBuffer.Buffer, m_VertexArenaBuffer.Allocation);
+		vmaDestroyBuffer(m_Allocator, m_IndexArenaBuffer.Buffer, m_IndexArenaBuffer.Allocation);
+
+		for (usize i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			vmaUnmapMemory(m_Allocator, m_IndirectBuffers[i].Allocation);
+			vmaDestroyBuffer(m_Allocator, m_IndirectBuffers[i].Buffer, m_IndirectBuffers[i].Allocation);
+
+			vmaUnmapMemory(m_Allocator, m_GPUObjectStagingBuffers[i].Allocation);
+			vmaDestroyBuffer(m_Allocator, m_GPUObjectStagingBuffers[i].Buffer, m_GPUObjectStagingBuffers[i].Allocation);
+			vmaUnmapMemory(m_Allocator, m_GPUCullReadbackBuffers[i].Allocation);
+			vmaDestroyBuffer(m_Allocator, m_GPUCullReadbackBuffers[i].Buffer, m_GPUCullReadbackBuffers[i].Allocation);
+		}
+
+		vmaDestroyBuffer(m_Allocator, m_GPUObjectBuffer.Buffer, m_GPUObjectBuffer.Allocation);
+		vmaDestroyBuffer(m_Allocator, m_GPULODStateBuffer.Buffer, m_GPULODStateBuffer.Allocation);
+		vmaDestroyBuffer(m_Allocator, m_GPUDrawBuffer.Buffer, m_GPUDrawBuffer.Allocation);
+		vmaDestroyBuffer(m_Allocator, m_GPUDrawCountBuffer.Buffer, m_GPUDrawCountBuffer.Allocation);
 
 		vmaDestroyImage(m_Allocator, m_RenderTexture.Image, m_RenderTexture.Allocation);
 		vmaDestroyImage(m_Allocator, m_RenderTextureResolved.Image, m_RenderTextureResolved.Allocation);
@@ -3,30 +3,72 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#include "VirtualFileSystem.h"
+
 namespace Core
 {
 	Texture::~Texture()
 	{
+		Release();
+	}
+
+	void Texture::Release()
+	{
+		if (m_Pixels)
+		{
+			stbi_image_free(m_Pixels);
+			m_Pixels = nullptr;
+		}
+
 		auto& app = Core::Application::Get();
 
 		vkDestroyImageView(app.GetVulkanDevice(), m_Image.View, nullptr);
 		vmaDestroyImage(app.GetVmaAllocator(), m_Image.Image, m_Image.Allocation);
 		vkDestroySampler(app.GetVulkanDevice(), m_Sampler, nullptr);
+
+		m_Image = Image();
+		m_Sampler = VK_NULL_HANDLE;
+	}
+
+	usize Texture::GetCPUMemoryUsage() const noexcept
+	{
+		return m_Pixels ? static_cast<usize>(m_Width) * m_Height * m_Channels : 0;
+	}
+
+	usize Texture::GetGPUMemoryUsage() const noexcept
+	{
+		return m_Image.Image != VK_NULL_HANDLE ? static_cast<usize>(m_Width) * m_Height * m_Channels : 0;
 	}
 
 	void Texture::LoadFromFile(const std::filesystem::path& path)
+	{
+		if (Decode(path))
+			Upload();
+	}
+
+	bool Texture::Decode(const std::filesystem::path& path)
 	{
 		m_Channels = 4;
-		std::string pathStr = path.string();
+		VirtualFile file = VirtualFileSystem::Get().Open(path);
+		std::span<const u8> data = file.GetData();
+
 		int x = 0, y = 0;
-		unsigned char* imageData = stbi_load(pathStr.c_str(), &x, &y, 0, m_Channels);
+		m_Pixels = data.empty() ? nullptr : stbi_load_from_memory(data.data(), static_cast<int>(data.size()), &x, &y, 0, m_Channels);
 
-		if (imageData == nullptr)
-			return;
+		if (m_Pixels == nullptr)
+		{
+			LOG_ERROR("Couldn't load the texture: {}", path.string());
+			return false;
+		}
 
 		m_Width = static_cast<u32>(x);
 		m_Height = static_cast<u32>(y);
 
+		return true;
+	}
+
+	void Texture::Upload()
+	{
 		size_t imageSize = m_Width * m_Height * m_Channels;
 
 		auto& app = Core::Application::Get();
@@ -34,7 +76,6 @@ namespace Core
 		m_Image = app.CreateImage(m_Width, m_Height, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL,
 			VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY, VK_SAMPLE_COUNT_1_BIT);
 
-		app.TransitionImageLayout(m_Image.Image, m_Image.Format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
 		VkSamplerCreateInfo samplerInfo = {};
 		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -50,19 +91,10 @@ namespace Core
 
 		vkCreateSampler(app.GetVulkanDevice(), &samplerInfo, nullptr, &m_Sampler);
 
-		Core::Buffer uploadBuffer = app.CreateBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-
-		void* data;
-		vmaMapMemory(app.GetVmaAllocator(), uploadBuffer.Allocation, &data);
-		memcpy(data, imageData, imageSize);
-		vmaUnmapMemory(app.GetVmaAllocator(), uploadBuffer.Allocation);
-
-		stbi_image_free(imageData);
-
-		app.CopyBufferToImage(uploadBuffer.Buffer, m_Image.Image, m_Width, m_Height);
-		
-		app.TransitionImageLayout(m_Image.Image, m_Image.Format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		// the layout transitions are recorded with the copy, the upload context keeps its own copy of the pixels
+		app.UploadImage(m_Image, std::span<const u8>(m_Pixels, imageSize));
 
-		vmaDestroyBuffer(app.GetVmaAllocator(), uploadBuffer.Buffer, uploadBuffer.Allocation);
+		stbi_image_free(m_Pixels);
+		m_Pixels = nullptr;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "ThreadPool.h"
+
+#include <utility>
+
+namespace Core
+{
+	namespace
+	{
+		thread_local JobPriority t_CurrentPriority = JobPriority::Frame;
+	}
+
+	ThreadPool::ThreadPool(u32 threadCount)
+	{
+		// one worker stays free for frame jobs, unless there's only one
+		m_MaxBackgroundJobs = std::max(threadCount, 2u) - 1;
+		m_Workers.reserve(threadCount);
+
+		for (u32 i = 0; i < threadCount; i++)
+			m_Workers.emplace_back([this]() { WorkerLoop(); });
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Stopping = true;
+		}
+
+		m_JobAvailable.notify_all();
+
+		for (auto& worker : m_Workers)
+			worker.join();
+	}
+
+	ThreadPool& ThreadPool::Get()
+	{
+		static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+		return pool;
+	}
+
+	void ThreadPool::Submit(JobGroup& group, std::function<void()> job)
+	{
+		Submit(group, std::move(job), t_CurrentPriority);
+	}
+
+	void ThreadPool::Submit(JobGroup& group, std::function<void()> job, JobPriority priority)
+	{
+		group.Pending.fetch_add(1, std::memory_order_relaxed);
+
+		{
+			std::lock_guard lock(m_Mutex);
+			(priority == JobPriority::Background ? m_BackgroundJobs : m_Jobs).push_back({ &group, std::move(job), priority });
+		}
+
+		m_JobAvailable.notify_one();
+		// a waiter may be sleeping until a job of its group shows up
+		m_JobFinished.notify_all();
+	}
+
+	void ThreadPool::Wait(JobGroup& group)
+	{
+		while (group.Pending.load(std::memory_order_acquire) != 0)
+		{
+			if (TryRunJob(&group))
+				continue;
+
+			std::unique_lock lock(m_Mutex);
+			m_JobFinished.wait(lock, [&]() { return group.Pending.load(std::memory_order_acquire) == 0 || HasJobOf(group); });
+		}
+
+		if (group.Exception)
+			std::rethrow_exception(std::exchange(group.Exception, nullptr));
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		while (true)
+		{
+			{
+				std::unique_lock lock(m_Mutex);
+				m_JobAvailable.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty() || CanRunBackgroundJob(); });
+
+				if (m_Stopping && m_Jobs.empty() && m_BackgroundJobs.empty())
+					return;
+			}
+
+			TryRunJob(nullptr);
+		}
+	}
+
+	bool ThreadPool::CanRunBackgroundJob() const noexcept
+	{
+		return !m_BackgroundJobs.empty() && (m_RunningBackgroundJobs < m_MaxBackgroundJobs || m_Stopping);
+	}
+
+	bool ThreadPool::HasJobOf(const JobGroup& group) const noexcept
+	{
+		auto inGroup = [&](const Job& job) { return job.Group == &group; };
+		return std::ranges::any_of(m_Jobs, inGroup) || std::ranges::any_of(m_BackgroundJobs, inGroup);
+	}
+
+	bool ThreadPool::TryRunJob(JobGroup* group)
+	{
+		Job job;
+
+		{
+			std::lock_guard lock(m_Mutex);
+
+			if (group)
+			{
+				// the batches being waited on are short, so the scan is too
+				auto take = [&](std::deque<Job>& jobs)
+				{
+					auto it = std::ranges::find_if(jobs, [&](const Job& queued) { return queued.Group == group; });
+
+					if (it == jobs.end())
+						return false;
+
+					job = std::move(*it);
+					jobs.erase(it);
+					return true;
+				};
+
+				if (!take(m_Jobs) && !take(m_BackgroundJobs))
+					return false;
+			}
+			else if (!m_Jobs.empty())
+			{
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+			}
+			else if (CanRunBackgroundJob())
+			{
+				job = std::move(m_BackgroundJobs.front());
+				m_BackgroundJobs.pop_front();
+			}
+			else
+			{
+				return false;
+			}
+
+			if (job.Priority == JobPriority::Background)
+				m_RunningBackgroundJobs++;
+		}
+
+		// a job that throws still has to count as finished, otherwise every Wait on its group hangs
+		std::exception_ptr exception;
+		JobPriority previousPriority = std::exchange(t_CurrentPriority, job.Priority);
+
+		try
+		{
+			job.Function();
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+		}
+
+		t_CurrentPriority = previousPriority;
+
+		{
+			// decrement under the lock so a waiter can't miss the wakeup between its check and its wait
+			std::lock_guard lock(m_Mutex);
+
+			if (exception && !job.Group->Exception)
+				job.Group->Exception = std::move(exception);
+
+			if (job.Priority == JobPriority::Background)
+				m_RunningBackgroundJobs--;
+
+			job.Group->Pending.fetch_sub(1, std::memory_order_release);
+		}
+
+		// a finished background job can let another worker start the next one
+		if (job.Priority == JobPriority::Background)
+			m_JobAvailable.notify_one();
+
+		m_JobFinished.notify_all();
+		return true;
+	}
+}
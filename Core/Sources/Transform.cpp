@@ -1,5 +1,9 @@
 #include "Transform.h"
 
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/matrix_decompose.hpp>
+#include <glm/gtx/euler_angles.hpp>
+
 namespace Core
 {
 	glm::mat4 Transform::GetModelMatrix() const
@@ -15,6 +19,18 @@ namespace Core
 		return model;
 	}
 
+	void Transform::SetFromMatrix(const glm::mat4& matrix)
+	{
+		glm::quat orientation;
+		glm::vec3 skew;
+		glm::vec4 perspective;
+
+		glm::decompose(matrix, Scale, orientation, Position, skew, perspective);
+
+		// GetModelMatrix rotates around y, then x, then z
+		glm::extractEulerAngleYXZ(glm::mat4_cast(orientation), Rotation.y, Rotation.x, Rotation.z);
+	}
+
 	glm::quat Transform::GetRotationQuat() const
 	{
 		return glm::quat(Rotation);
@@ -0,0 +1,224 @@
+#include "TransformBatch.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CORE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(CORE_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// the 8 wide kernel is compiled for avx2 on its own and picked at runtime, the rest of Core stays baseline x64,
+// flatten inlines the generic lane math into it so none of it runs outside the avx2 function
+#if defined(CORE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CORE_AVX2_TARGET __attribute__((target("avx2")))
+#define CORE_AVX2_KERNEL __attribute__((target("avx2"), flatten))
+#if !defined(__clang__)
+// ComposeLanes<AVXLanes> only ever runs inlined into the kernel, the ABI note about passing __m256 doesn't apply
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+#elif defined(CORE_X86)
+#define CORE_AVX2_TARGET
+#define CORE_AVX2_KERNEL
+#endif
+
+namespace Core
+{
+	namespace
+	{
+		// the same math is instantiated for every register width, each backend only wraps the load/store and arithmetic
+		struct ScalarLanes
+		{
+			using Reg = f32;
+			static constexpr usize Width = 1;
+
+			static Reg Load(const f32* ptr) { return *ptr; }
+			static void Store(f32* ptr, Reg value) { *ptr = value; }
+			static Reg Set(f32 value) { return value; }
+			static Reg Add(Reg a, Reg b) { return a + b; }
+			static Reg Sub(Reg a, Reg b) { return a - b; }
+			static Reg Mul(Reg a, Reg b) { return a * b; }
+			static Reg Div(Reg a, Reg b) { return a / b; }
+		};
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		struct SSELanes
+		{
+			using Reg = __m128;
+			static constexpr usize Width = 4;
+
+			static Reg Load(const f32* ptr) { return _mm_loadu_ps(ptr); }
+			static void Store(f32* ptr, Reg value) { _mm_store_ps(ptr, value); }
+			static Reg Set(f32 value) { return _mm_set1_ps(value); }
+			static Reg Add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+			static Reg Sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+			static Reg Mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+			static Reg Div(Reg a, Reg b) { return _mm_div_ps(a, b); }
+		};
+#endif
+
+#if defined(CORE_X86)
+		struct AVXLanes
+		{
+			using Reg = __m256;
+			static constexpr usize Width = 8;
+
+			CORE_AVX2_TARGET static Reg Load(const f32* ptr) { return _mm256_loadu_ps(ptr); }
+			CORE_AVX2_TARGET static void Store(f32* ptr, Reg value) { _mm256_store_ps(ptr, value); }
+			CORE_AVX2_TARGET static Reg Set(f32 value) { return _mm256_set1_ps(value); }
+			CORE_AVX2_TARGET static Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+			CORE_AVX2_TARGET static Reg Sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+			CORE_AVX2_TARGET static Reg Mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+			CORE_AVX2_TARGET static Reg Div(Reg a, Reg b) { return _mm256_div_ps(a, b); }
+		};
+
+		bool DetectAVX2() noexcept
+		{
+#if defined(_MSC_VER)
+			i32 info[4];
+			__cpuid(info, 0);
+
+			if (info[0] < 7)
+				return false;
+
+			// avx needs the os to save the ymm registers, osxsave and xcr0 say whether it does
+			__cpuid(info, 1);
+			bool avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+
+			__cpuidex(info, 7, 0);
+			return avx && (info[1] & (1 << 5));
+#else
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+
+		const bool s_HasAVX2 = DetectAVX2();
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		using WideLanes = SSELanes;
+#else
+		using WideLanes = ScalarLanes;
+#endif
+
+		// composes L::Width transforms starting at index, the matrix elements are computed lane-wise
+		// and then scattered into the AoS glm outputs
+		template<typename L>
+		void ComposeLanes(const TransformSoA& t, usize index, glm::mat4* models, glm::mat3* normals)
+		{
+			using Reg = typename L::Reg;
+
+			Reg x = L::Load(&t.RotationX[index]), y = L::Load(&t.RotationY[index]);
+			Reg z = L::Load(&t.RotationZ[index]), w = L::Load(&t.RotationW[index]);
+
+			Reg two = L::Set(2.0f), one = L::Set(1.0f);
+
+			Reg xx = L::Mul(x, x), yy = L::Mul(y, y), zz = L::Mul(z, z);
+			Reg xy = L::Mul(x, y), xz = L::Mul(x, z), yz = L::Mul(y, z);
+			Reg wx = L::Mul(w, x), wy = L::Mul(w, y), wz = L::Mul(w, z);
+
+			// rotation matrix, rc = column c, row r
+			Reg r[3][3] = {
+				{ L::Sub(one, L::Mul(two, L::Add(yy, zz))), L::Mul(two, L::Add(xy, wz)), L::Mul(two, L::Sub(xz, wy)) },
+				{ L::Mul(two, L::Sub(xy, wz)), L::Sub(one, L::Mul(two, L::Add(xx, zz))), L::Mul(two, L::Add(yz, wx)) },
+				{ L::Mul(two, L::Add(xz, wy)), L::Mul(two, L::Sub(yz, wx)), L::Sub(one, L::Mul(two, L::Add(xx, yy))) }
+			};
+
+			Reg scale[3] = { L::Load(&t.ScaleX[index]), L::Load(&t.ScaleY[index]), L::Load(&t.ScaleZ[index]) };
+
+			// model = R * S scales the columns, its inverse transpose R * S^-1 divides them instead
+			alignas(32) f32 model[3][3][L::Width];
+			alignas(32) f32 normal[3][3][L::Width];
+			alignas(32) f32 position[3][L::Width];
+
+			for (usize c = 0; c < 3; c++)
+			{
+				Reg inverseScale = L::Div(one, scale[c]);
+
+				for (usize row = 0; row < 3; row++)
+				{
+					L::Store(model[c][row], L::Mul(r[c][row], scale[c]));
+					L::Store(normal[c][row], L::Mul(r[c][row], inverseScale));
+				}
+			}
+
+			L::Store(position[0], L::Load(&t.PositionX[index]));
+			L::Store(position[1], L::Load(&t.PositionY[index]));
+			L::Store(position[2], L::Load(&t.PositionZ[index]));
+
+			for (usize lane = 0; lane < L::Width; lane++)
+			{
+				glm::mat4& m = models[index + lane];
+				glm::mat3& n = normals[index + lane];
+
+				for (usize c = 0; c < 3; c++)
+				{
+					m[c] = glm::vec4(model[c][0][lane], model[c][1][lane], model[c][2][lane], 0.0f);
+					n[c] = glm::vec3(normal[c][0][lane], normal[c][1][lane], normal[c][2][lane]);
+				}
+
+				m[3] = glm::vec4(position[0][lane], position[1][lane], position[2][lane], 1.0f);
+			}
+		}
+	}
+
+#if defined(CORE_X86)
+	namespace
+	{
+		// returns where it stopped, the rest doesn't fill a register
+		CORE_AVX2_KERNEL usize ComposeAVX2(const TransformSoA& transforms, usize begin, usize end, glm::mat4* models, glm::mat3* normals)
+		{
+			usize i = begin;
+
+			for (; i + AVXLanes::Width <= end; i += AVXLanes::Width)
+				ComposeLanes<AVXLanes>(transforms, i, models, normals);
+
+			return i;
+		}
+	}
+#endif
+
+	void TransformSoA::Resize(usize count)
+	{
+		m_Count = count;
+
+		for (Array* array : { &PositionX, &PositionY, &PositionZ, &RotationX, &RotationY, &RotationZ, &RotationW, &ScaleX, &ScaleY, &ScaleZ })
+			array->resize(count, 0.0f);
+	}
+
+	void TransformSoA::Set(usize index, const Transform& transform)
+	{
+		// same rotation order as Transform::GetModelMatrix, y then x then z
+		glm::quat rotation = glm::angleAxis(transform.Rotation.y, glm::vec3(0.0f, 1.0f, 0.0f)) *
+			glm::angleAxis(transform.Rotation.x, glm::vec3(1.0f, 0.0f, 0.0f)) *
+			glm::angleAxis(transform.Rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
+
+		PositionX[index] = transform.Position.x;
+		PositionY[index] = transform.Position.y;
+		PositionZ[index] = transform.Position.z;
+		RotationX[index] = rotation.x;
+		RotationY[index] = rotation.y;
+		RotationZ[index] = rotation.z;
+		RotationW[index] = rotation.w;
+		ScaleX[index] = transform.Scale.x;
+		ScaleY[index] = transform.Scale.y;
+		ScaleZ[index] = transform.Scale.z;
+	}
+
+	void ComposeMatrices(const TransformSoA& transforms, usize begin, usize end, glm::mat4* models, glm::mat3* normals)
+	{
+		usize i = begin;
+
+#if defined(CORE_X86)
+		if (s_HasAVX2)
+			i = ComposeAVX2(transforms, i, end, models, normals);
+#endif
+
+		for (; i + WideLanes::Width <= end; i += WideLanes::Width)
+			ComposeLanes<WideLanes>(transforms, i, models, normals);
+
+		for (; i < end; i++)
+			ComposeLanes<ScalarLanes>(transforms, i, models, normals);
+	}
+}
\ No newline at end of file
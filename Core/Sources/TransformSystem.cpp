@@ -0,0 +1,242 @@
+#include "TransformSystem.h"
+
+namespace Core
+{
+	void TransformSystem::Update(ECS& ecs)
+	{
+		bool rebuilt = false;
+
+		if (m_StructureVersion != ecs.GetStructureVersion())
+		{
+			Rebuild(ecs);
+			rebuilt = true;
+		}
+
+		u32 sinceTick = m_LastTick;
+		m_LastTick = ecs.AdvanceTick();
+
+		ThreadPool& threadPool = ThreadPool::Get();
+
+		for (usize level = 0; level + 1 < m_LevelOffsets.size(); level++)
+		{
+			u32 levelBegin = m_LevelOffsets[level];
+			u32 levelEnd = m_LevelOffsets[level + 1];
+
+			threadPool.ParallelFor(levelEnd - levelBegin, 256, [&](usize begin, usize end)
+			{
+				UpdateRange(ecs, levelBegin + begin, levelBegin + end, sinceTick, rebuilt);
+			});
+		}
+	}
+
+	void TransformSystem::UpdateRange(ECS& ecs, usize begin, usize end, u32 sinceTick, bool rebuilt)
+	{
+		for (usize i = begin; i < end; i++)
+		{
+			const Node& node = m_Nodes[i];
+
+			bool localChanged = rebuilt || ecs.ChangedSince<Transform>(node.Handle, sinceTick);
+			bool parentDirty = node.Parent != NoParent && m_Dirty[node.Parent];
+
+			m_LocalChanged[i] = localChanged;
+			m_Dirty[i] = localChanged || parentDirty;
+
+			if (localChanged)
+				m_Locals.Set(i, *node.Local);
+		}
+
+		// compose every run of consecutive changed locals in one call, after a rebuild that's the whole range
+		for (usize i = begin; i < end;)
+		{
+			if (!m_LocalChanged[i])
+			{
+				i++;
+				continue;
+			}
+
+			usize runEnd = i + 1;
+			while (runEnd < end && m_LocalChanged[runEnd])
+				runEnd++;
+
+			ComposeMatrices(m_Locals, i, runEnd, m_LocalMatrices.data(), m_LocalNormals.data());
+			i = runEnd;
+		}
+
+		for (usize i = begin; i < end; i++)
+		{
+			if (!m_Dirty[i])
+				continue;
+
+			const Node& node = m_Nodes[i];
+			ecs.MarkChanged<WorldTransform>(node.Handle);
+
+			if (!node.Link)
+			{
+				node.World->Matrix = m_LocalMatrices[i];
+				node.World->NormalMatrix = m_LocalNormals[i];
+				continue;
+			}
+
+			if (m_LocalChanged[i])
+				node.Link->LocalMatrix = m_LocalMatrices[i];
+
+			// the inverse transpose of a product is the product of the inverse transposes
+			const WorldTransform& parent = *m_Nodes[node.Parent].World;
+			node.World->Matrix = parent.Matrix * m_LocalMatrices[i];
+			node.World->NormalMatrix = parent.NormalMatrix * m_LocalNormals[i];
+		}
+	}
+
+	void TransformSystem::Rebuild(ECS& ecs)
+	{
+		m_Nodes.clear();
+		m_LevelOffsets.clear();
+
+		std::vector<Node> nodes;
+		std::vector<u32> nodeOfEntity; // entity index -> index into nodes
+
+		ecs.View<const Transform, WorldTransform>().Each([&](Entity entity, const Transform& transform, WorldTransform& worldTransform)
+		{
+			if (entity.Index >= nodeOfEntity.size())
+				nodeOfEntity.resize(entity.Index + 1, NoParent);
+
+			nodeOfEntity[entity.Index] = static_cast<u32>(nodes.size());
+			nodes.push_back({ entity, NoParent, &transform, &worldTransform, nullptr });
+		});
+
+		for (Node& node : nodes)
+		{
+			if (!ecs.HasComponent<Hierarchy>(node.Handle))
+				continue;
+
+			Hierarchy* hierarchy = ecs.GetComponent<Hierarchy>(node.Handle);
+			Entity parent = hierarchy->Parent;
+
+			// a destroyed parent leaves the child as a root until it's reparented
+			if (!ecs.IsAlive(parent) || parent.Index >= nodeOfEntity.size() || nodeOfEntity[parent.Index] == NoParent)
+				continue;
+
+			node.Parent = nodeOfEntity[parent.Index];
+			node.Link = hierarchy;
+		}
+
+		std::vector<u32> depths(nodes.size(), NoParent);
+		std::vector<u32> path;
+		u32 maxDepth = 0;
+
+		for (u32 i = 0; i < nodes.size(); i++)
+		{
+			// walk up until a root or a node with a known depth, SetParent guarantees there are no cycles
+			path.clear();
+			u32 current = i;
+
+			while (depths[current] == NoParent)
+			{
+				path.push_back(current);
+
+				if (nodes[current].Parent == NoParent)
+					break;
+
+				current = nodes[current].Parent;
+			}
+
+			u32 depth = depths[current] == NoParent ? 0 : depths[current] + 1;
+
+			for (auto it = path.rbegin(); it != path.rend(); ++it)
+				depths[*it] = depth++;
+
+			maxDepth = std::max(maxDepth, depths[i]);
+		}
+
+		// counting sort by depth, parents always land in an earlier level than their children
+		m_LevelOffsets.assign(maxDepth + 2, 0);
+
+		for (u32 depth : depths)
+			m_LevelOffsets[depth + 1]++;
+
+		for (usize level = 1; level < m_LevelOffsets.size(); level++)
+			m_LevelOffsets[level] += m_LevelOffsets[level - 1];
+
+		std::vector<u32> cursor(m_LevelOffsets.begin(), m_LevelOffsets.end() - 1);
+		std::vector<u32> sortedIndex(nodes.size());
+
+		for (u32 i = 0; i < nodes.size(); i++)
+			sortedIndex[i] = cursor[depths[i]]++;
+
+		m_Nodes.resize(nodes.size());
+
+		for (u32 i = 0; i < nodes.size(); i++)
+		{
+			Node node = nodes[i];
+
+			if (node.Parent != NoParent)
+				node.Parent = sortedIndex[node.Parent];
+
+			m_Nodes[sortedIndex[i]] = node;
+		}
+
+		m_Dirty.assign(m_Nodes.size(), 0);
+		m_LocalChanged.assign(m_Nodes.size(), 0);
+
+		m_Locals.Resize(m_Nodes.size());
+		m_LocalMatrices.resize(m_Nodes.size());
+		m_LocalNormals.resize(m_Nodes.size());
+		m_StructureVersion = ecs.GetStructureVersion();
+	}
+
+	bool TransformSystem::SetParent(ECS& ecs, Entity child, Entity parent, bool keepWorldTransform)
+	{
+		if (!ecs.IsAlive(child))
+		{
+			LOG_ERROR("Entity {} does not exist.", child.Index);
+			return false;
+		}
+
+		for (Entity current = parent; !current.IsNull(); current = GetParent(ecs, current))
+		{
+			if (current == child)
+			{
+				LOG_WARN("Entity {} can't be parented to its own descendant.", child.Index);
+				return false;
+			}
+		}
+
+		if (keepWorldTransform)
+		{
+			glm::mat4 world = GetParentWorldMatrix(ecs, child) * ecs.GetComponent<const Transform>(child)->GetModelMatrix();
+			glm::mat4 parentWorld = parent.IsNull() ? glm::mat4(1.0f) :
+				GetParentWorldMatrix(ecs, parent) * ecs.GetComponent<const Transform>(parent)->GetModelMatrix();
+
+			ecs.Patch<Transform>(child, [&](Transform& transform) { transform.SetFromMatrix(glm::inverse(parentWorld) * world); });
+		}
+
+		// re-adding the component bumps the ECS structure version, which makes every TransformSystem rebuild
+		if (ecs.HasComponent<Hierarchy>(child))
+			ecs.RemoveComponent<Hierarchy>(child);
+
+		if (!parent.IsNull())
+			ecs.AddComponent<Hierarchy>(child)->Parent = parent;
+
+		return true;
+	}
+
+	Entity TransformSystem::GetParent(ECS& ecs, Entity entity)
+	{
+		if (!ecs.IsAlive(entity) || !ecs.HasComponent<Hierarchy>(entity))
+			return NullEntity;
+
+		Entity parent = ecs.GetComponent<const Hierarchy>(entity)->Parent;
+		return ecs.IsAlive(parent) ? parent : NullEntity;
+	}
+
+	glm::mat4 TransformSystem::GetParentWorldMatrix(ECS& ecs, Entity entity)
+	{
+		glm::mat4 matrix = glm::mat4(1.0f);
+
+		// walked from the Transforms rather than read from WorldTransform so it's correct between updates
+		for (Entity parent = GetParent(ecs, entity); !parent.IsNull(); parent = GetParent(ecs, parent))
+			matrix = ecs.GetComponent<const Transform>(parent)->GetModelMatrix() * matrix;
+
+		return matrix;
+	}
+}
\ No newline at end of file
@@ -3,42 +3,33 @@
 
 namespace Core
 {
-	UUID::UUID()
+	UUID::UUID():
+		m_High(s_Rng()),
+		m_Low(s_Rng())
 	{
-		std::random_device rd;
-		std::mt19937_64 gen(rd());
-		std::uniform_int_distribution<uint32_t> dis(0, 15);
-		std::uniform_int_distribution<uint32_t> dis2(8, 11);
+		// version 4 in the high nibble of the 7th byte, RFC 4122 variant in the top bits of the 9th byte
+		m_High = (m_High & 0xFFFFFFFFFFFF0FFFull) | 0x0000000000004000ull;
+		m_Low = (m_Low & 0x3FFFFFFFFFFFFFFFull) | 0x8000000000000000ull;
+	}
 
-		std::stringstream ss;
-		ss << std::hex << std::setfill('0');
+	UUID::operator std::string() const
+	{
+		constexpr char digits[] = "0123456789abcdef";
 
-		for (int i = 0; i < 8; i++) {
-			ss << dis(gen);
-		}
-		ss << "-";
+		std::string result(36, '-');
+		usize pos = 0;
 
-		for (int i = 0; i < 4; i++) {
-			ss << dis(gen);
-		}
-		ss << "-";
+		for (i32 i = 0; i < 32; i++)
+		{
+			if (pos == 8 || pos == 13 || pos == 18 || pos == 23)
+				pos++;
 
-		ss << "4";
-		for (int i = 0; i < 3; i++) {
-			ss << dis(gen);
-		}
-		ss << "-";
-
-		ss << dis2(gen);
-		for (int i = 0; i < 3; i++) {
-			ss << dis(gen);
-		}
-		ss << "-";
+			u64 part = i < 16 ? m_High : m_Low;
+			u32 shift = 60 - (i % 16) * 4;
 
-		for (int i = 0; i < 12; i++) {
-			ss << dis(gen);
+			result[pos++] = digits[(part >> shift) & 0xF];
 		}
 
-		m_UUID = ss.str();
+		return result;
 	}
-}
\ No newline at end of file
+}
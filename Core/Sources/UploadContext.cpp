@@ -0,0 +1,315 @@
+#include "UploadContext.h"
+
+#include <cstring>
+
+#include "Log.h"
+
+namespace Core
+{
+	namespace
+	{
+		// buffer to image copies need 4 byte aligned offsets, 16 keeps every texel format happy
+		constexpr VkDeviceSize StagingAlignment = 16;
+	}
+
+	void UploadContext::Init(VkDevice device, VmaAllocator allocator, VkQueue queue, u32 queueFamily, VkDeviceSize stagingSize)
+	{
+		m_Device = device;
+		m_Allocator = allocator;
+		m_Queue = queue;
+		m_StagingSize = stagingSize;
+
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex = queueFamily;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		vkCreateCommandPool(m_Device, &poolInfo, nullptr, &m_CommandPool);
+		ASSERT(m_CommandPool);
+
+		VkSemaphoreTypeCreateInfo timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		timelineInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &timelineInfo;
+
+		vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_Timeline);
+		ASSERT(m_Timeline);
+
+		VkBufferCreateInfo bufferInfo = {};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = stagingSize;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VmaAllocationCreateInfo allocInfo = {};
+		allocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+
+		VkResult result = vmaCreateBuffer(m_Allocator, &bufferInfo, &allocInfo, &m_Staging.Buffer, &m_Staging.Allocation, nullptr);
+		ASSERT(result == VK_SUCCESS);
+
+		void* data;
+		vmaMapMemory(m_Allocator, m_Staging.Allocation, &data);
+		m_StagingData = static_cast<u8*>(data);
+	}
+
+	void UploadContext::Cleanup()
+	{
+		Wait(Flush());
+		Reclaim();
+
+		vmaUnmapMemory(m_Allocator, m_Staging.Allocation);
+		vmaDestroyBuffer(m_Allocator, m_Staging.Buffer, m_Staging.Allocation);
+
+		vkDestroySemaphore(m_Device, m_Timeline, nullptr);
+		vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
+	}
+
+	void UploadContext::UploadBuffer(VkBuffer buffer, VkDeviceSize offset, std::span<const u8> data)
+	{
+		if (data.empty())
+			return;
+
+		VkBuffer staging;
+		VkDeviceSize stagingOffset;
+		std::memcpy(AllocateStaging(data.size(), staging, stagingOffset), data.data(), data.size());
+
+		VkBufferCopy region = { stagingOffset, offset, data.size() };
+		vkCmdCopyBuffer(GetCommandBuffer(), staging, buffer, 1, &region);
+	}
+
+	void UploadContext::UploadImage(VkImage image, u32 width, u32 height, std::span<const u8> data)
+	{
+		VkBuffer staging;
+		VkDeviceSize stagingOffset;
+		std::memcpy(AllocateStaging(data.size(), staging, stagingOffset), data.data(), data.size());
+
+		VkCommandBuffer cmd = GetCommandBuffer();
+
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		VkBufferImageCopy region = {};
+		region.bufferOffset = stagingOffset;
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageExtent = { width, height, 1 };
+
+		vkCmdCopyBufferToImage(cmd, staging, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		// a transfer queue has no shader stages, the semaphore the reader waits on makes the write visible
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+	void UploadContext::CopyBuffer(VkBuffer source, VkBuffer destination, VkDeviceSize size)
+	{
+		VkCommandBuffer cmd = GetCommandBuffer();
+
+		// the source may have been written earlier in this batch, and later uploads may land in the copied range
+		VkMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		VkBufferCopy region = { 0, 0, size };
+		vkCmdCopyBuffer(cmd, source, destination, 1, &region);
+
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	u64 UploadContext::Flush()
+	{
+		if (m_Recording.CommandBuffer == VK_NULL_HANDLE)
+			return m_SubmittedValue;
+
+		vkEndCommandBuffer(m_Recording.CommandBuffer);
+
+		m_Recording.Value = ++m_SubmittedValue;
+		m_Recording.StagingEnd = m_Head;
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &m_Recording.Value;
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &m_Recording.CommandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &m_Timeline;
+
+		vkQueueSubmit(m_Queue, 1, &submitInfo, VK_NULL_HANDLE);
+
+		m_InFlight.push_back(std::move(m_Recording));
+		m_Recording = {};
+
+		Reclaim();
+
+		return m_SubmittedValue;
+	}
+
+	void UploadContext::Wait(u64 value)
+	{
+		VkSemaphoreWaitInfo waitInfo = {};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &m_Timeline;
+		waitInfo.pValues = &value;
+
+		vkWaitSemaphores(m_Device, &waitInfo, UINT64_MAX);
+	}
+
+	u8* UploadContext::AllocateStaging(VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset)
+	{
+		if (size > m_StagingSize)
+		{
+			// too big for the ring, gets a buffer of its own that goes away with the batch
+			Buffer dedicated;
+
+			VkBufferCreateInfo bufferInfo = {};
+			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferInfo.size = size;
+			bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			VmaAllocationCreateInfo allocInfo = {};
+			allocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+			allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+			VmaAllocationInfo info;
+			VkResult result = vmaCreateBuffer(m_Allocator, &bufferInfo, &allocInfo, &dedicated.Buffer, &dedicated.Allocation, &info);
+			ASSERT(result == VK_SUCCESS);
+
+			m_Recording.RetiredBuffers.push_back(dedicated);
+
+			buffer = dedicated.Buffer;
+			offset = 0;
+
+			return static_cast<u8*>(info.pMappedData);
+		}
+
+		while (true)
+		{
+			u64 position = (m_Head + StagingAlignment - 1) & ~(StagingAlignment - 1);
+
+			// an allocation never wraps, the rest of the ring is skipped instead
+			if (position % m_StagingSize + size > m_StagingSize)
+				position += m_StagingSize - position % m_StagingSize;
+
+			if (position + size - m_Tail <= m_StagingSize)
+			{
+				m_Head = position + size;
+				buffer = m_Staging.Buffer;
+				offset = position % m_StagingSize;
+
+				return m_StagingData + offset;
+			}
+
+			// the ring is full of data the gpu hasn't copied yet, only here does the cpu wait
+			Reclaim();
+
+			if (position + size - m_Tail <= m_StagingSize)
+				continue;
+
+			// the bytes already staged for this batch stay in the ring until it completes
+			if (m_Recording.CommandBuffer != VK_NULL_HANDLE)
+				Flush();
+
+			if (!m_InFlight.empty())
+			{
+				Wait(m_InFlight.front().Value);
+				Reclaim();
+			}
+		}
+	}
+
+	VkCommandBuffer UploadContext::GetCommandBuffer()
+	{
+		if (m_Recording.CommandBuffer != VK_NULL_HANDLE)
+			return m_Recording.CommandBuffer;
+
+		if (m_FreeCommandBuffers.empty())
+		{
+			VkCommandBufferAllocateInfo allocInfo = {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.commandPool = m_CommandPool;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandBufferCount = 1;
+
+			VkCommandBuffer commandBuffer;
+			vkAllocateCommandBuffers(m_Device, &allocInfo, &commandBuffer);
+			m_FreeCommandBuffers.push_back(commandBuffer);
+		}
+
+		m_Recording.CommandBuffer = m_FreeCommandBuffers.back();
+		m_FreeCommandBuffers.pop_back();
+
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		vkBeginCommandBuffer(m_Recording.CommandBuffer, &beginInfo);
+
+		// orders this batch's copies after the earlier batches' on the same queue, a grown buffer is copied from
+		// memory the previous batches wrote
+		VkMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		vkCmdPipelineBarrier(m_Recording.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		return m_Recording.CommandBuffer;
+	}
+
+	void UploadContext::Reclaim()
+	{
+		u64 completed = 0;
+		vkGetSemaphoreCounterValue(m_Device, m_Timeline, &completed);
+
+		while (!m_InFlight.empty() && m_InFlight.front().Value <= completed)
+		{
+			Batch& batch = m_InFlight.front();
+
+			for (const Buffer& buffer : batch.RetiredBuffers)
+				vmaDestroyBuffer(m_Allocator, buffer.Buffer, buffer.Allocation);
+
+			if (batch.CommandBuffer != VK_NULL_HANDLE)
+			{
+				vkResetCommandBuffer(batch.CommandBuffer, 0);
+				m_FreeCommandBuffers.push_back(batch.CommandBuffer);
+			}
+
+			m_Tail = batch.StagingEnd;
+			m_InFlight.pop_front();
+		}
+
+		// with nothing pending the whole ring is free, starting over at its beginning lets any size fit
+		if (m_InFlight.empty() && m_Recording.CommandBuffer == VK_NULL_HANDLE)
+		{
+			m_Head = (m_Head + m_StagingSize - 1) / m_StagingSize * m_StagingSize;
+			m_Tail = m_Head;
+		}
+	}
+}
\ No newline at end of file
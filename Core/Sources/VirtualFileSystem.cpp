@@ -0,0 +1,75 @@
+#include "VirtualFileSystem.h"
+
+#include "Hash.h"
+#include "Log.h"
+
+namespace Core
+{
+	VirtualFile::VirtualFile(std::span<const u8> packedData, u64 contentHash) :
+		m_Data(packedData), m_ContentHash(contentHash), m_Open(true), m_Packed(true)
+	{
+	}
+
+	VirtualFile::VirtualFile(MappedFile mapping) :
+		m_Mapping(std::move(mapping)), m_Data(m_Mapping.GetData()), m_Open(true)
+	{
+	}
+
+	u64 VirtualFile::GetContentHash() const
+	{
+		if (!m_ContentHash)
+			m_ContentHash = HashBytes(m_Data);
+
+		return *m_ContentHash;
+	}
+
+	VirtualFileSystem& VirtualFileSystem::Get()
+	{
+		static VirtualFileSystem fileSystem;
+		return fileSystem;
+	}
+
+	bool VirtualFileSystem::Mount(const std::filesystem::path& packPath, const std::filesystem::path& mountPoint)
+	{
+		auto mount = std::make_unique<MountedPack>();
+
+		if (!mount->Pack.Open(packPath))
+			return false;
+
+		mount->MountPoint = mountPoint.lexically_normal();
+		m_Mounts.push_back(std::move(mount));
+
+		LOG_INFO("Mounted {} at {}", packPath.string(), mountPoint.string());
+		return true;
+	}
+
+	VirtualFile VirtualFileSystem::Open(const std::filesystem::path& path) const
+	{
+		std::filesystem::path normalized = path.lexically_normal();
+
+		// lexical only, resolving the paths on disk would cost the stat calls packs are meant to save
+		for (auto it = m_Mounts.rbegin(); it != m_Mounts.rend(); it++)
+		{
+			std::filesystem::path relative = normalized.lexically_relative((*it)->MountPoint);
+
+			if (relative.empty() || *relative.begin() == "..")
+				continue;
+
+			if (const PackEntry* entry = (*it)->Pack.Find(relative))
+				return VirtualFile((*it)->Pack.GetData(*entry), entry->ContentHash);
+		}
+
+		MappedFile mapping(path);
+
+		if (mapping.IsOpen())
+			return VirtualFile(std::move(mapping));
+
+		// empty files can't be mapped but are still valid files
+		std::error_code error;
+
+		if (std::filesystem::is_regular_file(path, error))
+			return VirtualFile(MappedFile());
+
+		return {};
+	}
+}
\ No newline at end of file
@@ -3,6 +3,7 @@ project "Core"
     language "C++"
     cppdialect "C++23"
     staticruntime "on"
+    rtti "Off"
 
     targetdir("../bin/" .. outputdir .. "/%{prj.name}")
     objdir("../bin-int/" .. outputdir .. "/%{prj.name}")
@@ -50,6 +51,9 @@ project "Core"
     
     filter "system:linux"
         links { "vulkan" }
+        prebuildcommands {
+            "cd %{prj.location} && sh Scripts/compile_shaders.sh"
+        }
 
     filter "configurations:Debug"
         runtime "Debug"
@@ -2,9 +2,14 @@
 
 #include <memory>
 #include <vector>
+#include <array>
 #include <unordered_set>
+#include <unordered_map>
+#include <limits>
 #include <numeric>
 #include <concepts>
+#include <algorithm>
+#include <cmath>
 
 //required to include before glfw
 #include "PortableFileDialogs.h"
@@ -18,6 +23,8 @@
 #include "Application.h"
 #include "Layer.h"
 #include "ECS.h"
+#include "TransformSystem.h"
+#include "GPUScene.h"
 #include "Camera.h"
 #include "Object.h"
 #include "Mesh.h"
@@ -31,6 +38,7 @@
 #include "AssetManager.h"
 #include "Project.h"
 #include "Texture.h"
+#include "AssetPack.h"
 
 
 class Editor : public Core::Layer
@@ -61,12 +69,16 @@ public:
 private:
 	void InitImGui();
 	void InitGizmos();
+	void SetAssetMemoryBudget();
 
 	void RenderImGui();
 
 	void UpdateVPData();
 	void UpdateMaterialsBuffer();
-	void PushConstants(Core::Object* obj);
+	void UpdateWorldTransforms();
+	void PushConstants(Core::Entity entity, const Core::WorldTransform& worldTransform, const Core::Mesh& mesh);
+	[[nodiscard]] u32 GetMaterialIndex(Core::Entity entity);
+	void CullGPUScene(Core::Application& app);
 
 	void RenderObjects(Core::Application& app);
 	void RenderGizmos(Core::Application& app);
@@ -84,6 +96,13 @@ private:
 	bool TestObjectClick();
 
 	Core::Ray GetMouseRay();
+	Core::Object* FindObject(Core::Entity entity);
+
+	// computed from the Transforms, so they're correct in the middle of a drag before the next TransformSystem update
+	glm::mat4 GetWorldMatrix(Core::Object* object);
+	void SetWorldPosition(Core::Object* object, const glm::vec3& position);
+
+	void DrawHierarchyNode(Core::Object* object, const std::unordered_map<u32, std::vector<Core::Object*>>& children);
 
 	// Gizmo manipulation methods taken from TinyGizmos implementation (https://github.com/ddiakopoulos/tinygizmo)
 	void PlaneTranslationDragger(const glm::vec3& planeNormal, glm::vec3& point);
@@ -95,6 +114,7 @@ private:
 private:
 	std::unique_ptr<Core::AssetManager> m_AssetManager;
 	Core::ECS m_ECS;
+	Core::ECS m_GizmoECS; // kept apart so scene views never see the gizmo handles
 	Core::Camera m_Camera;
 
 	f64 m_LastMouseX = 0.0;
@@ -104,6 +124,19 @@ private:
 	Core::Object* m_SelectedObject = nullptr;
 
 	std::vector<Core::Material*> m_Materials;
+	std::unordered_map<Core::UUID, u32> m_MaterialIndices;
+	u32 m_MaterialsVersion = std::numeric_limits<u32>::max();
+
+	Core::TransformSystem m_TransformSystem;
+	Core::GPUScene m_GPUScene;
+	bool m_GPUDrivenRendering = true;
+
+	// last lod drawn per entity index, SelectLOD starts from it so switches have hysteresis
+	std::vector<u8> m_MeshLODs;
+	u64 m_RenderedTriangles = 0;
+	u32 m_VisibleMeshlets = 0;
+	u32 m_TotalMeshlets = 0;
+	std::vector<VkDrawIndexedIndirectCommand> m_MeshletDraws; // reused by every mesh each frame
 
 	std::vector<std::unique_ptr<Gizmo>> m_Gizmos;
 	GizmoType m_ActiveGizmoType = GizmoType::Translate;
@@ -117,10 +150,11 @@ private:
 	std::filesystem::path m_ShaderDirectory = std::filesystem::path(PATH_TO_SHADERS);
 	std::filesystem::path m_IconsDirectory = std::filesystem::path(PATH_TO_ICONS);
 
-	Core::Shader m_OutlineShader;
-	Core::Shader m_OutlineFillShader;
+	// indexed by Core::VertexFormat
+	std::array<Core::Shader, Core::VertexFormatCount> m_OutlineShaders;
+	std::array<Core::Shader, Core::VertexFormatCount> m_OutlineFillShaders;
 	Core::Shader m_DebugLineShader;
-	Core::Shader m_GizmoShader;
+	std::array<Core::Shader, Core::VertexFormatCount> m_GizmoShaders;
 
 	usize m_MaxMaterials = 20;
 
@@ -6,6 +6,7 @@
 #include <vector>
 #include <memory>
 #include <ranges>
+#include <unordered_map>
 
 #include "Object.h"
 #include "AssetManager.h"
@@ -14,6 +15,11 @@
 class Project
 {
 public:
+	static constexpr u32 HierarchyMagic = 0x52454948; // "HIER"
+	static constexpr u32 NoParentIndex = 0xFFFFFFFF;
+	// built from the Content directory next to it, mounted over it when the project opens
+	static constexpr const char* ContentPackName = "Content.vkpack";
+
 	static Project* Load(const std::filesystem::path& path);
 
 	void Save(const std::vector<std::unique_ptr<Core::Object>>& objects, Core::AssetManager* assetManager) const;
@@ -33,39 +33,14 @@ void DebugLine::CreateBuffers(const glm::vec3& start, const glm::vec3& end)
 
 	std::array<glm::vec3, 2> vertices = { start, end };
 
-	Core::Buffer stagingBuffer = app.CreateBuffer(
-		sizeof(glm::vec3) * vertices.size(),
-		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VMA_MEMORY_USAGE_CPU_ONLY
-	);
-
 	m_VertexBuffer = app.CreateBuffer(sizeof(glm::vec3) * vertices.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
-
-	void* data;
-	vmaMapMemory(app.GetVmaAllocator(), stagingBuffer.Allocation, &data);
-	std::memcpy(data, vertices.data(), sizeof(glm::vec3) * vertices.size());
-	vmaUnmapMemory(app.GetVmaAllocator(), stagingBuffer.Allocation);
-
-	app.CopyBuffer(stagingBuffer.Buffer, m_VertexBuffer.Buffer, sizeof(glm::vec3) * vertices.size());
-	vmaDestroyBuffer(app.GetVmaAllocator(), stagingBuffer.Buffer, stagingBuffer.Allocation);
+	app.UploadBuffer(m_VertexBuffer.Buffer, 0, std::span<const u8>(reinterpret_cast<const u8*>(vertices.data()), sizeof(glm::vec3) * vertices.size()));
 
 	if (!s_Instances)
 	{
 		std::array<u32, 2> indices = { 0, 1 };
 
-		stagingBuffer = app.CreateBuffer(
-			sizeof(u32) * indices.size(),
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VMA_MEMORY_USAGE_CPU_ONLY
-		);
-
 		s_IndexBuffer = app.CreateBuffer(sizeof(u32) * indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
-
-		vmaMapMemory(app.GetVmaAllocator(), stagingBuffer.Allocation, &data);
-		std::memcpy(data, indices.data(), sizeof(u32) * indices.size());
-		vmaUnmapMemory(app.GetVmaAllocator(), stagingBuffer.Allocation);
-
-		app.CopyBuffer(stagingBuffer.Buffer, s_IndexBuffer.Buffer, sizeof(u32) * indices.size());
-		vmaDestroyBuffer(app.GetVmaAllocator(), stagingBuffer.Buffer, stagingBuffer.Allocation);
+		app.UploadBuffer(s_IndexBuffer.Buffer, 0, std::span<const u8>(reinterpret_cast<const u8*>(indices.data()), sizeof(u32) * indices.size()));
 	}
 }
\ No newline at end of file
@@ -24,13 +24,45 @@ namespace
 		auto rel = std::filesystem::relative(path, base);
 		return !rel.empty() && rel.native()[0] != '.';
 	}
+
+	enum class ProjectAssetType : u8
+	{
+		Mesh,
+		Material,
+		Texture
+	};
+
+	struct ProjectAsset
+	{
+		std::filesystem::path Path;
+		ProjectAssetType Type;
+		Core::AssetHandle<> Handle;
+	};
+
+	// an object read from .Content, created only after the assets it references are loaded
+	struct ProjectObject
+	{
+		std::string Name;
+		glm::vec3 Position = glm::vec3(0.0f);
+		glm::vec3 Rotation = glm::vec3(0.0f);
+		glm::vec3 Scale = glm::vec3(1.0f);
+		std::vector<u32> Assets; // indices into the unique asset list
+		u32 Parent = Project::NoParentIndex;
+	};
+
+	template<std::derived_from<Core::Asset> T>
+	void AddProjectAsset(Core::Object& object, Core::AssetHandle<> handle)
+	{
+		object.AddComponent<T>(Core::AssetHandle<T>{ handle.Index, handle.Generation });
+	}
 }
 
 Editor::Editor():
-	m_AssetManager(std::make_unique<Core::AssetManager>()), m_ECS(m_AssetManager.get())
+	m_AssetManager(std::make_unique<Core::AssetManager>()), m_ECS(m_AssetManager.get()), m_GizmoECS(m_AssetManager.get())
 {
 	auto& app = Core::Application::Get();
 	s_MaxLineWidth = app.GetPhysicalDeviceLimits().lineWidthRange[1];
+	m_GPUDrivenRendering = app.SupportsMultiDrawIndirect();
 
 	app.SetCursorState(GLFW_CURSOR_DISABLED);
 	app.SetBackgroundColor({0.0f, 0.0f, 0.0f, 1.0f});
@@ -52,8 +84,14 @@ Editor::Editor():
 	glm::vec2 framebufferSize = app.GetWindow().GetFramebufferSize();
 	m_Camera.AspectRatio = static_cast<f32>(framebufferSize.x) / static_cast<f32>(framebufferSize.y);
 
+	// drawn in place of meshes that are still loading
+	m_AssetManager->SetPlaceholder(m_AssetManager->Load<Core::Mesh>(std::filesystem::path(PATH_TO_OBJS) / "Cube.obj"));
+
 	m_DirectoryIcon = m_AssetManager->Load<Core::Texture>(m_IconsDirectory / "Directory.png");
 	m_DirectoryIcon->SetDescriptorSet(ImGui_ImplVulkan_AddTexture(m_DirectoryIcon->GetSampler(), m_DirectoryIcon->GetImage().View, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+	m_AssetManager->Pin(m_DirectoryIcon->GetID());
+
+	SetAssetMemoryBudget();
 
 	auto openExistingProject = pfd::message("Opening an existing project", "Do you want to open an existing project?", pfd::choice::yes_no, pfd::icon::question);
 
@@ -65,6 +103,12 @@ Editor::Editor():
 			std::filesystem::path projectPath = projectFileDialog.result()[0];
 			m_CurrentProject.reset(Project::Load(projectPath));
 			m_CurrentProjectContentPath = projectPath.parent_path() / "Content";
+
+			std::filesystem::path packPath = m_CurrentProject->GetPath() / Project::ContentPackName;
+
+			if (std::filesystem::exists(packPath))
+				m_AssetManager->MountPack(packPath, m_CurrentProjectContentPath);
+
 			LoadProjectContent();
 
 			LOG_INFO("Loaded project: {}", projectPath.string());
@@ -89,30 +133,62 @@ Editor::~Editor()
 	ImGui::DestroyContext();
 
 	vkDestroyDescriptorPool(app.GetVulkanDevice(), m_ImGuiDescriptorPool, nullptr);
-	m_OutlineShader.Destroy(app.GetVulkanDevice());
-	m_OutlineFillShader.Destroy(app.GetVulkanDevice());
+	for (usize i = 0; i < Core::VertexFormatCount; i++)
+	{
+		m_OutlineShaders[i].Destroy(app.GetVulkanDevice());
+		m_OutlineFillShaders[i].Destroy(app.GetVulkanDevice());
+		m_GizmoShaders[i].Destroy(app.GetVulkanDevice());
+	}
+
 	m_DebugLineShader.Destroy(app.GetVulkanDevice());
-	m_GizmoShader.Destroy(app.GetVulkanDevice());
 
 	m_DebugLines.clear();
 	m_Gizmos.clear();
+	// objects release their asset references when destroyed
+	m_SelectedObject = nullptr;
+	m_Objects.clear();
 	m_AssetManager.reset();
 }
 
 void Editor::InitGizmos()
 {
-	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_ECS, m_AssetManager.get(), GizmoType::Translate, GizmoAxis::X));
-	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_ECS, m_AssetManager.get(), GizmoType::Translate, GizmoAxis::Y));
-	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_ECS, m_AssetManager.get(), GizmoType::Translate, GizmoAxis::Z));
+	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_GizmoECS, m_AssetManager.get(), GizmoType::Translate, GizmoAxis::X));
+	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_GizmoECS, m_AssetManager.get(), GizmoType::Translate, GizmoAxis::Y));
+	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_GizmoECS, m_AssetManager.get(), GizmoType::Translate, GizmoAxis::Z));
 
 	
-	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_ECS, m_AssetManager.get(), GizmoType::Rotate, GizmoAxis::X));
-	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_ECS, m_AssetManager.get(), GizmoType::Rotate, GizmoAxis::Y));
-	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_ECS, m_AssetManager.get(), GizmoType::Rotate, GizmoAxis::Z));
+	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_GizmoECS, m_AssetManager.get(), GizmoType::Rotate, GizmoAxis::X));
+	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_GizmoECS, m_AssetManager.get(), GizmoType::Rotate, GizmoAxis::Y));
+	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_GizmoECS, m_AssetManager.get(), GizmoType::Rotate, GizmoAxis::Z));
+
+	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_GizmoECS, m_AssetManager.get(), GizmoType::Scale, GizmoAxis::X));
+	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_GizmoECS, m_AssetManager.get(), GizmoType::Scale, GizmoAxis::Y));
+	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_GizmoECS, m_AssetManager.get(), GizmoType::Scale, GizmoAxis::Z));
+}
+
+void Editor::SetAssetMemoryBudget()
+{
+	auto& app = Core::Application::Get();
+
+	const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+	vmaGetMemoryProperties(app.GetVmaAllocator(), &memoryProperties);
+
+	VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+	vmaGetHeapBudgets(app.GetVmaAllocator(), budgets);
+
+	usize deviceBudget = 0;
+
+	for (u32 i = 0; i < memoryProperties->memoryHeapCount; i++)
+	{
+		if (memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			deviceBudget += budgets[i].budget;
+	}
+
+	// the rest of the device memory is left to render targets, pipelines and other processes
+	constexpr usize cpuBudget = 1024ull * 1024 * 1024;
+	m_AssetManager->SetMemoryBudget(cpuBudget, deviceBudget / 2);
 
-	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_ECS, m_AssetManager.get(), GizmoType::Scale, GizmoAxis::X));
-	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_ECS, m_AssetManager.get(), GizmoType::Scale, GizmoAxis::Y));
-	m_Gizmos.emplace_back(std::make_unique<Gizmo>(m_ECS, m_AssetManager.get(), GizmoType::Scale, GizmoAxis::Z));
+	LOG_INFO("Asset memory budget: {} MiB cpu, {} MiB gpu", cpuBudget >> 20, (deviceBudget / 2) >> 20);
 }
 
 void Editor::OnEvent(Core::Event& event)
@@ -141,20 +217,77 @@ void Editor::OnRender()
 
 void Editor::RenderObjects(Core::Application& app)
 {
-	for (const auto& obj : m_Objects)
+	// pixels one world unit at distance 1 covers vertically, divided by the distance per object
+	const f32 pixelsPerUnitAtOne = static_cast<f32>(app.GetSwapchain().extent.height) / (2.0f * std::tan(glm::radians(m_Camera.Fov) * 0.5f));
+
+	const glm::mat4 viewProjection = m_Camera.GetProjectionMatrix() * m_Camera.GetViewMatrix();
+
+	m_RenderedTriangles = 0;
+	m_VisibleMeshlets = 0;
+	m_TotalMeshlets = 0;
+
+	if (m_GPUDrivenRendering)
 	{
-		if (obj->HasComponent<Core::Mesh>() && obj->IsVisible())
-		{
-			PushConstants(obj.get());
-			DrawObject(obj.get());
-		}
+		// the counts are from the frame that last used this frame's slot
+		app.DrawGPUObjects();
+		m_RenderedTriangles = app.GetGPUCullStats().VisibleTriangles;
+		return;
 	}
+
+	m_ECS.View<const Core::WorldTransform, Core::Mesh, const Core::Visibility>().Each(
+		[&](Core::Entity entity, const Core::WorldTransform& worldTransform, Core::Mesh& mesh, const Core::Visibility& visibility)
+		{
+			if (!visibility.IsVisible)
+				return;
+
+			// lod errors are in mesh units, the largest axis scale turns them into world units
+			const glm::mat4& matrix = worldTransform.Matrix;
+			f32 scale = std::max({ glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2])) });
+
+			const Core::MeshBounds& bounds = mesh.GetBounds();
+			glm::vec3 center = glm::vec3(matrix * glm::vec4((bounds.Min + bounds.Max) * 0.5f, 1.0f));
+			f32 radius = glm::length(bounds.Max - bounds.Min) * 0.5f * scale;
+			f32 distance = glm::length(center - m_Camera.Position) - radius;
+
+			if (entity.Index >= m_MeshLODs.size())
+				m_MeshLODs.resize(entity.Index + 1, 0);
+
+			u32 lod = distance <= 0.0f ? 0 : mesh.SelectLOD(pixelsPerUnitAtOne * scale / distance, m_MeshLODs[entity.Index]);
+			m_MeshLODs[entity.Index] = static_cast<u8>(lod);
+
+			app.BindGraphicsShader(mesh.GetVertexFormat());
+			PushConstants(entity, worldTransform, mesh);
+
+			// coarser levels are small on screen already, only level 0 is split into meshlets
+			if (lod == 0 && mesh.GetMeshlets().size() > 1)
+			{
+				// wireframe draws back faces too and a mirroring transform flips which side gets culled,
+				// both only get the frustum test
+				glm::vec3 cameraPosition = glm::vec3(glm::inverse(matrix) * glm::vec4(m_Camera.Position, 1.0f));
+				bool coneCulling = !m_WireframeMode && glm::determinant(glm::mat3(matrix)) > 0.0f;
+
+				m_MeshletDraws.clear();
+				m_VisibleMeshlets += mesh.CullMeshlets(viewProjection * matrix, cameraPosition, coneCulling, m_MeshletDraws);
+				m_TotalMeshlets += static_cast<u32>(mesh.GetMeshlets().size());
+
+				for (const VkDrawIndexedIndirectCommand& draw : m_MeshletDraws)
+					m_RenderedTriangles += draw.indexCount / 3;
+
+				mesh.DrawIndirect(app.GetCurrentCommandBuffer(), m_MeshletDraws);
+				return;
+			}
+
+			const auto& lods = mesh.GetLODs();
+			m_RenderedTriangles += lod < lods.size() ? lods[lod].IndexCount / 3 : 0;
+
+			mesh.Draw(app.GetCurrentCommandBuffer(), lod);
+		});
 }
 
 void Editor::DrawObject(Core::Object* object)
 {
-	auto mesh = object->GetComponent<Core::Mesh>();
-	mesh->Draw(Core::Application::Get().GetCurrentCommandBuffer());
+	if (auto mesh = object->GetComponent<Core::Mesh>())
+		mesh->Draw(Core::Application::Get().GetCurrentCommandBuffer());
 }
 
 void Editor::RenderGizmos(Core::Application& app)
@@ -162,15 +295,11 @@ void Editor::RenderGizmos(Core::Application& app)
 	if (!m_SelectedObject)
 		return;
 
-	vkCmdBindPipeline(app.GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, m_GizmoShader.Pipeline);
-	vkCmdBindDescriptorSets(app.GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS,
-		m_GizmoShader.PipelineLayout, 0, 1, &m_GizmoShader.DescriptorSet, 0, nullptr);
-
 	u32 start = m_ActiveGizmoType == GizmoType::Translate ? 0 :
 		m_ActiveGizmoType == GizmoType::Rotate ? 3 : 6;
 	u32 end = start + 3;
 
-	const glm::vec3& objPosition = m_SelectedObject->GetComponent<Core::Transform>()->Position;
+	const glm::vec3 objPosition = glm::vec3(GetWorldMatrix(m_SelectedObject)[3]);
 	const glm::vec3& cameraPos = m_Camera.Position;
 
 	f32 distance = glm::length(cameraPos - objPosition);
@@ -195,10 +324,17 @@ void Editor::RenderGizmos(Core::Application& app)
 			pc.Color = gizmo->GetColor();
 		}
 
-		pc.Model = gizmo->GetModelMatrix();
+		Core::Mesh* mesh = gizmo->GetComponent<Core::Mesh>();
+		Core::Shader& gizmoShader = m_GizmoShaders[static_cast<usize>(mesh->GetVertexFormat())];
+
+		vkCmdBindPipeline(app.GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, gizmoShader.Pipeline);
+		vkCmdBindDescriptorSets(app.GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS,
+			gizmoShader.PipelineLayout, 0, 1, &gizmoShader.DescriptorSet, 0, nullptr);
 
-		vkCmdPushConstants(app.GetCurrentCommandBuffer(), m_GizmoShader.PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(GizmoPushConstants), &pc);
-		gizmo->GetComponent<Core::Mesh>()->Draw(app.GetCurrentCommandBuffer());
+		pc.Model = gizmo->GetModelMatrix() * mesh->GetDequantizationMatrix();
+
+		vkCmdPushConstants(app.GetCurrentCommandBuffer(), gizmoShader.PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(GizmoPushConstants), &pc);
+		mesh->Draw(app.GetCurrentCommandBuffer());
 	}
 }
 
@@ -207,23 +343,33 @@ void Editor::RenderSelectedObjectOutline(Core::Application& app)
 	if (!m_SelectedObject || !m_SelectedObject->HasComponent<Core::Mesh>())
 		return;
 
-	vkCmdBindPipeline(app.GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, m_OutlineShader.Pipeline);
+	// null while the mesh is loading
+	Core::Mesh* mesh = m_SelectedObject->GetComponent<Core::Mesh>();
+
+	if (!mesh)
+		return;
+
+	usize format = static_cast<usize>(mesh->GetVertexFormat());
+	Core::Shader& outlineShader = m_OutlineShaders[format];
+	Core::Shader& outlineFillShader = m_OutlineFillShaders[format];
+
+	vkCmdBindPipeline(app.GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, outlineShader.Pipeline);
 	vkCmdBindDescriptorSets(app.GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS,
-		m_OutlineShader.PipelineLayout, 0, 1, &m_OutlineShader.DescriptorSet, 0, nullptr);
+		outlineShader.PipelineLayout, 0, 1, &outlineShader.DescriptorSet, 0, nullptr);
 	vkCmdSetLineWidth(app.GetCurrentCommandBuffer(), 3.0f);
 
-	glm::mat4 modelMatrix = m_SelectedObject->GetComponent<Core::Transform>()->GetModelMatrix();
+	glm::mat4 modelMatrix = m_SelectedObject->GetComponent<const Core::WorldTransform>()->Matrix * mesh->GetDequantizationMatrix();
 
-	vkCmdPushConstants(app.GetCurrentCommandBuffer(), m_OutlineShader.PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+	vkCmdPushConstants(app.GetCurrentCommandBuffer(), outlineShader.PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
 		sizeof(glm::mat4), &modelMatrix);
 
 	DrawObject(m_SelectedObject);
 
-	vkCmdBindPipeline(app.GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, m_OutlineFillShader.Pipeline);
+	vkCmdBindPipeline(app.GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, outlineFillShader.Pipeline);
 	vkCmdBindDescriptorSets(app.GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS,
-		m_OutlineFillShader.PipelineLayout, 0, 1, &m_OutlineFillShader.DescriptorSet, 0, nullptr);
+		outlineFillShader.PipelineLayout, 0, 1, &outlineFillShader.DescriptorSet, 0, nullptr);
 
-	vkCmdPushConstants(app.GetCurrentCommandBuffer(), m_OutlineFillShader.PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+	vkCmdPushConstants(app.GetCurrentCommandBuffer(), outlineFillShader.PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
 		sizeof(glm::mat4), &modelMatrix);
 
 	DrawObject(m_SelectedObject);
@@ -262,9 +408,20 @@ void Editor::UpdateVPData()
 
 void Editor::UpdateMaterialsBuffer()
 {
+	// materials are immutable once loaded, so the table only changes when assets are loaded
+	if (m_MaterialsVersion == m_AssetManager->GetVersion())
+		return;
+
+	m_MaterialsVersion = m_AssetManager->GetVersion();
+
 	Core::Application& app = Core::Application::Get();
 
 	m_Materials = m_AssetManager->GetAll<Core::Material>();
+	m_MaterialIndices.clear();
+
+	for (usize i = 0; i < m_Materials.size(); i++)
+		m_MaterialIndices[m_Materials[i]->GetID()] = static_cast<u32>(i);
+
 	std::vector<Core::MaterialUBO> materialUBOs;
 	materialUBOs.reserve(m_Materials.size());
 
@@ -278,10 +435,7 @@ void Editor::UpdateMaterialsBuffer()
 		materialsBuffer = app.CreateBuffer(sizeof(Core::MaterialUBO) * m_MaxMaterials,
 			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
 
-		Core::Shader& graphicsShader = app.GetGraphicsShader();
-		graphicsShader.Bindings[1] = Core::DescriptorBinding(materialsBuffer, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-
-		app.UpdateDescriptorSets(app.GetGraphicsShader());
+		app.UpdateMaterialsDescriptors();
 	}
 
 	for (const auto& material : m_Materials)
@@ -295,31 +449,63 @@ void Editor::UpdateMaterialsBuffer()
 	vmaUnmapMemory(app.GetVmaAllocator(), materialsBuffer.Allocation);
 }
 
-void Editor::PushConstants(Core::Object* obj)
+void Editor::PushConstants(Core::Entity entity, const Core::WorldTransform& worldTransform, const Core::Mesh& mesh)
 {
 	Core::Application& app = Core::Application::Get();
 	Core::ObjPushConstants objPC = {};
+	objPC.MaterialIndex = GetMaterialIndex(entity);
 
-	if (obj->HasComponent<Core::Material>())
-	{
-		auto objMaterial = obj->GetComponent<Core::Material>();
-		for (usize i = 0; i < m_Materials.size(); i++)
-		{
-			if (objMaterial->GetID() == m_Materials[i]->GetID())
-			{
-				objPC.MaterialIndex = i;
-			}
-		}
-	}
-	else
-	{
-		objPC.MaterialIndex = -1;
-	}
-
-	objPC.Model = obj->GetComponent<Core::Transform>()->GetModelMatrix();
+	// the normal matrix stays the transform's own, packed normals are decoded to unit vectors before it's applied
+	objPC.Model = worldTransform.Matrix * mesh.GetDequantizationMatrix();
+	objPC.NormalMatrix = glm::mat3x4(worldTransform.NormalMatrix);
 	vkCmdPushConstants(app.GetCurrentCommandBuffer(), app.GetGraphicsPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Core::ObjPushConstants), &objPC);
 }
 
+u32 Editor::GetMaterialIndex(Core::Entity entity)
+{
+	if (!m_ECS.HasComponent<Core::Material>(entity))
+		return -1;
+
+	// null while the material is loading
+	auto objMaterial = m_ECS.GetComponent<const Core::Material>(entity);
+
+	if (auto it = objMaterial ? m_MaterialIndices.find(objMaterial->GetID()) : m_MaterialIndices.end(); it != m_MaterialIndices.end())
+		return it->second;
+
+	return -1;
+}
+
+void Editor::CullGPUScene(Core::Application& app)
+{
+	if (!m_GPUDrivenRendering)
+		return;
+
+	const f32 pixelsPerUnitAtOne = static_cast<f32>(app.GetSwapchain().extent.height) / (2.0f * std::tan(glm::radians(m_Camera.Fov) * 0.5f));
+	const glm::mat4 viewProjection = m_Camera.GetProjectionMatrix() * m_Camera.GetViewMatrix();
+
+	m_GPUScene.Cull(*m_AssetManager, viewProjection, m_Camera.Position, pixelsPerUnitAtOne);
+}
+
+void Editor::UpdateWorldTransforms()
+{
+	m_TransformSystem.Update(m_ECS);
+}
+
+glm::mat4 Editor::GetWorldMatrix(Core::Object* object)
+{
+	return Core::TransformSystem::GetParentWorldMatrix(m_ECS, object->GetEntity()) *
+		object->GetComponent<const Core::Transform>()->GetModelMatrix();
+}
+
+void Editor::SetWorldPosition(Core::Object* object, const glm::vec3& position)
+{
+	glm::mat4 parentWorld = Core::TransformSystem::GetParentWorldMatrix(m_ECS, object->GetEntity());
+	object->Patch<Core::Transform>([&](Core::Transform& transform)
+		{
+			transform.Position = glm::vec3(glm::inverse(parentWorld) * glm::vec4(position, 1.0f));
+		});
+}
+
 void Editor::OnSwapchainRender()
 {
 	RenderImGui();
@@ -329,7 +515,11 @@ void Editor::OnUpdate(f32 deltaTime)
 {
 	auto& app = Core::Application::Get();
 	if (!glfwGetWindowAttrib(app.GetWindow().GetHandle(), GLFW_FOCUSED))
+	{
+		// nothing moves, but the gpu-driven pass still culls every frame it draws
+		CullGPUScene(app);
 		return;
+	}
 
 	if (!m_PressedKeys.count(GLFW_KEY_LEFT_CONTROL) && m_PressedKeys.count(GLFW_KEY_W))
 		m_Camera.Move(-m_Camera.Front, deltaTime);
@@ -340,6 +530,8 @@ void Editor::OnUpdate(f32 deltaTime)
 	if (m_PressedKeys.count(GLFW_KEY_D))
 		m_Camera.Move(m_Camera.Right, deltaTime);
 
+	m_ECS.RunSystems(deltaTime);
+
 	for(const auto& obj : m_Objects)
 		obj->OnUpdate(deltaTime);
 
@@ -348,9 +540,18 @@ void Editor::OnUpdate(f32 deltaTime)
 		line->Lifetime -= deltaTime;
 	}
 
+	m_AssetManager->Update();
+
+	UpdateWorldTransforms();
 	UpdateMaterialsBuffer();
 
 	vkDeviceWaitIdle(app.GetVulkanDevice());
+	m_AssetManager->EvictToBudget();
+
+	// after eviction, so evicted meshes are already gone from the object buffer
+	m_GPUScene.Update(m_ECS, *m_AssetManager, [this](Core::Entity entity) { return GetMaterialIndex(entity); });
+	CullGPUScene(app);
+
 	m_DebugLines.erase(std::remove_if(m_DebugLines.begin(), m_DebugLines.end(),
 		[](const std::unique_ptr<DebugLine>& line) { return line->Lifetime <= 0.0f; }),
 		m_DebugLines.end());
@@ -384,6 +585,26 @@ bool Editor::OnKeyPressed(Core::KeyPressedEvent& event)
 		return true;
 	}
 
+	if (event.GetKeyCode() == GLFW_KEY_DELETE && m_SelectedObject)
+	{
+		// children move up to the deleted object's parent and keep their place in the world
+		Core::Entity parent = Core::TransformSystem::GetParent(m_ECS, m_SelectedObject->GetEntity());
+
+		for (const auto& obj : m_Objects)
+		{
+			if (Core::TransformSystem::GetParent(m_ECS, obj->GetEntity()) == m_SelectedObject->GetEntity())
+				Core::TransformSystem::SetParent(m_ECS, obj->GetEntity(), parent, true);
+		}
+
+		// destroying the object releases its entity slot and components, shared assets stay loaded
+		std::erase_if(m_Objects, [this](const std::unique_ptr<Core::Object>& obj) { return obj.get() == m_SelectedObject; });
+
+		m_SelectedObject = nullptr;
+		m_ActiveGizmo = nullptr;
+
+		return true;
+	}
+
 	if(event.GetKeyCode() == GLFW_KEY_F1 && !event.IsRepeat())
 	{
 		m_WireframeMode = !m_WireframeMode;
@@ -410,7 +631,7 @@ bool Editor::OnMouseMoved(Core::MouseMovedEvent& event)
 
 		if (type == GizmoType::Translate)
 		{
-			glm::vec3 point = m_SelectedObject->GetComponent<Core::Transform>()->Position;
+			glm::vec3 point = glm::vec3(GetWorldMatrix(m_SelectedObject)[3]);
 
 			if (axis == GizmoAxis::X)
 			{
@@ -425,7 +646,7 @@ bool Editor::OnMouseMoved(Core::MouseMovedEvent& event)
 			{
 				AxisTranslationDragger(glm::vec3(0.0f, 0.0f, 1.0f), point);
 			}
-			m_SelectedObject->GetComponent<Core::Transform>()->Position = point;
+			SetWorldPosition(m_SelectedObject, point);
 		}
 		else if (type == GizmoType::Rotate)
 		{
@@ -484,7 +705,7 @@ bool Editor::OnMouseMoved(Core::MouseMovedEvent& event)
 
 void Editor::PlaneTranslationDragger(const glm::vec3& planeNormal, glm::vec3& point)
 {
-	const glm::vec3 planePoint = m_SelectedObject->GetComponent<Core::Transform>()->Position;
+	const glm::vec3 planePoint = glm::vec3(GetWorldMatrix(m_SelectedObject)[3]);
 	const Core::Ray ray = GetMouseRay();
 	const f32 denom = glm::dot(planeNormal, ray.Direction);
 
@@ -527,8 +748,10 @@ void Editor::AxisRotationDragger(const glm::vec3& axis)
 {
 	auto transform = m_SelectedObject->GetComponent<Core::Transform>();
 
-	glm::mat4 rotationMatrix = glm::mat4_cast(transform->GetRotationQuat());
-	glm::vec3 worldAxis = glm::normalize(glm::vec3(rotationMatrix * glm::vec4(axis, 0.0f)));
+	glm::mat4 parentWorld = Core::TransformSystem::GetParentWorldMatrix(m_ECS, m_SelectedObject->GetEntity());
+	glm::mat4 worldMatrix = parentWorld * transform->GetModelMatrix();
+	glm::vec3 worldPosition = glm::vec3(worldMatrix[3]);
+	glm::vec3 worldAxis = glm::normalize(glm::vec3(worldMatrix * glm::vec4(axis, 0.0f)));
 
 	glm::vec4 plane = glm::vec4(worldAxis, -glm::dot(worldAxis, m_ClickOffset));
 
@@ -544,7 +767,7 @@ void Editor::AxisRotationDragger(const glm::vec3& axis)
 		return;
 
 	glm::vec3 currentPoint = ray.Origin + ray.Direction * t;
-	glm::vec3 centerOfRotation = transform->Position + worldAxis * glm::dot(m_ClickOffset - transform->Position, worldAxis);
+	glm::vec3 centerOfRotation = worldPosition + worldAxis * glm::dot(m_ClickOffset - worldPosition, worldAxis);
 
 	glm::vec3 arm1 = glm::normalize(m_ClickOffset - centerOfRotation);
 	glm::vec3 arm2 = glm::normalize(currentPoint - centerOfRotation);
@@ -564,12 +787,15 @@ void Editor::AxisRotationDragger(const glm::vec3& axis)
 	if (glm::dot(rotationAxis, worldAxis) < 0)
 		angle = -angle;
 
-	glm::quat deltaRotation = glm::angleAxis(angle, worldAxis);
+	// the local rotation is relative to the parent, so rotate around the axis as the parent sees it
+	glm::vec3 parentAxis = glm::normalize(glm::mat3(glm::inverse(parentWorld)) * worldAxis);
+	glm::quat deltaRotation = glm::angleAxis(angle, parentAxis);
 
 	glm::quat currentRotation = transform->GetRotationQuat();
 	glm::quat newRotation = deltaRotation * currentRotation;
 
 	transform->Rotation = glm::eulerAngles(newRotation);
+	m_SelectedObject->MarkChanged<Core::Transform>();
 
 	m_ClickOffset = currentPoint;
 }
@@ -577,10 +803,11 @@ void Editor::AxisRotationDragger(const glm::vec3& axis)
 void Editor::AxisScaleDragger(const glm::vec3& axis)
 {
 	auto transform = m_SelectedObject->GetComponent<Core::Transform>();
+	const glm::vec3 worldPosition = glm::vec3(GetWorldMatrix(m_SelectedObject)[3]);
 
-	const glm::vec3 planeTangent = glm::cross(axis, transform->Position - m_Camera.Position);
+	const glm::vec3 planeTangent = glm::cross(axis, worldPosition - m_Camera.Position);
 	const glm::vec3 planeNormal = glm::cross(axis, planeTangent);
-	const glm::vec3 planePoint = transform->Position;
+	const glm::vec3 planePoint = worldPosition;
 
 	const Core::Ray ray = GetMouseRay();
 
@@ -596,7 +823,7 @@ void Editor::AxisScaleDragger(const glm::vec3& axis)
 
 	const glm::vec3 intersectionPoint = ray.Origin + ray.Direction * t;
 
-	glm::vec3 projectedPoint = transform->Position + axis * glm::dot(intersectionPoint - transform->Position, axis);
+	glm::vec3 projectedPoint = worldPosition + axis * glm::dot(intersectionPoint - worldPosition, axis);
 
 	f32 scaleDelta = glm::dot(projectedPoint - m_ClickOffset, axis) * 2.0f;
 
@@ -612,6 +839,7 @@ void Editor::AxisScaleDragger(const glm::vec3& axis)
 		transform->Scale = glm::clamp(newScale, glm::vec3(0.01f), glm::vec3(1000.0f));
 	}
 
+	m_SelectedObject->MarkChanged<Core::Transform>();
 	m_ClickOffset = projectedPoint;
 }
 
@@ -661,9 +889,10 @@ bool Editor::TestGizmoClick()
 	if (hitResult.Hit)
 	{
 		Core::Application::Get().SetCursorState(GLFW_CURSOR_DISABLED);
-		m_ActiveGizmo = dynamic_cast<Gizmo*>(hitResult.HitObject);
+		// GizmoRaycast only tests m_Gizmos, so the hit object is always a Gizmo
+		m_ActiveGizmo = static_cast<Gizmo*>(hitResult.HitObject);
 
-		auto transform = m_SelectedObject->GetComponent<Core::Transform>();
+		glm::vec3 position = glm::vec3(GetWorldMatrix(m_SelectedObject)[3]);
 		glm::vec3 hitPoint = ray.Origin + ray.Direction * hitResult.HitDistance;
 
 		if (m_ActiveGizmo->GetType() == GizmoType::Scale)
@@ -672,7 +901,7 @@ bool Editor::TestGizmoClick()
 				m_ActiveGizmo->GetAxis() == GizmoAxis::Y ? glm::vec3(0, 1, 0) :
 				glm::vec3(0, 0, 1);
 
-			m_ClickOffset = transform->Position + axis * glm::dot(hitPoint - transform->Position, axis);
+			m_ClickOffset = position + axis * glm::dot(hitPoint - position, axis);
 		}
 		else if (m_ActiveGizmo->GetType() == GizmoType::Translate)
 		{
@@ -680,26 +909,26 @@ bool Editor::TestGizmoClick()
 				m_ActiveGizmo->GetAxis() == GizmoAxis::Y ? glm::vec3(0, 1, 0) :
 				glm::vec3(0, 0, 1);
 
-			glm::vec3 planeTangent = glm::cross(axis, transform->Position - m_Camera.Position);
+			glm::vec3 planeTangent = glm::cross(axis, position - m_Camera.Position);
 			glm::vec3 planeNormal = glm::cross(axis, planeTangent);
 
 			f32 denom = glm::dot(ray.Direction, planeNormal);
 			if (std::abs(denom) > 0.0001f)
 			{
-				f32 t = glm::dot(transform->Position - ray.Origin, planeNormal) / denom;
+				f32 t = glm::dot(position - ray.Origin, planeNormal) / denom;
 				if (t >= 0)
 				{
 					glm::vec3 planeIntersection = ray.Origin + ray.Direction * t;
-					m_ClickOffset = transform->Position + axis * glm::dot(planeIntersection - transform->Position, axis);
+					m_ClickOffset = position + axis * glm::dot(planeIntersection - position, axis);
 				}
 				else
 				{
-					m_ClickOffset = transform->Position;
+					m_ClickOffset = position;
 				}
 			}
 			else
 			{
-				m_ClickOffset = transform->Position;
+				m_ClickOffset = position;
 			}
 		}
 		else
@@ -749,6 +978,17 @@ Core::Ray Editor::GetMouseRay()
 	return ray;
 }
 
+Core::Object* Editor::FindObject(Core::Entity entity)
+{
+	for (const auto& obj : m_Objects)
+	{
+		if (obj->GetEntity() == entity)
+			return obj.get();
+	}
+
+	return nullptr;
+}
+
 bool Editor::OnWindowResize(Core::WindowResizeEvent& event)
 {
 	auto& app = Core::Application::Get();
@@ -780,29 +1020,6 @@ void Editor::CreateOutlinePipeline()
 	outlinePcRange.offset = 0;
 	outlinePcRange.size = sizeof(glm::mat4);
 
-	VkVertexInputBindingDescription bindingDescription = {};
-	bindingDescription.binding = 0;
-	bindingDescription.stride = sizeof(Core::Vertex);
-	bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-	std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
-	attributeDescriptions.resize(3);
-
-	attributeDescriptions[0].binding = 0;
-	attributeDescriptions[0].location = 0;
-	attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-	attributeDescriptions[0].offset = offsetof(Core::Vertex, Position);
-
-	attributeDescriptions[1].binding = 0;
-	attributeDescriptions[1].location = 1;
-	attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-	attributeDescriptions[1].offset = offsetof(Core::Vertex, Normal);
-
-	attributeDescriptions[2].binding = 0;
-	attributeDescriptions[2].location = 2;
-	attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-	attributeDescriptions[2].offset = offsetof(Core::Vertex, TextureCoordinate);
-
 	std::vector<Core::DescriptorBinding> bindings =
 	{
 		Core::DescriptorBinding(app.GetVPBuffer(), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
@@ -833,26 +1050,6 @@ void Editor::CreateOutlinePipeline()
 
 	VkPipelineRenderingCreateInfoKHR renderingInfo = app.GetGraphicsRenderingInfo();
 
-	m_OutlineShader = app.CreateShader(
-		&renderingInfo,
-		bindings,
-		{ outlinePcRange },
-		&bindingDescription,
-		attributeDescriptions,
-		&viewport,
-		&scissor,
-		&depthStencilWireframe,
-		dynamicStates,
-		&multisampling,
-		VK_CULL_MODE_FRONT_BIT,
-		VK_POLYGON_MODE_LINE,
-		VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-		vert,
-		frag
-	);
-
-	app.UpdateDescriptorSets(m_OutlineShader);
-
 	VkPipelineDepthStencilStateCreateInfo depthStencilFill = {};
 	depthStencilFill.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depthStencilFill.depthTestEnable = VK_TRUE;
@@ -861,25 +1058,51 @@ void Editor::CreateOutlinePipeline()
 	depthStencilFill.depthBoundsTestEnable = VK_FALSE;
 	depthStencilFill.stencilTestEnable = VK_FALSE;
 
-	m_OutlineFillShader = app.CreateShader(
-		&renderingInfo,
-		bindings,
-		{ outlinePcRange },
-		&bindingDescription,
-		attributeDescriptions,
-		&viewport,
-		&scissor,
-		&depthStencilFill,
-		dynamicStates,
-		&multisampling,
-		VK_CULL_MODE_BACK_BIT,
-		VK_POLYGON_MODE_FILL,
-		VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-		vert,
-		frag
-	);
-
-	app.UpdateDescriptorSets(m_OutlineFillShader);
+	// same shaders for every format, they only read the position and a packed one comes in through the dequantizing model matrix
+	for (usize i = 0; i < Core::VertexFormatCount; i++)
+	{
+		VkVertexInputBindingDescription bindingDescription = {};
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+		Core::Renderer::GetVertexInputDescription(static_cast<Core::VertexFormat>(i), bindingDescription, attributeDescriptions);
+
+		m_OutlineShaders[i] = app.CreateShader(
+			&renderingInfo,
+			bindings,
+			{ outlinePcRange },
+			&bindingDescription,
+			attributeDescriptions,
+			&viewport,
+			&scissor,
+			&depthStencilWireframe,
+			dynamicStates,
+			&multisampling,
+			VK_CULL_MODE_FRONT_BIT,
+			VK_POLYGON_MODE_LINE,
+			VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+			vert,
+			frag
+		);
+		app.UpdateDescriptorSets(m_OutlineShaders[i]);
+
+		m_OutlineFillShaders[i] = app.CreateShader(
+			&renderingInfo,
+			bindings,
+			{ outlinePcRange },
+			&bindingDescription,
+			attributeDescriptions,
+			&viewport,
+			&scissor,
+			&depthStencilFill,
+			dynamicStates,
+			&multisampling,
+			VK_CULL_MODE_BACK_BIT,
+			VK_POLYGON_MODE_FILL,
+			VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+			vert,
+			frag
+		);
+		app.UpdateDescriptorSets(m_OutlineFillShaders[i]);
+	}
 }
 
 void Editor::CreateDebugLinePipeline()
@@ -974,19 +1197,6 @@ void Editor::CreateGizmoPipeline()
 	gizmoPushConstants.offset = 0;
 	gizmoPushConstants.size = sizeof(GizmoPushConstants);
 
-	VkVertexInputBindingDescription bindingDescription = {};
-	bindingDescription.binding = 0;
-	bindingDescription.stride = sizeof(Core::Vertex);
-	bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-	std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
-	attributeDescriptions.resize(1);
-
-	attributeDescriptions[0].binding = 0;
-	attributeDescriptions[0].location = 0;
-	attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-	attributeDescriptions[0].offset = 0;
-
 	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
 	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depthStencil.depthTestEnable = VK_FALSE;
@@ -1015,11 +1225,20 @@ void Editor::CreateGizmoPipeline()
 
 	auto renderingInfo = app.GetGraphicsRenderingInfo();
 
-	m_GizmoShader = app.CreateShader(&renderingInfo, bindings, { gizmoPushConstants },
-		&bindingDescription, attributeDescriptions, &viewport, &scissor, &depthStencil, dynamicStates, &multisampling,
-		VK_CULL_MODE_BACK_BIT, VK_POLYGON_MODE_FILL, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, vert, frag);
+	for (usize i = 0; i < Core::VertexFormatCount; i++)
+	{
+		// gizmo.vert only reads the position
+		VkVertexInputBindingDescription bindingDescription = {};
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+		Core::Renderer::GetVertexInputDescription(static_cast<Core::VertexFormat>(i), bindingDescription, attributeDescriptions);
+		attributeDescriptions.resize(1);
 
-	app.UpdateDescriptorSets(m_GizmoShader);
+		m_GizmoShaders[i] = app.CreateShader(&renderingInfo, bindings, { gizmoPushConstants },
+			&bindingDescription, attributeDescriptions, &viewport, &scissor, &depthStencil, dynamicStates, &multisampling,
+			VK_CULL_MODE_BACK_BIT, VK_POLYGON_MODE_FILL, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, vert, frag);
+
+		app.UpdateDescriptorSets(m_GizmoShaders[i]);
+	}
 }
 
 void Editor::InitImGui()
@@ -1106,9 +1325,12 @@ void Editor::RenderImGui()
 	if (m_SelectedObject)
 	{
 		auto transform = m_SelectedObject->GetComponent<Core::Transform>();
-		ImGui::InputFloat3("Position", &transform->Position.x);
-		ImGui::InputFloat3("Rotation", &transform->Rotation.x);
-		ImGui::InputFloat3("Scale", &transform->Scale.x);
+		bool edited = ImGui::InputFloat3("Position", &transform->Position.x);
+		edited |= ImGui::InputFloat3("Rotation", &transform->Rotation.x);
+		edited |= ImGui::InputFloat3("Scale", &transform->Scale.x);
+
+		if (edited)
+			m_SelectedObject->MarkChanged<Core::Transform>();
 	}
 	
 	ImGui::End();
@@ -1116,12 +1338,35 @@ void Editor::RenderImGui()
 	ImGui::SetNextWindowBgAlpha(1.0f);
 	ImGui::Begin("Scene Hierarchy");
 
+	std::unordered_map<u32, std::vector<Core::Object*>> children;
+	std::vector<Core::Object*> roots;
+
 	for (const auto& obj : m_Objects)
 	{
-		if (ImGui::Selectable(obj->GetName().c_str(), m_SelectedObject == obj.get()))
+		Core::Entity parent = Core::TransformSystem::GetParent(m_ECS, obj->GetEntity());
+
+		if (parent.IsNull())
+			roots.push_back(obj.get());
+		else
+			children[parent.Index].push_back(obj.get());
+	}
+
+	for (Core::Object* root : roots)
+		DrawHierarchyNode(root, children);
+
+	// dropping an object on the empty space below the tree detaches it from its parent
+	ImVec2 dropArea = ImGui::GetContentRegionAvail();
+	ImGui::InvisibleButton("##HierarchyRoot", ImVec2(std::max(dropArea.x, 1.0f), std::max(dropArea.y, 20.0f)));
+
+	if (ImGui::BeginDragDropTarget())
+	{
+		if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("SCENE_OBJECT"))
 		{
-			m_SelectedObject = obj.get();
+			Core::Object* dropped = *static_cast<Core::Object**>(payload->Data);
+			Core::TransformSystem::SetParent(m_ECS, dropped->GetEntity(), Core::NullEntity, true);
 		}
+
+		ImGui::EndDragDropTarget();
 	}
 
 	ImGui::End();
@@ -1131,6 +1376,10 @@ void Editor::RenderImGui()
 
 	if (!m_CurrentProjectContentPath.empty())
 	{
+		// picked up the next time the project is opened
+		if (ImGui::Button("Build Content Pack"))
+			Core::AssetPack::Build(m_CurrentProjectContentPath, m_CurrentProject->GetPath() / Project::ContentPackName);
+
 		for (const auto& entry : std::filesystem::recursive_directory_iterator(m_CurrentProjectContentPath))
 		{
 			if (entry.is_directory())
@@ -1145,6 +1394,24 @@ void Editor::RenderImGui()
 
 	ImGui::Begin("Render Times");
 	ImGui::Text("Render Thread: %.3f ms", Core::Application::Get().GetGPUTime(Core::TimestampType::RenderThread));
+	ImGui::Text("Scene triangles: %llu", static_cast<unsigned long long>(m_RenderedTriangles));
+	ImGui::BeginDisabled(!Core::Application::Get().SupportsMultiDrawIndirect());
+	ImGui::Checkbox("GPU-driven rendering", &m_GPUDrivenRendering);
+	ImGui::EndDisabled();
+
+	if (m_GPUDrivenRendering)
+		ImGui::Text("GPU culled objects: %u / %u", Core::Application::Get().GetGPUCullStats().VisibleObjects, m_GPUScene.GetObjectCount());
+	else
+		ImGui::Text("Meshlets: %u / %u", m_VisibleMeshlets, m_TotalMeshlets);
+	ImGui::End();
+
+	const Core::AssetStats& assetStats = m_AssetManager->GetStats();
+
+	ImGui::Begin("Asset Memory");
+	ImGui::Text("CPU: %.1f / %.1f MiB", assetStats.CPUBytes / 1048576.0, assetStats.CPUBudget / 1048576.0);
+	ImGui::Text("GPU: %.1f / %.1f MiB", assetStats.GPUBytes / 1048576.0, assetStats.GPUBudget / 1048576.0);
+	ImGui::Text("Evicted: %u", assetStats.EvictedAssets);
+	ImGui::Text("Evictions: %llu, reloads: %llu", static_cast<unsigned long long>(assetStats.Evictions), static_cast<unsigned long long>(assetStats.Reloads));
 	ImGui::End();
 
 	ImGui::Render();
@@ -1157,6 +1424,57 @@ void Editor::RenderImGui()
 	}
 }
 
+void Editor::DrawHierarchyNode(Core::Object* object, const std::unordered_map<u32, std::vector<Core::Object*>>& children)
+{
+	auto it = children.find(object->GetEntity().Index);
+	bool hasChildren = it != children.end();
+
+	ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_DefaultOpen;
+
+	if (!hasChildren)
+		flags |= ImGuiTreeNodeFlags_Leaf;
+
+	if (m_SelectedObject == object)
+		flags |= ImGuiTreeNodeFlags_Selected;
+
+	bool open = ImGui::TreeNodeEx(object, flags, "%s", object->GetName().c_str());
+
+	if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen())
+		m_SelectedObject = object;
+
+	if (ImGui::BeginDragDropSource())
+	{
+		ImGui::SetDragDropPayload("SCENE_OBJECT", &object, sizeof(Core::Object*));
+		ImGui::TextUnformatted(object->GetName().c_str());
+		ImGui::EndDragDropSource();
+	}
+
+	if (ImGui::BeginDragDropTarget())
+	{
+		if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("SCENE_OBJECT"))
+		{
+			// SetParent refuses to parent an object to its own descendant
+			Core::Object* dropped = *static_cast<Core::Object**>(payload->Data);
+
+			if (dropped != object)
+				Core::TransformSystem::SetParent(m_ECS, dropped->GetEntity(), object->GetEntity(), true);
+		}
+
+		ImGui::EndDragDropTarget();
+	}
+
+	if (!open)
+		return;
+
+	if (hasChildren)
+	{
+		for (Core::Object* child : it->second)
+			DrawHierarchyNode(child, children);
+	}
+
+	ImGui::TreePop();
+}
+
 void Editor::DrawDebugLine(const glm::vec3& start, const glm::vec3& end, const glm::vec3& color, f32 lifetime, f32 thickness)
 {
 	if (thickness < 1.0f || thickness > s_MaxLineWidth)
@@ -1184,7 +1502,7 @@ Core::HitResult Editor::GizmoRaycast(const glm::vec3& start, const glm::vec3& di
 		if (!gizmo->HasComponent<Core::Mesh>())
 			continue;
 
-		auto transform = gizmo->GetComponent<Core::Transform>();
+		auto transform = gizmo->GetComponent<const Core::Transform>();
 
 		glm::mat4 invTransform = glm::inverse(transform->GetModelMatrix());
 		glm::vec3 localOrigin = glm::vec3(invTransform * glm::vec4(start, 1.0f));
@@ -1238,22 +1556,17 @@ Core::HitResult Editor::GizmoRaycast(const glm::vec3& start, const glm::vec3& di
 Core::HitResult Editor::Raycast(const glm::vec3& start, const glm::vec3& direction, f32 maxDistance)
 {
 	f32 closestDistance = std::numeric_limits<f32>::max();
-	Core::Object* closestObject = nullptr;
+	Core::Entity closestEntity = Core::NullEntity;
 
-	for (const auto& obj : m_Objects)
+	m_ECS.View<const Core::WorldTransform, const Core::Mesh>().Each([&](Core::Entity entity, const Core::WorldTransform& worldTransform, const Core::Mesh& mesh)
 	{
-		if (!obj->HasComponent<Core::Mesh>())
-			continue;
-
-		auto transform = obj->GetComponent<Core::Transform>();
-
-		glm::mat4 invTransform = glm::inverse(transform->GetModelMatrix());
+		const glm::mat4& modelMatrix = worldTransform.Matrix;
+		glm::mat4 invTransform = glm::inverse(modelMatrix);
 		glm::vec3 localOrigin = glm::vec3(invTransform * glm::vec4(start, 1.0f));
 		glm::vec3 localDirection = glm::normalize(glm::vec3(invTransform * glm::vec4(direction, 0.0f)));
 
-		auto mesh = obj->GetComponent<Core::Mesh>();
-		const auto& vertices = mesh->GetVertices();
-		const auto& indices = mesh->GetIndices();
+		const auto& vertices = mesh.GetVertices();
+		const auto& indices = mesh.GetIndices();
 
 		for (usize j = 0; j < indices.size(); j += 3)
 		{
@@ -1276,17 +1589,19 @@ Core::HitResult Editor::Raycast(const glm::vec3& start, const glm::vec3& directi
 			if (RayTriangleIntersection(localRay, v0, v1, v2, distance))
 			{
 				glm::vec3 localIntersection = localOrigin + localDirection * distance;
-				glm::vec3 worldIntersection = glm::vec3(transform->GetModelMatrix() * glm::vec4(localIntersection, 1.0f));
+				glm::vec3 worldIntersection = glm::vec3(modelMatrix * glm::vec4(localIntersection, 1.0f));
 				f32 worldDistance = glm::length(worldIntersection - start);
 
 				if (worldDistance < closestDistance && worldDistance <= maxDistance)
 				{
 					closestDistance = worldDistance;
-					closestObject = obj.get();
+					closestEntity = entity;
 				}
 			}
 		}
-	}
+	});
+
+	Core::Object* closestObject = closestEntity.IsNull() ? nullptr : FindObject(closestEntity);
 
 	Core::HitResult result = {};
 	result.HitObject = closestObject;
@@ -1342,36 +1657,31 @@ void Editor::LoadProjectContent()
 	u32 objectCount = 0;
 	contentFile.read(reinterpret_cast<char*>(&objectCount), sizeof(u32));
 
-	Core::Object* newObject = nullptr;
-
-	u32 nameLength = 0, assetCount = 0, assetPathLength = 0;
-	std::string assetExtension;
-	Core::Transform transform;
-
 	std::filesystem::path rootPath = std::filesystem::path(PATH_TO_EDITOR).parent_path();
 
-	for (u32 i = 0; i < objectCount; i++)
+	// first pass only reads the file, objects refer to the unique assets by index so each one is loaded once
+	std::vector<ProjectObject> objects(objectCount);
+	std::vector<ProjectAsset> assets;
+	std::unordered_map<std::filesystem::path, u32> assetIndices;
+
+	for (ProjectObject& object : objects)
 	{
+		u32 nameLength = 0;
 		contentFile.read(reinterpret_cast<char*>(&nameLength), sizeof(u32));
 
-		std::string name(nameLength, '\0');
-		contentFile.read(reinterpret_cast<char*>(&name[0]), nameLength);
-
-		newObject = new Core::Object(m_ECS, name);
-		Core::Transform* objTransform = newObject->GetComponent<Core::Transform>();
-
-		contentFile.read(reinterpret_cast<char*>(&transform.Position), sizeof(glm::vec3));
-		contentFile.read(reinterpret_cast<char*>(&transform.Rotation), sizeof(glm::vec3));
-		contentFile.read(reinterpret_cast<char*>(&transform.Scale), sizeof(glm::vec3));
+		object.Name.resize(nameLength);
+		contentFile.read(reinterpret_cast<char*>(object.Name.data()), nameLength);
 
-		objTransform->Position = transform.Position;
-		objTransform->Rotation = transform.Rotation;
-		objTransform->Scale = transform.Scale;
+		contentFile.read(reinterpret_cast<char*>(&object.Position), sizeof(glm::vec3));
+		contentFile.read(reinterpret_cast<char*>(&object.Rotation), sizeof(glm::vec3));
+		contentFile.read(reinterpret_cast<char*>(&object.Scale), sizeof(glm::vec3));
 
+		u32 assetCount = 0;
 		contentFile.read(reinterpret_cast<char*>(&assetCount), sizeof(u32));
 
 		for (u32 j = 0; j < assetCount; j++)
 		{
+			u32 assetPathLength = 0;
 			contentFile.read(reinterpret_cast<char*>(&assetPathLength), sizeof(u32));
 			std::string assetPathStr(assetPathLength, '\0');
 			contentFile.read(reinterpret_cast<char*>(&assetPathStr[0]), assetPathLength);
@@ -1383,18 +1693,96 @@ void Editor::LoadProjectContent()
 				assetPath = m_CurrentProject->GetPath() / assetPath;
 			}
 
-			assetExtension = assetPath.extension().string();
+			std::string assetExtension = assetPath.extension().string();
+			ProjectAssetType type;
 
-			if(assetExtension == ".obj")
-				newObject->AddComponent<Core::Mesh>(m_AssetManager->Load<Core::Mesh>(assetPath)->GetID());
+			if (assetExtension == ".obj")
+				type = ProjectAssetType::Mesh;
 			else if (assetExtension == ".mtl")
-				newObject->AddComponent<Core::Material>(m_AssetManager->Load<Core::Material>(assetPath)->GetID());
+				type = ProjectAssetType::Material;
 			else if (assetExtension == ".png" || assetExtension == ".jpg" || assetExtension == ".jpeg")
-				newObject->AddComponent<Core::Texture>(m_AssetManager->Load<Core::Texture>(assetPath)->GetID());
+				type = ProjectAssetType::Texture;
+			else
+				continue;
+
+			auto [it, inserted] = assetIndices.try_emplace(assetPath, static_cast<u32>(assets.size()));
+
+			if (inserted)
+				assets.push_back({ assetPath, type });
+
+			object.Assets.push_back(it->second);
 		}
+	}
 
-		m_Objects.push_back(std::unique_ptr<Core::Object>(newObject));
+	u32 magic = 0;
+	contentFile.read(reinterpret_cast<char*>(&magic), sizeof(u32));
+
+	if (contentFile && magic == Project::HierarchyMagic)
+	{
+		for (u32 i = 0; i < objectCount && contentFile.read(reinterpret_cast<char*>(&objects[i].Parent), sizeof(u32)); i++)
+		{
+			if (objects[i].Parent >= objectCount)
+				objects[i].Parent = Project::NoParentIndex;
+		}
 	}
 
 	contentFile.close();
+
+	// every unique asset is decoded at once on the thread pool, Flush uploads them as they finish
+	for (ProjectAsset& asset : assets)
+	{
+		switch (asset.Type)
+		{
+		case ProjectAssetType::Mesh: asset.Handle = m_AssetManager->LoadAsync<Core::Mesh>(asset.Path); break;
+		case ProjectAssetType::Material: asset.Handle = m_AssetManager->LoadAsync<Core::Material>(asset.Path); break;
+		case ProjectAssetType::Texture: asset.Handle = m_AssetManager->LoadAsync<Core::Texture>(asset.Path); break;
+		}
+	}
+
+	m_AssetManager->Flush();
+
+	// entities are only created once their assets resolved, assets that failed to load are left out
+	usize firstObject = m_Objects.size();
+
+	for (const ProjectObject& object : objects)
+	{
+		auto newObject = std::make_unique<Core::Object>(m_ECS, object.Name);
+		Core::Transform* objTransform = newObject->GetComponent<Core::Transform>();
+
+		objTransform->Position = object.Position;
+		objTransform->Rotation = object.Rotation;
+		objTransform->Scale = object.Scale;
+
+		for (u32 assetIndex : object.Assets)
+		{
+			const ProjectAsset& asset = assets[assetIndex];
+
+			if (m_AssetManager->GetState(asset.Handle) != Core::AssetState::Ready)
+				continue;
+
+			switch (asset.Type)
+			{
+			case ProjectAssetType::Mesh: AddProjectAsset<Core::Mesh>(*newObject, asset.Handle); break;
+			case ProjectAssetType::Material: AddProjectAsset<Core::Material>(*newObject, asset.Handle); break;
+			case ProjectAssetType::Texture: AddProjectAsset<Core::Texture>(*newObject, asset.Handle); break;
+			}
+		}
+
+		m_Objects.push_back(std::move(newObject));
+	}
+
+	// failed assets give their slots back, so opening the project again retries them
+	for (const ProjectAsset& asset : assets)
+	{
+		if (m_AssetManager->GetState(asset.Handle) == Core::AssetState::Failed)
+			m_AssetManager->Unload(asset.Handle);
+	}
+
+	for (u32 i = 0; i < objectCount; i++)
+	{
+		if (objects[i].Parent != Project::NoParentIndex)
+			Core::TransformSystem::SetParent(m_ECS, m_Objects[firstObject + i]->GetEntity(), m_Objects[firstObject + objects[i].Parent]->GetEntity());
+	}
+
+	LOG_INFO("Loaded {} objects referencing {} unique assets.", objectCount, assets.size());
 }
\ No newline at end of file
@@ -7,7 +7,7 @@ Gizmo::Gizmo(Core::ECS& ecs, Core::AssetManager* assetManager, GizmoType type, G
 
 	auto& app = Core::Application::Get();
 
-	auto mesh = AddComponent<Core::Mesh>();
+	Core::Mesh* mesh = nullptr;
 	auto transform = GetComponent<Core::Transform>();
 
 	std::filesystem::path objPath = std::filesystem::path(PATH_TO_OBJS);
@@ -100,15 +100,15 @@ void Gizmo::SetupScaleGizmo(Core::Transform* transform)
 
 glm::mat4 Gizmo::GetModelMatrix() noexcept
 {
-	return GetComponent<Core::Transform>()->GetModelMatrix();
+	return GetComponent<const Core::Transform>()->GetModelMatrix();
 }
 
 void Gizmo::SetPosition(const glm::vec3& position)
 {
-	GetComponent<Core::Transform>()->Position = position;
+	Patch<Core::Transform>([&](Core::Transform& transform) { transform.Position = position; });
 }
 
 void Gizmo::SetScale(const glm::vec3& scale)
 {
-	GetComponent<Core::Transform>()->Scale = scale;
+	Patch<Core::Transform>([&](Core::Transform& transform) { transform.Scale = scale; });
 }
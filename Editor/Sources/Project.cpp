@@ -36,6 +36,10 @@ Project* Project::Load(const std::filesystem::path& path)
 * - For each asset: 
 *	- Asset path length [4 bytes]
 *	- Asset paths
+* 
+* [Hierarchy] (optional, older files end after the objects)
+* - Magic "HIER" [4 bytes]
+* - For each object: parent object index [4 bytes], 0xFFFFFFFF for root objects
 */
 
 void Project::Save(const std::vector<std::unique_ptr<Core::Object>>& objects, Core::AssetManager* assetManager) const
@@ -48,22 +52,22 @@ void Project::Save(const std::vector<std::unique_ptr<Core::Object>>& objects, Co
 
 	std::string name, assetPath;
 	u32 nameLength = 0, assetCount = 0, assetPathLength = 0;
-	Core::Transform* transform = nullptr;
+	const Core::Transform* transform = nullptr;
 	std::vector<Core::Asset*> assets;
 
 	for (const auto& object : objects)
 	{
 		name = object->GetName();
 		nameLength = static_cast<u32>(name.size());
-		transform = object->GetComponent<Core::Transform>();
+		transform = object->GetComponent<const Core::Transform>();
 		assets = object->GetAllAssets();
 		assetCount = static_cast<u32>(assets.size());
 
 		contentFile.write(reinterpret_cast<char*>(&nameLength), sizeof(u32));
 		contentFile.write(name.c_str(), nameLength);
-		contentFile.write(reinterpret_cast<char*>(&transform->Position), sizeof(glm::vec3));
-		contentFile.write(reinterpret_cast<char*>(&transform->Rotation), sizeof(glm::vec3));
-		contentFile.write(reinterpret_cast<char*>(&transform->Scale), sizeof(glm::vec3));
+		contentFile.write(reinterpret_cast<const char*>(&transform->Position), sizeof(glm::vec3));
+		contentFile.write(reinterpret_cast<const char*>(&transform->Rotation), sizeof(glm::vec3));
+		contentFile.write(reinterpret_cast<const char*>(&transform->Scale), sizeof(glm::vec3));
 		contentFile.write(reinterpret_cast<char*>(&assetCount), sizeof(u32));
 
 		for (const auto& asset : assets)
@@ -81,5 +85,28 @@ void Project::Save(const std::vector<std::unique_ptr<Core::Object>>& objects, Co
 			contentFile.write(assetPath.c_str(), assetPathLength);
 		}
 	}
+
+	std::unordered_map<u32, u32> objectIndices; // entity index -> object index
+	for (u32 i = 0; i < objectCount; i++)
+		objectIndices[objects[i]->GetEntity().Index] = i;
+
+	u32 magic = HierarchyMagic;
+	contentFile.write(reinterpret_cast<char*>(&magic), sizeof(u32));
+
+	for (const auto& object : objects)
+	{
+		u32 parentIndex = NoParentIndex;
+
+		if (object->HasComponent<Core::Hierarchy>())
+		{
+			Core::Entity parent = object->GetComponent<const Core::Hierarchy>()->Parent;
+
+			if (auto it = objectIndices.find(parent.Index); it != objectIndices.end() && objects[it->second]->GetEntity() == parent)
+				parentIndex = it->second;
+		}
+
+		contentFile.write(reinterpret_cast<char*>(&parentIndex), sizeof(u32));
+	}
+
 	contentFile.close();
 }
\ No newline at end of file
@@ -10,6 +10,7 @@ rootPath = os.getcwd()
 
 include "Core"
 include "Editor"
+include "Benchmarks"
 include (rootPath .. "/Core/Vendor/glfw")
 include (rootPath .. "/Core/Vendor/vk-bootstrap")
 include (rootPath .. "/Editor/Vendor/ImGui")